@@ -9,7 +9,12 @@ CVImage::CVImage()
     m_uiBitsPerPixel    = 0;
     m_uiChannelCount    = 0;
     m_pbyDataBuffer     = 0;
+    m_pbyAllocation     = 0;
     m_uiDataCapacity    = 0;
+    m_uiRowPitch        = 0;
+    m_uiCreateFlags     = VN_IMAGE_CREATE_DEFAULT;
+    m_bExternalData     = FALSE;
+    m_pAllocator        = vnQueryThreadAllocator();
 }
 
 CVImage::~CVImage()
@@ -22,21 +27,26 @@ CVImage::~CVImage()
 
 UINT32 CVImage::RowPitch() CONST
 {
-    return ( m_uiWidthInPixels * m_uiBitsPerPixel ) >> 3;
+    return m_uiRowPitch;
 }
 
-UINT32 CVImage::SlicePitch() CONST
+UINT64 CVImage::SlicePitch() CONST
 {
-    return m_uiDataCapacity;
+    if ( m_bExternalData )
+    {
+        return (UINT64) RowPitch() * m_uiHeightInPixels;
+    }
+
+    return (UINT64) RowPitch() * m_uiHeightInPixels + VN_IMAGE_CHROMA_SIZE( m_uiImageFormat, m_uiWidthInPixels, m_uiHeightInPixels );
 }
 
-UINT32 CVImage::BlockOffset( UINT32 i, UINT32 j ) CONST
+UINT64 CVImage::BlockOffset( UINT32 i, UINT32 j ) CONST
 {
-    return ( RowPitch() * j ) + ( ( i * m_uiBitsPerPixel ) >> 3 );
+    return ( (UINT64) RowPitch() * j ) + ( ( (UINT64) i * m_uiBitsPerPixel ) >> 3 );
 }
 
 
-VN_STATUS CVImage::Allocate( UINT32 uiSize )
+VN_STATUS CVImage::Allocate( UINT64 uiSize )
 {
     if ( VN_PARAM_CHECK )
     {
@@ -46,35 +56,68 @@ VN_STATUS CVImage::Allocate( UINT32 uiSize )
         }
     }
 
+    //
+    // Aligned images over-allocate so that they may advance their data buffer to the next 
+    // alignment boundary. Sizes beyond the address space of 32 bit builds cannot be allocated.
+    //
+
+    UINT64 uiAllocationSize = uiSize + ( ( m_uiCreateFlags & VN_IMAGE_CREATE_ALIGNED ) ? VN_IMAGE_ALIGNMENT - 1 : 0 );
+
+    if ( uiAllocationSize != (SIZE_T) uiAllocationSize )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
     if ( VN_FAILED( Deallocate() ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
-    m_pbyDataBuffer = new UINT8[ uiSize ];
+    m_pbyAllocation = (UINT8 *) m_pAllocator->Allocate( (SIZE_T) uiAllocationSize );
 
-    if ( !m_pbyDataBuffer )
+    if ( !m_pbyAllocation )
     {
         return vnPostError( VN_ERROR_OUTOFMEMORY );
     } 
 
+    vnCountAllocation( (SIZE_T) uiAllocationSize );
+
+    m_pbyDataBuffer  = m_pbyAllocation;
     m_uiDataCapacity = uiSize;
 
+    if ( m_uiCreateFlags & VN_IMAGE_CREATE_ALIGNED )
+    {
+        m_pbyDataBuffer = (UINT8 *) ( ( (UINT_PTR) m_pbyAllocation + VN_IMAGE_ALIGNMENT - 1 ) & ~( (UINT_PTR) VN_IMAGE_ALIGNMENT - 1 ) );
+    }
+
     //
-    // Zero out our initial image memory (for good measure).
+    // Zero out our initial image memory (for good measure), unless the caller will
+    // overwrite it anyways.
     //
 
-    vnZeroMemory( m_pbyDataBuffer, uiSize );
+    if ( !( m_uiCreateFlags & VN_IMAGE_CREATE_UNINITIALIZED ) )
+    {
+        vnZeroMemory( m_pbyDataBuffer, uiSize );
+    }
 
     return VN_SUCCESS;
 }
 
 VN_STATUS CVImage::Deallocate()
 {
-    delete [] m_pbyDataBuffer;
+    //
+    // Views do not own their memory, so we simply forget it.
+    //
+
+    if ( !m_bExternalData && m_pbyAllocation )
+    {
+        m_pAllocator->Free( m_pbyAllocation, (SIZE_T) ( m_uiDataCapacity + ( ( m_uiCreateFlags & VN_IMAGE_CREATE_ALIGNED ) ? VN_IMAGE_ALIGNMENT - 1 : 0 ) ) );
+    }
 
     m_pbyDataBuffer  = 0;
+    m_pbyAllocation  = 0;
     m_uiDataCapacity = 0;
+    m_bExternalData  = FALSE;
 
     return VN_SUCCESS;
 }
@@ -103,23 +146,93 @@ VN_STATUS CVImage::SetDimension( UINT32 uiNewWidth, UINT32 uiNewHeight )
         return vnPostError( VN_ERROR_INVALID_RESOURCE );
     }
 
-    if ( uiNewWidth == QueryWidth() && uiNewHeight == QueryHeight() )
+    if ( m_bExternalData )
     {
+        //
+        // Views never reallocate, and keep the row pitch of their memory, so they may only 
+        // take on dimensions that fit within the rows that they were created with.
+        //
+
+        if ( ( ( (UINT64) uiNewWidth * m_uiBitsPerPixel ) >> 3 ) > m_uiRowPitch || (UINT64) uiNewHeight * m_uiRowPitch > m_uiDataCapacity )
+        {
+            return vnPostError( VN_ERROR_INVALID_RESOURCE );
+        }
+
+        m_uiWidthInPixels  = uiNewWidth;
+        m_uiHeightInPixels = uiNewHeight;
+
         return VN_SUCCESS;
     }
 
     //
-    // All images are required to use byte aligned pixel rates, so there is 
-    // no need to align the allocation size.
+    // All images are required to use byte aligned pixel rates, so rows are 
+    // tightly packed unless the image was created with padded rows. We only 
+    // reallocate when our existing buffer is too small, so that reshaped images 
+    // may be reused without allocator traffic. Planar formats also hold their 
+    // chroma planes beyond the Y plane.
     //
 
-    if ( VN_FAILED( Allocate( ( uiNewWidth * uiNewHeight * m_uiBitsPerPixel ) >> 3 ) ) )
+    UINT64 uiNewPitch = ( (UINT64) uiNewWidth * m_uiBitsPerPixel ) >> 3;
+
+    if ( m_uiCreateFlags & VN_IMAGE_CREATE_PADDED )
+    {
+        uiNewPitch = ( uiNewPitch + VN_IMAGE_ALIGNMENT - 1 ) & ~( (UINT64) VN_IMAGE_ALIGNMENT - 1 );
+    }
+
+    UINT64 uiNewSize  = uiNewPitch * uiNewHeight + VN_IMAGE_CHROMA_SIZE( m_uiImageFormat, uiNewWidth, uiNewHeight );
+
+    //
+    // Images may exceed 4 GB in total, but each row must remain addressable by a 32 bit pitch.
+    //
+
+    if ( uiNewPitch > VN_MAX_UINT32 )
+    {
+        return vnPostError( VN_ERROR_INVALIDARG );
+    }
+
+    if ( uiNewSize > m_uiDataCapacity && VN_FAILED( Allocate( uiNewSize ) ) )
     {
         return vnPostError( VN_ERROR_OUTOFMEMORY );
     }
 
     m_uiWidthInPixels  = uiNewWidth;
     m_uiHeightInPixels = uiNewHeight;
+    m_uiRowPitch       = (UINT32) uiNewPitch;
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS CVImage::Wrap( UINT8 * pData, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiRowPitch )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pData || 0 == uiWidth || 0 == uiHeight )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( 0 == m_uiBitsPerPixel || VN_IMAGE_FORMAT_NONE == m_uiImageFormat )
+        {
+            return vnPostError( VN_ERROR_INVALID_RESOURCE );
+        }
+
+        if ( uiRowPitch < ( ( (UINT64) uiWidth * m_uiBitsPerPixel ) >> 3 ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( VN_FAILED( Deallocate() ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    m_pbyDataBuffer     = pData;
+    m_uiDataCapacity    = (UINT64) uiRowPitch * uiHeight;
+    m_bExternalData     = TRUE;
+    m_uiRowPitch        = uiRowPitch;
+    m_uiWidthInPixels   = uiWidth;
+    m_uiHeightInPixels  = uiHeight;
 
     return VN_SUCCESS;
 }
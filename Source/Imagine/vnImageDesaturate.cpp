@@ -1,7 +1,223 @@
 
 #include "vnImagine.h"
 
-VN_STATUS vnDesaturateLine( IN UINT8 * pInput, UINT32 uiPixelCount, UINT8 * pOutput )
+//
+// Vector builds desaturate 16 (SSSE3) or 32 (AVX2) pixels at a time, using the widest kernel 
+// that the host supports. Set VN_DESATURATE_ENABLE_VECTOR to zero to force the scalar reference 
+// kernel.
+//
+
+#define VN_DESATURATE_ENABLE_VECTOR                 (1)
+
+#if VN_DESATURATE_ENABLE_VECTOR && ( defined ( VN_SIMD_AVX2 ) || defined ( VN_SIMD_DISPATCH ) )
+    #define VN_DESATURATE_USE_AVX2
+    #define VN_DESATURATE_USE_SSSE3
+    #include <immintrin.h>
+#elif VN_DESATURATE_ENABLE_VECTOR && defined ( VN_SIMD_SSSE3 )
+    #define VN_DESATURATE_USE_SSSE3
+    #include <tmmintrin.h>
+#endif
+
+#if defined ( VN_DESATURATE_USE_SSSE3 )
+
+//
+// Vector Kernels
+//
+//   Each 16 byte load holds four whole pixels of STRIDE (3 or 4) bytes, plus a partial fifth 
+//   when STRIDE is 3. We shuffle the first two channels of the four pixels into pairs of 16 bit 
+//   lanes, and the third channel into the low half of a 32 bit lane, so that two 16 bit 
+//   multiply-adds produce exactly the 32 bit sums of vnDesaturatePixel. The weights of each
+//   multiply follow the channel order of the format. The final load of a block begins early 
+//   (and its shuffles correspondingly later) so that we never read beyond the last pixel of 
+//   the block.
+//
+
+#define VN_DESATURATE_RED_GREEN_WEIGHTS             ( ( 0x970 << 16 ) | 0x4CC )
+#define VN_DESATURATE_BLUE_WEIGHTS                  ( 0x1C2 )
+#define VN_DESATURATE_BLUE_GREEN_WEIGHTS            ( ( 0x970 << 16 ) | 0x1C2 )
+#define VN_DESATURATE_RED_WEIGHTS                   ( 0x4CC )
+
+template < UINT32 STRIDE >
+inline __m128i vnDesaturatePairMask( INT8 iOffset )
+{
+    return _mm_setr_epi8( iOffset + 0,          -1, iOffset + 1,              -1, iOffset + STRIDE,         -1, iOffset + STRIDE + 1,     -1, 
+                          iOffset + 2 * STRIDE, -1, iOffset + 2 * STRIDE + 1, -1, iOffset + 3 * STRIDE,     -1, iOffset + 3 * STRIDE + 1, -1 );
+}
+
+template < UINT32 STRIDE >
+inline __m128i vnDesaturateThirdMask( INT8 iOffset )
+{
+    return _mm_setr_epi8( iOffset + 2,              -1, -1, -1, iOffset + STRIDE + 2,     -1, -1, -1, 
+                          iOffset + 2 * STRIDE + 2, -1, -1, -1, iOffset + 3 * STRIDE + 2, -1, -1, -1 );
+}
+
+//
+// vnDesaturateBlock16
+//
+//   Desaturates 16 pixels (16 x STRIDE bytes) at a time. 
+//
+
+template < UINT32 STRIDE >
+VOID vnDesaturateBlock16( CONST UINT8 * pInput, INT32 iPairWeights, INT32 iThirdWeights, UINT8 * pOutput )
+{
+    CONST INT8 iLastOffset = 16 - 4 * STRIDE;
+
+    __m128i vPairMask         = vnDesaturatePairMask< STRIDE >( 0 );
+    __m128i vThirdMask        = vnDesaturateThirdMask< STRIDE >( 0 );
+    __m128i vLastPairMask     = vnDesaturatePairMask< STRIDE >( iLastOffset );
+    __m128i vLastThirdMask    = vnDesaturateThirdMask< STRIDE >( iLastOffset );
+    __m128i vPairWeights      = _mm_set1_epi32( iPairWeights );
+    __m128i vThirdWeights     = _mm_set1_epi32( iThirdWeights );
+    __m128i vSum[4];
+
+    for ( UINT32 i = 0; i < 4; i++ )
+    {
+        BOOL bLast      = ( 3 == i );
+        __m128i vPixels = _mm_loadu_si128( (CONST __m128i *) ( pInput + ( bLast ? 16 * STRIDE - 16 : i * 4 * STRIDE ) ) );
+
+        vSum[ i ] = _mm_add_epi32( _mm_madd_epi16( _mm_shuffle_epi8( vPixels, bLast ? vLastPairMask : vPairMask ), vPairWeights ),
+                                   _mm_madd_epi16( _mm_shuffle_epi8( vPixels, bLast ? vLastThirdMask : vThirdMask ), vThirdWeights ) );
+
+        vSum[ i ] = _mm_srli_epi32( vSum[ i ], 12 );
+    }
+
+    _mm_storeu_si128( (__m128i *) pOutput, _mm_packus_epi16( _mm_packs_epi32( vSum[0], vSum[1] ), _mm_packs_epi32( vSum[2], vSum[3] ) ) );
+}
+
+#if defined ( VN_DESATURATE_USE_AVX2 )
+
+//
+// vnDesaturateBlock32
+//
+//   Desaturates 32 pixels (32 x STRIDE bytes) at a time. Each 256 bit register holds four pixels 
+//   in each of its 128 bit lanes, so our packs interleave the lanes, which we undo with a final 
+//   permute.
+//
+
+template < UINT32 STRIDE >
+VOID vnDesaturateBlock32( CONST UINT8 * pInput, INT32 iPairWeights, INT32 iThirdWeights, UINT8 * pOutput )
+{
+    CONST INT8 iLastOffset = 16 - 4 * STRIDE;
+
+    __m256i vPairMask         = _mm256_broadcastsi128_si256( vnDesaturatePairMask< STRIDE >( 0 ) );
+    __m256i vThirdMask        = _mm256_broadcastsi128_si256( vnDesaturateThirdMask< STRIDE >( 0 ) );
+    __m256i vLastPairMask     = _mm256_inserti128_si256( vPairMask, vnDesaturatePairMask< STRIDE >( iLastOffset ), 1 );
+    __m256i vLastThirdMask    = _mm256_inserti128_si256( vThirdMask, vnDesaturateThirdMask< STRIDE >( iLastOffset ), 1 );
+    __m256i vPairWeights      = _mm256_set1_epi32( iPairWeights );
+    __m256i vThirdWeights     = _mm256_set1_epi32( iThirdWeights );
+    __m256i vSum[4];
+
+    for ( UINT32 i = 0; i < 4; i++ )
+    {
+        BOOL bLast      = ( 3 == i );
+        __m128i vLow    = _mm_loadu_si128( (CONST __m128i *) ( pInput + i * 8 * STRIDE ) );
+        __m128i vHigh   = _mm_loadu_si128( (CONST __m128i *) ( pInput + ( bLast ? 32 * STRIDE - 16 : i * 8 * STRIDE + 4 * STRIDE ) ) );
+        __m256i vPixels = _mm256_inserti128_si256( _mm256_castsi128_si256( vLow ), vHigh, 1 );
+
+        vSum[ i ] = _mm256_add_epi32( _mm256_madd_epi16( _mm256_shuffle_epi8( vPixels, bLast ? vLastPairMask : vPairMask ), vPairWeights ),
+                                      _mm256_madd_epi16( _mm256_shuffle_epi8( vPixels, bLast ? vLastThirdMask : vThirdMask ), vThirdWeights ) );
+
+        vSum[ i ] = _mm256_srli_epi32( vSum[ i ], 12 );
+    }
+
+    __m256i vResult = _mm256_packus_epi16( _mm256_packs_epi32( vSum[0], vSum[1] ), _mm256_packs_epi32( vSum[2], vSum[3] ) );
+
+    _mm256_storeu_si256( (__m256i *) pOutput, _mm256_permutevar8x32_epi32( vResult, _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) ) );
+}
+
+#endif
+
+#endif
+
+//
+// vnDesaturateChannels
+//
+//   Desaturates a line of 8 bit color pixels that are STRIDE bytes apart, using kernels up to
+//   the instruction set LEVEL. 
+//
+
+template < UINT32 STRIDE, UINT32 LEVEL >
+VOID vnDesaturateChannels( VN_IMAGE_FORMAT format, CONST UINT8 * pInput, UINT32 uiPixelCount, UINT8 * pOutput )
+{
+    UINT32 iX = 0;
+
+#if defined ( VN_DESATURATE_USE_SSSE3 )
+
+    BOOL bSwizzled       = VN_IS_IMAGE_SWIZZLED( format );
+    INT32 iPairWeights   = ( bSwizzled ? VN_DESATURATE_BLUE_GREEN_WEIGHTS : VN_DESATURATE_RED_GREEN_WEIGHTS );
+    INT32 iThirdWeights  = ( bSwizzled ? VN_DESATURATE_RED_WEIGHTS : VN_DESATURATE_BLUE_WEIGHTS );
+
+#endif
+
+#if defined ( VN_DESATURATE_USE_AVX2 )
+
+    if ( LEVEL >= VN_CPU_LEVEL_AVX2 )
+    {
+        for ( ; iX + 32 <= uiPixelCount; iX += 32 )
+        {
+            vnDesaturateBlock32< STRIDE >( pInput + iX * STRIDE, iPairWeights, iThirdWeights, pOutput + iX );
+        }
+    }
+
+#endif
+
+#if defined ( VN_DESATURATE_USE_SSSE3 )
+
+    if ( LEVEL >= VN_CPU_LEVEL_SSSE3 )
+    {
+        for ( ; iX + 16 <= uiPixelCount; iX += 16 )
+        {
+            vnDesaturateBlock16< STRIDE >( pInput + iX * STRIDE, iPairWeights, iThirdWeights, pOutput + iX );
+        }
+    }
+
+#endif
+
+    for ( ; iX < uiPixelCount; iX++ )
+    {
+        pOutput[ iX ] = vnDesaturatePixel( format, pInput + iX * STRIDE );
+    }
+}
+
+//
+// vnBindDesaturateKernel
+//
+//   Returns the line kernel for pixels of STRIDE bytes that best suits the host processor.
+//   Kernels are bound once, when the module is loaded.
+//
+
+typedef VOID ( *VN_DESATURATE_KERNEL )( VN_IMAGE_FORMAT format, CONST UINT8 * pInput, UINT32 uiPixelCount, UINT8 * pOutput );
+
+template < UINT32 STRIDE >
+VN_DESATURATE_KERNEL vnBindDesaturateKernel()
+{
+    UINT32 uiLevel = vnQueryCpuLevel();
+
+#if defined ( VN_DESATURATE_USE_AVX2 )
+
+    if ( uiLevel >= VN_CPU_LEVEL_AVX2 )
+    {
+        return vnDesaturateChannels< STRIDE, VN_CPU_LEVEL_AVX2 >;
+    }
+
+#endif
+
+#if defined ( VN_DESATURATE_USE_SSSE3 )
+
+    if ( uiLevel >= VN_CPU_LEVEL_SSSE3 )
+    {
+        return vnDesaturateChannels< STRIDE, VN_CPU_LEVEL_SSSE3 >;
+    }
+
+#endif
+
+    return vnDesaturateChannels< STRIDE, VN_CPU_LEVEL_SCALAR >;
+}
+
+static VN_DESATURATE_KERNEL g_pfnDesaturate24 = vnBindDesaturateKernel< 3 >();
+static VN_DESATURATE_KERNEL g_pfnDesaturate32 = vnBindDesaturateKernel< 4 >();
+
+VN_STATUS vnDesaturateLine( VN_IMAGE_FORMAT format, IN UINT8 * pInput, UINT32 uiPixelCount, UINT8 * pOutput )
 {
     if ( VN_PARAM_CHECK )
     {
@@ -9,43 +225,65 @@ VN_STATUS vnDesaturateLine( IN UINT8 * pInput, UINT32 uiPixelCount, UINT8 * pOut
         {
             return vnPostError( VN_ERROR_INVALIDARG );
         }
+
+        if ( !VN_IS_IMAGE_LUMA_FORMAT( format ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
     }
 
     //
-    // We generate a grayscale image through desaturation. This method is preferred because
-    // it favors the color channels in a human perceptual manner.
+    // Gray lines and Y planes already hold luma, so they require no conversion.
     //
 
-    for ( UINT32 iX = 0; iX < uiPixelCount; iX++ )
+    if ( VN_IS_IMAGE_LUMA_PLANE( format ) )
     {
-        UINT8 * pSrcPixel   = pInput + iX * 3;
-        UINT8 * pDestPixel  = pOutput + iX;
+        vnCopyMemory( pOutput, pInput, uiPixelCount );
 
-        INT16 iSrcRed   = pSrcPixel[0];
-        INT16 iSrcGreen = pSrcPixel[1];
-        INT16 iSrcBlue  = pSrcPixel[2];
+        return VN_SUCCESS;
+    }
 
-        pDestPixel[0] = ( ( iSrcRed * 0x4CC ) + ( iSrcGreen * 0x970 ) + ( iSrcBlue * 0x1C2 ) ) >> 12; 
+    //
+    // We generate a grayscale image through desaturation. This method is preferred because
+    // it favors the color channels in a human perceptual manner. The alpha channel (if any) 
+    // is ignored.
+    //
+
+    if ( 32 == VN_IMAGE_PIXEL_RATE( format ) )
+    {
+        g_pfnDesaturate32( format, pInput, uiPixelCount, pOutput );
+    }
+    else
+    {
+        g_pfnDesaturate24( format, pInput, uiPixelCount, pOutput );
     }
 
     return VN_SUCCESS;
 }
 
-VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage ** pDestImage )
+VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage * pDestImage )
 {
     if ( VN_PARAM_CHECK )
     {
-        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pDestImage )
+        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pDestImage || &pSrcImage == pDestImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( !VN_IS_IMAGE_LUMA_FORMAT( pSrcImage.QueryFormat() ) )
         {
             return vnPostError( VN_ERROR_INVALIDARG );
         }
     }
 
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_DESATURATE, VN_IMAGE_PIXEL_BYTES( pSrcImage ) + (UINT64) pSrcImage.QueryWidth() * pSrcImage.QueryHeight() );
+
     //
-    // Create our destination image as a single channel 8 bit format.
+    // Shape our destination image as a single channel 8 bit format.
     //
 
-    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), pDestImage ) ) )
+    if ( VN_FAILED( vnReshapeImage( VN_IMAGE_FORMAT_R8, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), pDestImage ) ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
@@ -57,10 +295,10 @@ VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage ** pDestIm
 
     for ( UINT32 iY = 0; iY < pSrcImage.QueryHeight(); iY++ )
     {
-        UINT8 * pSrcLine  = pSrcImage.QueryData() + iY * pSrcImage.RowPitch();
-        UINT8 * pDestLine = (*pDestImage)->QueryData() + iY * (*pDestImage)->RowPitch();
+        UINT8 * pSrcLine  = pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, iY );
+        UINT8 * pDestLine = pDestImage->QueryData() + pDestImage->BlockOffset( 0, iY );
 
-        if ( VN_FAILED( vnDesaturateLine( pSrcLine, pSrcImage.QueryWidth(), pDestLine ) ) )
+        if ( VN_FAILED( vnDesaturateLine( pSrcImage.QueryFormat(), pSrcLine, pSrcImage.QueryWidth(), pDestLine ) ) )
         {
             return vnPostError( VN_ERROR_EXECUTION_FAILURE );
         }
@@ -68,3 +306,25 @@ VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage ** pDestIm
 
     return VN_SUCCESS;
 }
+
+VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage ** pDestImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pDestImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    //
+    // Create our destination image as a single channel 8 bit format.
+    //
+
+    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), pDestImage ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return vnDesaturateImage( pSrcImage, *pDestImage );
+}
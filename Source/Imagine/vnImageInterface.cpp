@@ -1,7 +1,29 @@
 
 #include "vnImagine.h"
+#include <new>
 
-VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, OUT CVImage ** pOutImage )
+//
+// vnAllocateImage
+//
+//   Constructs an empty image object within memory acquired from the current allocator
+//   of the calling thread. Returns NULL on failure.
+//
+
+CVImage * vnAllocateImage()
+{
+    VOID * pMemory = vnQueryThreadAllocator()->Allocate( sizeof( CVImage ) );
+
+    if ( !pMemory )
+    {
+        return NULL;
+    }
+
+    vnCountAllocation( sizeof( CVImage ) );
+
+    return new ( pMemory ) CVImage;
+}
+
+VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, VN_IMAGE_CREATE_FLAGS uiFlags, OUT CVImage ** pOutImage )
 {
     if ( VN_PARAM_CHECK )
     {
@@ -16,13 +38,15 @@ VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight
         }
     }
 
-    (*pOutImage) = new CVImage;
+    (*pOutImage) = vnAllocateImage();
 
     if ( !(*pOutImage) )
     {
         return vnPostError( VN_ERROR_OUTOFMEMORY );
     }
 
+    (*pOutImage)->m_uiCreateFlags = uiFlags;
+
     if ( VN_FAILED( (*pOutImage)->SetFormat( format ) ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
@@ -36,6 +60,193 @@ VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight
     return VN_SUCCESS;
 }
 
+VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, OUT CVImage ** pOutImage )
+{
+    return vnCreateImage( format, uiWidth, uiHeight, VN_IMAGE_CREATE_DEFAULT, pOutImage );
+}
+
+VN_STATUS vnReshapeImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( 0 == uiWidth || 0 == uiHeight || !pImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( VN_FAILED( pImage->SetFormat( format ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( VN_FAILED( pImage->SetDimension( uiWidth, uiHeight ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnWrapImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, IN UINT8 * pData, UINT32 uiRowPitch, INOUT CVImage * pImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( 0 == uiWidth || 0 == uiHeight || !pData || !pImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( VN_FAILED( pImage->SetFormat( format ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    //
+    // A zero pitch indicates tightly packed rows, whose byte width must fit a 32 bit pitch.
+    //
+
+    if ( 0 == uiRowPitch )
+    {
+        UINT64 uiPackedPitch = ( (UINT64) uiWidth * pImage->QueryBitsPerPixel() ) >> 3;
+
+        if ( uiPackedPitch > VN_MAX_UINT32 )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        uiRowPitch = (UINT32) uiPackedPitch;
+    }
+
+    if ( VN_FAILED( pImage->Wrap( pData, uiWidth, uiHeight, uiRowPitch ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnWrapImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, IN UINT8 * pData, UINT32 uiRowPitch, OUT CVImage ** pOutImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pOutImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    (*pOutImage) = vnAllocateImage();
+
+    if ( !(*pOutImage) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    //
+    // The image object is ours until the view succeeds, and is released if it fails.
+    //
+
+    if ( VN_FAILED( vnWrapImage( format, uiWidth, uiHeight, pData, uiRowPitch, *pOutImage ) ) )
+    {
+        vnDestroyImage( *pOutImage );
+
+        (*pOutImage) = NULL;
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnWrapImage( CONST CVImage & pSrcImage, UINT32 uiX, UINT32 uiY, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || 0 == uiWidth || 0 == uiHeight || !pImage || &pSrcImage == pImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( uiX + uiWidth > pSrcImage.QueryWidth() || uiY + uiHeight > pSrcImage.QueryHeight() )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    return vnWrapImage( pSrcImage.QueryFormat(), uiWidth, uiHeight, pSrcImage.QueryData() + pSrcImage.BlockOffset( uiX, uiY ), 
+                        pSrcImage.RowPitch(), pImage );
+}
+
+VN_STATUS vnWrapImage( CONST CVImage & pSrcImage, UINT32 uiX, UINT32 uiY, UINT32 uiWidth, UINT32 uiHeight, OUT CVImage ** pOutImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pOutImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    (*pOutImage) = vnAllocateImage();
+
+    if ( !(*pOutImage) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    if ( VN_FAILED( vnWrapImage( pSrcImage, uiX, uiY, uiWidth, uiHeight, *pOutImage ) ) )
+    {
+        vnDestroyImage( *pOutImage );
+
+        (*pOutImage) = NULL;
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnCopyImage( CONST CVImage & pSrcImage, INOUT CVImage * pDestImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pDestImage || &pSrcImage == pDestImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    UINT32 uiHeight  = pSrcImage.QueryHeight();
+    UINT32 uiRowSize = ( pSrcImage.QueryWidth() * pSrcImage.QueryBitsPerPixel() ) >> 3;
+
+    if ( VN_FAILED( vnReshapeImage( pSrcImage.QueryFormat(), pSrcImage.QueryWidth(), uiHeight, pDestImage ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    for ( UINT32 j = 0; j < uiHeight; j++ )
+    {
+        vnCopyMemory( pDestImage->QueryData() + pDestImage->BlockOffset( 0, j ), pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, j ), uiRowSize );
+    }
+
+    //
+    // Chroma planes follow the Y plane of planar images that own their memory. Views only
+    // describe their Y plane, so a copy of a view leaves the chroma of the destination as is.
+    //
+
+    UINT64 uiSrcChromaSize  = pSrcImage.SlicePitch() - pSrcImage.BlockOffset( 0, uiHeight );
+    UINT64 uiDestChromaSize = pDestImage->SlicePitch() - pDestImage->BlockOffset( 0, uiHeight );
+
+    if ( uiSrcChromaSize && uiSrcChromaSize == uiDestChromaSize )
+    {
+        vnCopyMemory( pDestImage->QueryData() + pDestImage->BlockOffset( 0, uiHeight ), pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, uiHeight ), uiSrcChromaSize );
+    }
+
+    return VN_SUCCESS;
+}
+
 VN_STATUS vnDestroyImage( CVImage * pInImage )
 {
     if ( !pInImage )
@@ -43,12 +254,16 @@ VN_STATUS vnDestroyImage( CVImage * pInImage )
         return VN_SUCCESS;
     }
 
+    CVAllocator * pAllocator = pInImage->m_pAllocator;
+
     if ( VN_FAILED( pInImage->Deallocate() ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
-    delete pInImage;
+    pInImage->~CVImage();
+
+    pAllocator->Free( pInImage, sizeof( CVImage ) );
 
     return VN_SUCCESS;
 }
\ No newline at end of file
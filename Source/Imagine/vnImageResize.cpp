@@ -2,169 +2,1431 @@
 #include "vnImagine.h"
 
 //
-// (!) Note: See the Imagine framework for a float-free implementation of this filter.
+// The fixed point filter stores its normalized weights with this many fractional bits. Weights
+// of a single output sum to exactly one, so a 32 bit sum of 8 bit samples cannot overflow, and
+// each weight (and each pair of products) fits the 16 bit multiply-add of our vector kernels.
 //
 
-UINT8 vnCoverageSampleVertical( CONST CVImage & pSrcImage,FLOAT32 fX, FLOAT32 fY, FLOAT32 fRadius )
+#define VN_RESIZE_FIXED_POINT_SHIFT                 (14)
+#define VN_RESIZE_FIXED_POINT_ONE                   (1 << VN_RESIZE_FIXED_POINT_SHIFT)
+#define VN_RESIZE_FIXED_POINT_HALF                  (1 << ( VN_RESIZE_FIXED_POINT_SHIFT - 1 ))
+
+//
+// The default filter switches to area averaging once the source is at least this many times 
+// larger than the destination along both axes. The cost of our other filters grows with the 
+// ratio, while that of the area filter does not.
+//
+
+#define VN_RESIZE_AREA_MIN_RATIO                    (4)
+
+//
+// Vector builds filter 16 (SSE2) or 32 (AVX2) adjacent samples at a time, using the widest
+// kernels that the host supports. Set VN_RESIZE_ENABLE_VECTOR to zero to force the scalar 
+// reference kernels.
+//
+
+#define VN_RESIZE_ENABLE_VECTOR                     (1)
+
+#if VN_RESIZE_ENABLE_VECTOR && ( defined ( VN_SIMD_AVX2 ) || defined ( VN_SIMD_DISPATCH ) )
+    #define VN_RESIZE_USE_AVX2
+    #define VN_RESIZE_USE_SSSE3
+    #define VN_RESIZE_USE_VECTOR
+    #include <immintrin.h>
+#elif VN_RESIZE_ENABLE_VECTOR && defined ( VN_SIMD_SSE2 )
+    #define VN_RESIZE_USE_VECTOR
+    #include <emmintrin.h>
+#endif
+
+//
+// Contributor Tables
+//
+//   A contributor table holds the taps of our coverage kernel along a single axis. The kernel 
+//   weights depend only upon the output column (or row), so we evaluate them once per resize
+//   rather than once per pixel. Every output sample receives the same number of taps so that 
+//   our filter loops are free of branches. Taps that fall outside of the source are assigned a 
+//   zero weight (and a valid index), which leaves a running sum untouched.
+//
+//   We keep the raw tent weights, along with their total for each output, rather than normalized
+//   weights. Our filters accumulate into an integer after each tap and divide by the total once
+//   per output, exactly as our original per pixel samplers did, so resized images (and thus our
+//   hashes) are unchanged.
+//
+
+//
+// vnQueryContributorTapCount
+//
+//   Returns the number of taps per output of a kernel with radius fRatio.
+//
+
+UINT32 vnQueryContributorTapCount( FLOAT32 fRatio )
+{
+    INT32 iRadius = fRatio + 1.0f;
+
+    return ( 0 == fRatio ? 1 : iRadius << 1 );
+}
+
+//
+// vnBuildContributors
+//
+//   Fills pTable for uiDestLength outputs sampled from uiSrcLength inputs, whose centers are 
+//   spaced fRatio inputs apart. The table storage must already be attached, and each offset is
+//   scaled by uiStride.
+//
+
+VOID vnBuildContributors( UINT32 uiSrcLength, UINT32 uiDestLength, FLOAT32 fRatio, UINT32 uiStride, INOUT CVResizeContributors * pTable )
+{
+    INT32 iRadius = fRatio + 1.0f;
+
+    pTable->m_uiTapCount = vnQueryContributorTapCount( fRatio );
+
+    for ( UINT32 i = 0; i < uiDestLength; i++ )
+    {
+        FLOAT32 fCenter       = i * fRatio;
+        FLOAT32 fSampleCount  = 0;
+        INT32 * piOffset      = pTable->m_piOffset + i * pTable->m_uiTapCount;
+        FLOAT32 * pfWeight    = pTable->m_pfWeight + i * pTable->m_uiTapCount;
+
+        if ( 0 == fRatio )
+        {
+            //
+            // A single source sample (or a degenerate ratio) simply replicates the nearest input.
+            //
+
+            piOffset[ 0 ]                 = VN_MIN2( (UINT32) fCenter, uiSrcLength - 1 ) * uiStride;
+            pfWeight[ 0 ]                 = 1.0f;
+            pTable->m_pfWeightTotal[ i ] = 1.0f;
+
+            continue;
+        }
+
+        for ( INT32 j = -iRadius + 1; j <= iRadius; j++, piOffset++, pfWeight++ )
+        {
+            INT32 iIndex = fCenter + j;
+
+            if ( iIndex < 0 || iIndex > (INT32) uiSrcLength - 1 )
+            {
+                piOffset[ 0 ] = ( iIndex < 0 ? 0 : uiSrcLength - 1 ) * uiStride;
+                pfWeight[ 0 ] = 0.0f;
+
+                continue;
+            }
+
+            //
+            // Since we're minifying, we can compute a simple distance based weighted average 
+            // using our calculated radius (fRatio)
+            //
+
+            FLOAT32 fDelta    = fCenter - iIndex;
+            FLOAT32 fDistance = VN_MIN2( fRatio, fabs( fDelta ) );
+
+            piOffset[ 0 ]  = iIndex * uiStride;
+            pfWeight[ 0 ]  = 1.0f - fDistance / fRatio;
+            fSampleCount  += pfWeight[ 0 ];
+        }
+
+        pTable->m_pfWeightTotal[ i ] = fSampleCount;
+    }
+}
+
+//
+// vnResizeRowHorizontal
+//
+//   Filters a single source row into uiDestWidth samples. Offsets are measured in bytes.
+//
+
+VOID vnResizeRowHorizontal( CONST UINT8 * pSrcLine, CONST CVResizeContributors & pTable, UINT32 uiDestWidth, UINT8 * pDestLine )
+{
+    UINT32 uiTapCount      = pTable.m_uiTapCount;
+    CONST INT32 * piOffset = pTable.m_piOffset;
+    CONST FLOAT32 * pfWeight = pTable.m_pfWeight;
+
+    for ( UINT32 i = 0; i < uiDestWidth; i++, piOffset += uiTapCount, pfWeight += uiTapCount )
+    {
+        INT32 iResult = 0;
+
+        for ( UINT32 k = 0; k < uiTapCount; k++ )
+        {
+            iResult += pfWeight[ k ] * pSrcLine[ piOffset[ k ] ];
+        }
+
+        //
+        // Normalize our sum back to the valid pixel range
+        //
+
+        pDestLine[ i ] = ( iResult / pTable.m_pfWeightTotal[ i ] );
+    }
+}
+
+//
+// vnResizeRowVertical
+//
+//   Filters horizontally filtered rows into output row j. Rows are held in pRing, a ring of 
+//   uiRingSize tightly packed rows of uiWidth bytes, where source row y occupies slot y modulo
+//   uiRingSize. Each tap contributes an entire row, so the inner loop streams through memory.
+//
+
+VOID vnResizeRowVertical( CONST UINT8 * pRing, UINT32 uiRingSize, CONST CVResizeContributors & pTable, UINT32 j, UINT32 uiWidth, INT32 * piAccumulator, UINT8 * pDestLine, UINT32 uiDestStride )
+{
+    UINT32 uiTapCount        = pTable.m_uiTapCount;
+    CONST INT32 * piOffset   = pTable.m_piOffset + j * uiTapCount;
+    CONST FLOAT32 * pfWeight = pTable.m_pfWeight + j * uiTapCount;
+    FLOAT32 fSampleCount     = pTable.m_pfWeightTotal[ j ];
+
+    vnZeroMemory( piAccumulator, uiWidth * sizeof( INT32 ) );
+
+    for ( UINT32 k = 0; k < uiTapCount; k++ )
+    {
+        CONST UINT8 * pSrcLine = pRing + ( piOffset[ k ] % uiRingSize ) * uiWidth;
+        FLOAT32 fWeight        = pfWeight[ k ];
+
+        for ( UINT32 i = 0; i < uiWidth; i++ )
+        {
+            piAccumulator[ i ] += fWeight * pSrcLine[ i ];
+        }
+    }
+
+    for ( UINT32 i = 0; i < uiWidth; i++ )
+    {
+        pDestLine[ i * uiDestStride ] = ( piAccumulator[ i ] / fSampleCount );
+    }
+}
+
+//
+// vnQueryLastContributor
+//
+//   Returns the last source row that contributes to output row j of a vertical table.
+//
+
+UINT32 vnQueryLastContributor( CONST CVResizeContributors & pTable, UINT32 j )
+{
+    CONST INT32 * piOffset = pTable.m_piOffset + j * pTable.m_uiTapCount;
+    INT32 iLast            = 0;
+
+    for ( UINT32 k = 0; k < pTable.m_uiTapCount; k++ )
+    {
+        iLast = VN_MAX2( iLast, piOffset[ k ] );
+    }
+
+    return iLast;
+}
+
+//
+// vnAcquireResizeScratch
+//
+//   Returns uiSize bytes of scratch memory. The memory lives within pWorkspace if one is provided,
+//   and is otherwise allocated and returned in ppOwned, which the caller must delete. Returns NULL
+//   if the size exceeds a single workspace row, or the address space of the build.
+//
+
+UINT8 * vnAcquireResizeScratch( UINT64 uiSize, INOUT CVImage * pWorkspace, OUT UINT8 ** ppOwned )
+{
+    (*ppOwned) = NULL;
+
+    if ( uiSize > VN_MAX_UINT32 || uiSize != (SIZE_T) uiSize )
+    {
+        return NULL;
+    }
+
+    if ( !pWorkspace )
+    {
+        (*ppOwned) = new UINT8[ (SIZE_T) uiSize ];
+
+        return (*ppOwned);
+    }
+
+    if ( VN_FAILED( vnReshapeImage( VN_IMAGE_FORMAT_R8, (UINT32) uiSize, 1, pWorkspace ) ) )
+    {
+        return NULL;
+    }
+
+    return pWorkspace->QueryData();
+}
+
+//
+// vnQueryResizeRatio
+//
+//   Returns the spacing, in source samples, of the centers of uiDestLength samples that span
+//   uiSrcLength samples.
+//
+
+FLOAT32 vnQueryResizeRatio( UINT32 uiSrcLength, UINT32 uiDestLength )
+{
+    return ( 1 == uiDestLength ? 1.0f : static_cast<FLOAT32>( uiSrcLength - 1 ) / ( uiDestLength - 1 ) );
+}
+
+CVResizeStream::CVResizeStream()
+{
+    m_pDestImage        = NULL;
+    m_uiSrcFormat       = VN_IMAGE_FORMAT_NONE;
+    m_uiSrcWidth        = 0;
+    m_uiSrcHeight       = 0;
+    m_uiSrcRow          = 0;
+    m_uiDestRow         = 0;
+    m_uiRingSize        = 0;
+    m_bDesaturate       = FALSE;
+    m_piAccumulator     = NULL;
+    m_pRing             = NULL;
+    m_pGrayLine         = NULL;
+    m_pOwnedScratch     = NULL;
+}
+
+CVResizeStream::~CVResizeStream()
+{
+    delete [] m_pOwnedScratch;
+}
+
+VN_STATUS CVResizeStream::Begin( VN_IMAGE_FORMAT format, UINT32 uiSrcWidth, UINT32 uiSrcHeight, BOOL bDesaturate, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( 0 == uiSrcWidth || 0 == uiSrcHeight || !pDestImage || !VN_IS_IMAGE_VALID( *pDestImage ) || pWorkspace == pDestImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( 0 == VN_IMAGE_CHANNEL_COUNT( format ) || ( bDesaturate && !VN_IS_IMAGE_LUMA_FORMAT( format ) ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    //
+    // We rely upon coverage filtering because it allows us to perform very large
+    // resolution changes without suffering from precision, range, and sampling issues.
+    // Only the first channel of each pixel is filtered, unless bDesaturate is set, in which 
+    // case each color source row is desaturated (see vnDesaturateLine) just before it is 
+    // filtered.
+    //
+    // Source rows arrive once, in order. Each is filtered horizontally into a small ring of 
+    // rows, and each output row is produced as soon as its last source row arrives. The 
+    // ring only needs to span the taps of a single output, since the taps of later outputs 
+    // never begin before those of earlier outputs.
+    //
+    // Our scratch memory holds both contributor tables, a row of accumulators, the ring of
+    // ( dest width x ring size ) horizontally filtered samples, and (when desaturating) a
+    // single gray source row. It lives within the caller's workspace, if one is provided.
+    //
+
+    FLOAT32 fHRatio         = vnQueryResizeRatio( uiSrcWidth, pDestImage->QueryWidth() );
+    FLOAT32 fVRatio         = vnQueryResizeRatio( uiSrcHeight, pDestImage->QueryHeight() );
+    UINT32 uiDestWidth      = pDestImage->QueryWidth();
+    UINT32 uiDestHeight     = pDestImage->QueryHeight();
+    UINT32 uiSrcPixelSize   = ( bDesaturate ? 1 : VN_IMAGE_PIXEL_RATE( format ) >> 3 );
+    UINT32 uiHorizTapCount  = vnQueryContributorTapCount( fHRatio );
+    UINT32 uiVertTapCount   = vnQueryContributorTapCount( fVRatio );
+    UINT32 uiRingSize       = VN_MIN2( uiVertTapCount, uiSrcHeight );
+    UINT64 uiTableSize      = ( (UINT64) uiDestWidth * uiHorizTapCount + (UINT64) uiDestHeight * uiVertTapCount ) * 2 + uiDestWidth + uiDestHeight;
+    UINT64 uiScratchSize    = ( uiTableSize + uiDestWidth ) * sizeof( INT32 ) + (UINT64) uiDestWidth * uiRingSize + ( bDesaturate ? uiSrcWidth : 0 );
+
+    delete [] m_pOwnedScratch;
+
+    UINT8 * pScratch        = vnAcquireResizeScratch( uiScratchSize, pWorkspace, &m_pOwnedScratch );
+
+    if ( !pScratch )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    m_pHorizTable.m_piOffset        = reinterpret_cast<INT32 *>( pScratch );
+    m_pHorizTable.m_pfWeight        = reinterpret_cast<FLOAT32 *>( m_pHorizTable.m_piOffset + uiDestWidth * uiHorizTapCount );
+    m_pHorizTable.m_pfWeightTotal   = m_pHorizTable.m_pfWeight + uiDestWidth * uiHorizTapCount;
+    m_pVertTable.m_piOffset         = reinterpret_cast<INT32 *>( m_pHorizTable.m_pfWeightTotal + uiDestWidth );
+    m_pVertTable.m_pfWeight         = reinterpret_cast<FLOAT32 *>( m_pVertTable.m_piOffset + uiDestHeight * uiVertTapCount );
+    m_pVertTable.m_pfWeightTotal    = m_pVertTable.m_pfWeight + uiDestHeight * uiVertTapCount;
+
+    m_piAccumulator     = reinterpret_cast<INT32 *>( m_pVertTable.m_pfWeightTotal + uiDestHeight );
+    m_pRing             = reinterpret_cast<UINT8 *>( m_piAccumulator + uiDestWidth );
+    m_pGrayLine         = m_pRing + uiDestWidth * uiRingSize;
+
+    vnBuildContributors( uiSrcWidth, uiDestWidth, fHRatio, uiSrcPixelSize, &m_pHorizTable );
+    vnBuildContributors( uiSrcHeight, uiDestHeight, fVRatio, 1, &m_pVertTable );
+
+    m_pDestImage        = pDestImage;
+    m_uiSrcFormat       = format;
+    m_uiSrcWidth        = uiSrcWidth;
+    m_uiSrcHeight       = uiSrcHeight;
+    m_uiSrcRow          = 0;
+    m_uiDestRow         = 0;
+    m_uiRingSize        = uiRingSize;
+    m_bDesaturate       = bDesaturate;
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS CVResizeStream::PushRow( IN UINT8 * pSrcLine )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pSrcLine )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( !m_pDestImage || m_uiSrcRow >= m_uiSrcHeight )
+        {
+            return vnPostError( VN_ERROR_NOT_READY );
+        }
+    }
+
+    UINT32 y = m_uiSrcRow++;
+
+    //
+    // Rows beyond the last contributor of our final output are not needed.
+    //
+
+    if ( IsComplete() )
+    {
+        return VN_SUCCESS;
+    }
+
+    if ( m_bDesaturate )
+    {
+        CVStageTimer pTimer( VN_COUNTER_STAGE_DESATURATE, (UINT64) m_uiSrcWidth * ( ( VN_IMAGE_PIXEL_RATE( m_uiSrcFormat ) >> 3 ) + 1 ) );
+
+        vnDesaturateLine( m_uiSrcFormat, pSrcLine, m_uiSrcWidth, m_pGrayLine );
+
+        pSrcLine = m_pGrayLine;
+    }
+
+    //
+    // Perform the horizontal filter sampling of this row, and then the vertical filter 
+    // sampling of every output row that it completes.
+    //
+
+    UINT32 uiDestWidth     = m_pDestImage->QueryWidth();
+    UINT32 uiDestHeight    = m_pDestImage->QueryHeight();
+    UINT32 uiDestPixelSize = m_pDestImage->QueryBitsPerPixel() >> 3;
+
+    vnResizeRowHorizontal( pSrcLine, m_pHorizTable, uiDestWidth, m_pRing + ( y % m_uiRingSize ) * uiDestWidth );
+
+    for ( ; m_uiDestRow < uiDestHeight && vnQueryLastContributor( m_pVertTable, m_uiDestRow ) <= y; m_uiDestRow++ )
+    {
+        vnResizeRowVertical( m_pRing, m_uiRingSize, m_pVertTable, m_uiDestRow, uiDestWidth, m_piAccumulator, 
+                             m_pDestImage->QueryData() + m_pDestImage->BlockOffset( 0, m_uiDestRow ), uiDestPixelSize );
+    }
+
+    return VN_SUCCESS;
+}
+
+BOOL CVResizeStream::IsComplete() CONST
+{
+    return ( m_pDestImage && m_uiDestRow >= m_pDestImage->QueryHeight() );
+}
+
+VN_STATUS vnResizeImageSeparable( CONST CVImage & pSrcImage, BOOL bDesaturate, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
+    CVResizeStream pStream;
+
+    if ( VN_FAILED( pStream.Begin( pSrcImage.QueryFormat(), pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), bDesaturate, pDestImage, pWorkspace ) ) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    for ( UINT32 y = 0; y < pSrcImage.QueryHeight() && !pStream.IsComplete(); y++ )
+    {
+        pStream.PushRow( pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, y ) );
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// Fixed Point Contributor Tables
+//
+//   The fixed point filter evaluates the same coverage kernel, but normalizes the weights of each
+//   output up front and quantizes them to VN_RESIZE_FIXED_POINT_SHIFT bits. The taps of an output
+//   are stored as a window of consecutive source samples that begins at m_piFirst, so that our
+//   kernels may load them directly. Windows never extend beyond the source, so edge outputs carry
+//   zero weights in place of their missing taps.
+//
+
+class VN_NONVIRTUAL CVResizeFixedContributors
+{
+public:
+
+    UINT32                      m_uiTapCount;       // taps per output sample
+    INT32 *                     m_piFirst;          // index of the first source sample of each output
+    INT16 *                     m_piWeight;         // normalized weight of each tap
+
+public:
+
+    CVResizeFixedContributors() : m_uiTapCount( 0 ), m_piFirst( 0 ), m_piWeight( 0 ) {}
+};
+
+//
+// vnQueryFixedContributorTapCount
+//
+//   Returns the number of taps per output of a fixed point table. Windows are clamped to the
+//   source, so they never hold more taps than the source has samples.
+//
+
+UINT32 vnQueryFixedContributorTapCount( UINT32 uiSrcLength, FLOAT32 fRatio )
+{
+    return VN_MIN2( vnQueryContributorTapCount( fRatio ), uiSrcLength );
+}
+
+//
+// vnBuildFixedContributors
+//
+//   Fills pTable for uiDestLength outputs sampled from uiSrcLength inputs, whose centers are 
+//   spaced fRatio inputs apart. The table storage must already be attached.
+//
+
+VOID vnBuildFixedContributors( UINT32 uiSrcLength, UINT32 uiDestLength, FLOAT32 fRatio, INOUT CVResizeFixedContributors * pTable )
+{
+    INT32 iRadius   = fRatio + 1.0f;
+    INT32 iMaxFirst = uiSrcLength - vnQueryFixedContributorTapCount( uiSrcLength, fRatio );
+
+    pTable->m_uiTapCount = vnQueryFixedContributorTapCount( uiSrcLength, fRatio );
+
+    for ( UINT32 i = 0; i < uiDestLength; i++ )
+    {
+        FLOAT32 fCenter      = i * fRatio;
+        FLOAT32 fSampleCount = 0;
+        INT32 iNearest       = VN_MIN2( (UINT32) fCenter, uiSrcLength - 1 );
+        INT32 iFirst         = VN_MIN2( VN_MAX2( (INT32) ( fCenter + ( 1 - iRadius ) ), 0 ), iMaxFirst );
+        INT16 * piWeight     = pTable->m_piWeight + i * pTable->m_uiTapCount;
+
+        vnZeroMemory( piWeight, pTable->m_uiTapCount * sizeof( INT16 ) );
+
+        if ( 0 != fRatio )
+        {
+            for ( INT32 j = -iRadius + 1; j <= iRadius; j++ )
+            {
+                INT32 iIndex = fCenter + j;
+
+                if ( iIndex >= 0 && iIndex <= (INT32) uiSrcLength - 1 )
+                {
+                    fSampleCount += 1.0f - VN_MIN2( fRatio, fabs( fCenter - iIndex ) ) / fRatio;
+                }
+            }
+        }
+
+        if ( 0 == fSampleCount )
+        {
+            //
+            // A single source sample (or a degenerate kernel) simply replicates the nearest input.
+            //
+
+            iFirst                          = VN_MIN2( iNearest, iMaxFirst );
+            piWeight[ iNearest - iFirst ]   = VN_RESIZE_FIXED_POINT_ONE;
+            pTable->m_piFirst[ i ]          = iFirst;
+
+            continue;
+        }
+
+        //
+        // Quantize the running sum of our normalized weights, rather than each weight, so that
+        // the weights of every output are non-negative and sum to exactly one. Truncation may map
+        // two taps near the origin onto the same sample, in which case their weights combine.
+        //
+
+        FLOAT32 fRunningCount = 0;
+        INT32 iPrevBoundary   = 0;
+
+        for ( INT32 j = -iRadius + 1; j <= iRadius; j++ )
+        {
+            INT32 iIndex = fCenter + j;
+
+            if ( iIndex < 0 || iIndex > (INT32) uiSrcLength - 1 )
+            {
+                continue;
+            }
+
+            fRunningCount += 1.0f - VN_MIN2( fRatio, fabs( fCenter - iIndex ) ) / fRatio;
+
+            INT32 iBoundary = VN_MIN2( (INT32) ( fRunningCount / fSampleCount * VN_RESIZE_FIXED_POINT_ONE + 0.5f ), VN_RESIZE_FIXED_POINT_ONE );
+
+            piWeight[ iIndex - iFirst ] += iBoundary - iPrevBoundary;
+            iPrevBoundary                = iBoundary;
+        }
+
+        piWeight[ iNearest - iFirst ] += VN_RESIZE_FIXED_POINT_ONE - iPrevBoundary;
+        pTable->m_piFirst[ i ]         = iFirst;
+    }
+}
+
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+//
+// Vector Primitives
+//
+//   Our vertical kernel widens the samples of two source rows (one vector of each) into 
+//   interleaved 16 bit pairs, and accumulates each pair against the weights of its rows with a 
+//   single 16 bit multiply-add. AVX2 kernels operate within 128 bit lanes, but the final packs 
+//   undo the lane order of the unpacks, so both kernels store their samples in order. Primitives
+//   that do not take a vector are selected by the instruction set level of their caller.
+//
+
+template < UINT32 LEVEL > struct CVResizeVector {};
+template <> struct CVResizeVector< VN_CPU_LEVEL_SSE2 > { typedef __m128i TYPE; };
+
+template < UINT32 LEVEL > typename CVResizeVector< LEVEL >::TYPE vnResizeZero();
+template < UINT32 LEVEL > typename CVResizeVector< LEVEL >::TYPE vnResizeSplat( INT32 iValue );
+template < UINT32 LEVEL > typename CVResizeVector< LEVEL >::TYPE vnResizeLoad( CONST UINT8 * pSrc );
+
+template <> inline __m128i vnResizeZero< VN_CPU_LEVEL_SSE2 >() { return _mm_setzero_si128(); }
+template <> inline __m128i vnResizeSplat< VN_CPU_LEVEL_SSE2 >( INT32 iValue ) { return _mm_set1_epi32( iValue ); }
+template <> inline __m128i vnResizeLoad< VN_CPU_LEVEL_SSE2 >( CONST UINT8 * pSrc ) { return _mm_loadu_si128( (CONST __m128i *) pSrc ); }
+
+inline VOID vnResizeStore( UINT8 * pDest, CONST __m128i & vA ) { _mm_storeu_si128( (__m128i *) pDest, vA ); }
+inline __m128i vnResizeUnpackLow8( CONST __m128i & vA, CONST __m128i & vB ) { return _mm_unpacklo_epi8( vA, vB ); }
+inline __m128i vnResizeUnpackHigh8( CONST __m128i & vA, CONST __m128i & vB ) { return _mm_unpackhi_epi8( vA, vB ); }
+inline __m128i vnResizeUnpackLow16( CONST __m128i & vA, CONST __m128i & vB ) { return _mm_unpacklo_epi16( vA, vB ); }
+inline __m128i vnResizeUnpackHigh16( CONST __m128i & vA, CONST __m128i & vB ) { return _mm_unpackhi_epi16( vA, vB ); }
+inline __m128i vnResizeMultiplyAdd( CONST __m128i & vSum, CONST __m128i & vA, CONST __m128i & vB ) { return _mm_add_epi32( vSum, _mm_madd_epi16( vA, vB ) ); }
+inline __m128i vnResizeShift( CONST __m128i & vA ) { return _mm_srai_epi32( vA, VN_RESIZE_FIXED_POINT_SHIFT ); }
+inline __m128i vnResizePack32( CONST __m128i & vA, CONST __m128i & vB ) { return _mm_packs_epi32( vA, vB ); }
+inline __m128i vnResizePack16( CONST __m128i & vA, CONST __m128i & vB ) { return _mm_packus_epi16( vA, vB ); }
+
+#if defined ( VN_RESIZE_USE_AVX2 )
+
+template <> struct CVResizeVector< VN_CPU_LEVEL_AVX2 > { typedef __m256i TYPE; };
+
+template <> inline __m256i vnResizeZero< VN_CPU_LEVEL_AVX2 >() { return _mm256_setzero_si256(); }
+template <> inline __m256i vnResizeSplat< VN_CPU_LEVEL_AVX2 >( INT32 iValue ) { return _mm256_set1_epi32( iValue ); }
+template <> inline __m256i vnResizeLoad< VN_CPU_LEVEL_AVX2 >( CONST UINT8 * pSrc ) { return _mm256_loadu_si256( (CONST __m256i *) pSrc ); }
+
+inline VOID vnResizeStore( UINT8 * pDest, CONST __m256i & vA ) { _mm256_storeu_si256( (__m256i *) pDest, vA ); }
+inline __m256i vnResizeUnpackLow8( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_unpacklo_epi8( vA, vB ); }
+inline __m256i vnResizeUnpackHigh8( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_unpackhi_epi8( vA, vB ); }
+inline __m256i vnResizeUnpackLow16( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_unpacklo_epi16( vA, vB ); }
+inline __m256i vnResizeUnpackHigh16( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_unpackhi_epi16( vA, vB ); }
+inline __m256i vnResizeMultiplyAdd( CONST __m256i & vSum, CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_add_epi32( vSum, _mm256_madd_epi16( vA, vB ) ); }
+inline __m256i vnResizeShift( CONST __m256i & vA ) { return _mm256_srai_epi32( vA, VN_RESIZE_FIXED_POINT_SHIFT ); }
+inline __m256i vnResizePack32( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_packs_epi32( vA, vB ); }
+inline __m256i vnResizePack16( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_packus_epi16( vA, vB ); }
+
+#endif
+
+//
+// vnResizeFixedBlockVertical
+//
+//   Filters one vector of adjacent samples of uiTapCount consecutive rows (beginning at pSrc) 
+//   into pDest. All sums remain within registers until the final samples are stored.
+//
+
+template < UINT32 LEVEL >
+VOID vnResizeFixedBlockVertical( CONST UINT8 * pSrc, UINT32 uiSrcPitch, CONST INT16 * piWeight, UINT32 uiTapCount, UINT8 * pDest )
+{
+    typedef typename CVResizeVector< LEVEL >::TYPE VN_RESIZE_VECTOR;
+
+    VN_RESIZE_VECTOR vZero   = vnResizeZero< LEVEL >();
+    VN_RESIZE_VECTOR vSum[4] = { vnResizeSplat< LEVEL >( VN_RESIZE_FIXED_POINT_HALF ), vnResizeSplat< LEVEL >( VN_RESIZE_FIXED_POINT_HALF ), 
+                                 vnResizeSplat< LEVEL >( VN_RESIZE_FIXED_POINT_HALF ), vnResizeSplat< LEVEL >( VN_RESIZE_FIXED_POINT_HALF ) };
+
+    for ( UINT32 k = 0; k < uiTapCount; k += 2 )
+    {
+        //
+        // Rows are paired for our multiply-add. An odd final row is paired with a zero row.
+        //
+
+        BOOL bPair              = ( k + 1 < uiTapCount );
+        VN_RESIZE_VECTOR vRowA  = vnResizeLoad< LEVEL >( pSrc + k * uiSrcPitch );
+        VN_RESIZE_VECTOR vRowB  = ( bPair ? vnResizeLoad< LEVEL >( pSrc + ( k + 1 ) * uiSrcPitch ) : vZero );
+        UINT16 uiWeightB        = ( bPair ? piWeight[ k + 1 ] : 0 );
+        VN_RESIZE_VECTOR vWeight = vnResizeSplat< LEVEL >( ( (UINT32) uiWeightB << 16 ) | (UINT16) piWeight[ k ] );
+
+        VN_RESIZE_VECTOR vLowA  = vnResizeUnpackLow8( vRowA, vZero );
+        VN_RESIZE_VECTOR vLowB  = vnResizeUnpackLow8( vRowB, vZero );
+        VN_RESIZE_VECTOR vHighA = vnResizeUnpackHigh8( vRowA, vZero );
+        VN_RESIZE_VECTOR vHighB = vnResizeUnpackHigh8( vRowB, vZero );
+
+        vSum[0] = vnResizeMultiplyAdd( vSum[0], vnResizeUnpackLow16( vLowA, vLowB ), vWeight );
+        vSum[1] = vnResizeMultiplyAdd( vSum[1], vnResizeUnpackHigh16( vLowA, vLowB ), vWeight );
+        vSum[2] = vnResizeMultiplyAdd( vSum[2], vnResizeUnpackLow16( vHighA, vHighB ), vWeight );
+        vSum[3] = vnResizeMultiplyAdd( vSum[3], vnResizeUnpackHigh16( vHighA, vHighB ), vWeight );
+    }
+
+    VN_RESIZE_VECTOR vLow  = vnResizePack32( vnResizeShift( vSum[0] ), vnResizeShift( vSum[1] ) );
+    VN_RESIZE_VECTOR vHigh = vnResizePack32( vnResizeShift( vSum[2] ), vnResizeShift( vSum[3] ) );
+
+    vnResizeStore( pDest, vnResizePack16( vLow, vHigh ) );
+}
+
+//
+// vnResizeFixedDotProduct
+//
+//   Returns the weighted sum of uiTapCount consecutive samples, eight taps at a time. 
+//
+
+INT32 vnResizeFixedDotProduct( CONST UINT8 * pSrc, CONST INT16 * piWeight, UINT32 uiTapCount )
+{
+    __m128i vZero  = _mm_setzero_si128();
+    __m128i vSum   = _mm_setzero_si128();
+    UINT32 k       = 0;
+
+    for ( ; k + 8 <= uiTapCount; k += 8 )
+    {
+        __m128i vSamples = _mm_unpacklo_epi8( _mm_loadl_epi64( (CONST __m128i *) ( pSrc + k ) ), vZero );
+
+        vSum = _mm_add_epi32( vSum, _mm_madd_epi16( vSamples, _mm_loadu_si128( (CONST __m128i *) ( piWeight + k ) ) ) );
+    }
+
+    vSum = _mm_add_epi32( vSum, _mm_shuffle_epi32( vSum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    vSum = _mm_add_epi32( vSum, _mm_shuffle_epi32( vSum, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+    INT32 iResult = _mm_cvtsi128_si32( vSum );
+
+    for ( ; k < uiTapCount; k++ )
+    {
+        iResult += piWeight[ k ] * pSrc[ k ];
+    }
+
+    return iResult;
+}
+
+#endif
+
+//
+// vnResizeFixedRowVertical
+//
+//   Filters uiRowSize packed samples of the rows that contribute to output row j into pDestLine.
+//   The first of these rows begins at pFirstLine, and each successive row uiSrcPitch bytes later.
+//
+
+template < UINT32 LEVEL >
+VOID vnResizeFixedRowVertical( CONST UINT8 * pFirstLine, UINT32 uiSrcPitch, CONST CVResizeFixedContributors & pTable, UINT32 j, UINT32 uiRowSize, UINT8 * pDestLine )
+{
+    UINT32 uiTapCount        = pTable.m_uiTapCount;
+    CONST INT16 * piWeight   = pTable.m_piWeight + j * uiTapCount;
+    UINT32 i                 = 0;
+
+#if defined ( VN_RESIZE_USE_AVX2 )
+
+    if ( LEVEL >= VN_CPU_LEVEL_AVX2 )
+    {
+        for ( ; i + 32 <= uiRowSize; i += 32 )
+        {
+            vnResizeFixedBlockVertical< VN_CPU_LEVEL_AVX2 >( pFirstLine + i, uiSrcPitch, piWeight, uiTapCount, pDestLine + i );
+        }
+    }
+
+#endif
+
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+    if ( LEVEL >= VN_CPU_LEVEL_SSE2 )
+    {
+        for ( ; i + 16 <= uiRowSize; i += 16 )
+        {
+            vnResizeFixedBlockVertical< VN_CPU_LEVEL_SSE2 >( pFirstLine + i, uiSrcPitch, piWeight, uiTapCount, pDestLine + i );
+        }
+    }
+
+#endif
+
+    for ( ; i < uiRowSize; i++ )
+    {
+        INT32 iResult = VN_RESIZE_FIXED_POINT_HALF;
+
+        for ( UINT32 k = 0; k < uiTapCount; k++ )
+        {
+            iResult += piWeight[ k ] * pFirstLine[ k * uiSrcPitch + i ];
+        }
+
+        pDestLine[ i ] = iResult >> VN_RESIZE_FIXED_POINT_SHIFT;
+    }
+}
+
+//
+// vnResizeFixedRowHorizontal
+//
+//   Filters a single row of packed samples into uiDestWidth samples, which are written 
+//   uiDestStride bytes apart.
+//
+
+template < UINT32 LEVEL >
+VOID vnResizeFixedRowHorizontal( CONST UINT8 * pSrcLine, CONST CVResizeFixedContributors & pTable, UINT32 uiDestWidth, UINT8 * pDestLine, UINT32 uiDestStride )
+{
+    UINT32 uiTapCount      = pTable.m_uiTapCount;
+    CONST INT16 * piWeight = pTable.m_piWeight;
+
+    for ( UINT32 i = 0; i < uiDestWidth; i++, piWeight += uiTapCount )
+    {
+        CONST UINT8 * pFirst = pSrcLine + pTable.m_piFirst[ i ];
+        INT32 iResult        = VN_RESIZE_FIXED_POINT_HALF;
+
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+        if ( LEVEL >= VN_CPU_LEVEL_SSE2 )
+        {
+            iResult += vnResizeFixedDotProduct( pFirst, piWeight, uiTapCount );
+        }
+        else
+
+#endif
+        {
+            for ( UINT32 k = 0; k < uiTapCount; k++ )
+            {
+                iResult += piWeight[ k ] * pFirst[ k ];
+            }
+        }
+
+        pDestLine[ i * uiDestStride ] = iResult >> VN_RESIZE_FIXED_POINT_SHIFT;
+    }
+}
+
+//
+// vnGatherResizeChannel
+//
+//   Copies the first channel of uiWidth pixels (each uiPixelSize bytes) into uiWidth packed 
+//   samples. Vector kernels gather 16 pixels at a time, masking and packing 4 byte pixels (SSE2)
+//   or shuffling three loads of 3 byte pixels (SSSE3).
+//
+
+template < UINT32 LEVEL >
+VOID vnGatherResizeChannel( CONST UINT8 * pSrcLine, UINT32 uiPixelSize, UINT32 uiWidth, UINT8 * pDestLine )
+{
+    UINT32 i = 0;
+
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+    if ( LEVEL >= VN_CPU_LEVEL_SSE2 && 4 == uiPixelSize )
+    {
+        __m128i vMask = _mm_set1_epi32( 0xFF );
+
+        for ( ; i + 16 <= uiWidth; i += 16 )
+        {
+            CONST __m128i * pSrc = (CONST __m128i *) ( pSrcLine + i * 4 );
+            __m128i vLow         = _mm_packs_epi32( _mm_and_si128( _mm_loadu_si128( pSrc + 0 ), vMask ), _mm_and_si128( _mm_loadu_si128( pSrc + 1 ), vMask ) );
+            __m128i vHigh        = _mm_packs_epi32( _mm_and_si128( _mm_loadu_si128( pSrc + 2 ), vMask ), _mm_and_si128( _mm_loadu_si128( pSrc + 3 ), vMask ) );
+
+            _mm_storeu_si128( (__m128i *) ( pDestLine + i ), _mm_packus_epi16( vLow, vHigh ) );
+        }
+    }
+
+#endif
+
+#if defined ( VN_RESIZE_USE_SSSE3 )
+
+    if ( LEVEL >= VN_CPU_LEVEL_SSSE3 && 3 == uiPixelSize )
+    {
+        __m128i vShuffleA = _mm_setr_epi8( 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 );
+        __m128i vShuffleB = _mm_setr_epi8( -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1 );
+        __m128i vShuffleC = _mm_setr_epi8( -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13 );
+
+        for ( ; i + 16 <= uiWidth; i += 16 )
+        {
+            CONST __m128i * pSrc = (CONST __m128i *) ( pSrcLine + i * 3 );
+            __m128i vA           = _mm_shuffle_epi8( _mm_loadu_si128( pSrc + 0 ), vShuffleA );
+            __m128i vB           = _mm_shuffle_epi8( _mm_loadu_si128( pSrc + 1 ), vShuffleB );
+            __m128i vC           = _mm_shuffle_epi8( _mm_loadu_si128( pSrc + 2 ), vShuffleC );
+
+            _mm_storeu_si128( (__m128i *) ( pDestLine + i ), _mm_or_si128( _mm_or_si128( vA, vB ), vC ) );
+        }
+    }
+
+#endif
+
+    for ( ; i < uiWidth; i++ )
+    {
+        pDestLine[ i ] = pSrcLine[ i * uiPixelSize ];
+    }
+}
+
+//
+// vnBindResizeFixedKernels
+//
+//   Returns the row kernels of our fixed point filter that best suit the host processor. 
+//   Kernels are bound once, when the module is loaded.
+//
+
+struct CVResizeFixedKernels
+{
+    VOID ( *m_pfnRowVertical )( CONST UINT8 * pFirstLine, UINT32 uiSrcPitch, CONST CVResizeFixedContributors & pTable, UINT32 j, UINT32 uiRowSize, UINT8 * pDestLine );
+    VOID ( *m_pfnRowHorizontal )( CONST UINT8 * pSrcLine, CONST CVResizeFixedContributors & pTable, UINT32 uiDestWidth, UINT8 * pDestLine, UINT32 uiDestStride );
+    VOID ( *m_pfnGatherChannel )( CONST UINT8 * pSrcLine, UINT32 uiPixelSize, UINT32 uiWidth, UINT8 * pDestLine );
+};
+
+CVResizeFixedKernels vnBindResizeFixedKernels()
+{
+    UINT32 uiLevel                  = vnQueryCpuLevel();
+    CVResizeFixedKernels pKernels   = { vnResizeFixedRowVertical< VN_CPU_LEVEL_SCALAR >, vnResizeFixedRowHorizontal< VN_CPU_LEVEL_SCALAR >, vnGatherResizeChannel< VN_CPU_LEVEL_SCALAR > };
+
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+    if ( uiLevel >= VN_CPU_LEVEL_SSE2 )
+    {
+        pKernels.m_pfnRowVertical   = vnResizeFixedRowVertical< VN_CPU_LEVEL_SSE2 >;
+        pKernels.m_pfnRowHorizontal = vnResizeFixedRowHorizontal< VN_CPU_LEVEL_SSE2 >;
+        pKernels.m_pfnGatherChannel = vnGatherResizeChannel< VN_CPU_LEVEL_SSE2 >;
+    }
+
+#endif
+
+#if defined ( VN_RESIZE_USE_SSSE3 )
+
+    if ( uiLevel >= VN_CPU_LEVEL_SSSE3 )
+    {
+        pKernels.m_pfnGatherChannel = vnGatherResizeChannel< VN_CPU_LEVEL_SSSE3 >;
+    }
+
+#endif
+
+#if defined ( VN_RESIZE_USE_AVX2 )
+
+    if ( uiLevel >= VN_CPU_LEVEL_AVX2 )
+    {
+        pKernels.m_pfnRowVertical   = vnResizeFixedRowVertical< VN_CPU_LEVEL_AVX2 >;
+    }
+
+#endif
+
+    return pKernels;
+}
+
+static CVResizeFixedKernels g_pResizeFixedKernels = vnBindResizeFixedKernels();
+
+VN_STATUS vnResizeImageFixedPoint( CONST CVImage & pSrcImage, FLOAT32 fHRatio, FLOAT32 fVRatio, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
+    //
+    // We filter vertically first, so that the bulk of our work (which scales with the source) 
+    // streams through entire source rows, many samples at a time. The horizontal pass then only
+    // visits uiDestHeight intermediate rows.
+    //
+    // Only the first channel of a source contributes to our result. Multi-channel sources are
+    // gathered, one row at a time, into a ring of packed rows that spans the taps of an output.
+    // Each ring row is stored twice (at slots r and r + ring size), so that the taps of any 
+    // output occupy consecutive slots. Rows are gathered once, since the taps of later outputs
+    // never begin before those of earlier outputs.
+    //
+    // Our scratch memory holds both contributor tables, an intermediate block of 
+    // ( dest height x source width ) vertically filtered samples, and the ring (if any). Sizes
+    // are computed in 64 bits, as extreme dimensions would otherwise wrap.
+    //
+
+    UINT32 uiSrcWidth       = pSrcImage.QueryWidth();
+    UINT32 uiSrcHeight      = pSrcImage.QueryHeight();
+    UINT32 uiDestWidth      = pDestImage->QueryWidth();
+    UINT32 uiDestHeight     = pDestImage->QueryHeight();
+    UINT32 uiSrcPixelSize   = pSrcImage.QueryBitsPerPixel() >> 3;
+    UINT32 uiDestPixelSize  = pDestImage->QueryBitsPerPixel() >> 3;
+    UINT32 uiHorizTapCount  = vnQueryFixedContributorTapCount( uiSrcWidth, fHRatio );
+    UINT32 uiVertTapCount   = vnQueryFixedContributorTapCount( uiSrcHeight, fVRatio );
+    UINT32 uiRingSize       = ( 1 == uiSrcPixelSize ? 0 : uiVertTapCount );
+    UINT64 uiTableSize      = ( (UINT64) uiDestWidth + uiDestHeight ) * sizeof( INT32 ) + ( (UINT64) uiDestWidth * uiHorizTapCount + (UINT64) uiDestHeight * uiVertTapCount ) * sizeof( INT16 );
+    UINT64 uiScratchSize    = uiTableSize + ( (UINT64) uiDestHeight + 2 * uiRingSize ) * uiSrcWidth;
+    UINT8 * pOwnedScratch   = NULL;
+    UINT8 * pScratch        = vnAcquireResizeScratch( uiScratchSize, pWorkspace, &pOwnedScratch );
+
+    if ( !pScratch )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    CVResizeFixedContributors pHorizTable, pVertTable;
+
+    pHorizTable.m_piFirst   = reinterpret_cast<INT32 *>( pScratch );
+    pVertTable.m_piFirst    = pHorizTable.m_piFirst + uiDestWidth;
+    pHorizTable.m_piWeight  = reinterpret_cast<INT16 *>( pVertTable.m_piFirst + uiDestHeight );
+    pVertTable.m_piWeight   = pHorizTable.m_piWeight + uiDestWidth * uiHorizTapCount;
+
+    UINT8 * pTempBlock      = pScratch + uiTableSize;
+    UINT8 * pRing           = pTempBlock + uiDestHeight * uiSrcWidth;
+    UINT32 uiRingEnd        = 0;
+
+    vnBuildFixedContributors( uiSrcWidth, uiDestWidth, fHRatio, &pHorizTable );
+    vnBuildFixedContributors( uiSrcHeight, uiDestHeight, fVRatio, &pVertTable );
+
+    //
+    // Perform the vertical filter sampling.
+    //
+
+    for ( UINT32 j = 0; j < uiDestHeight; j++ )
+    {
+        UINT32 uiFirst = pVertTable.m_piFirst[ j ];
+
+        if ( 0 == uiRingSize )
+        {
+            g_pResizeFixedKernels.m_pfnRowVertical( pSrcImage.QueryData() + (UINT64) uiFirst * pSrcImage.RowPitch(), pSrcImage.RowPitch(), pVertTable, j, uiSrcWidth, pTempBlock + j * uiSrcWidth );
+
+            continue;
+        }
+
+        //
+        // The ring holds the uiRingSize rows that precede uiRingEnd. If our taps are not a 
+        // continuation of them, we refill the ring from our first tap.
+        //
+
+        if ( uiFirst >= uiRingEnd || uiFirst + uiRingSize < uiRingEnd )
+        {
+            uiRingEnd = uiFirst;
+        }
+
+        for ( ; uiRingEnd < uiFirst + uiRingSize; uiRingEnd++ )
+        {
+            UINT8 * pSlot = pRing + ( uiRingEnd % uiRingSize ) * uiSrcWidth;
+
+            g_pResizeFixedKernels.m_pfnGatherChannel( pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, uiRingEnd ), uiSrcPixelSize, uiSrcWidth, pSlot );
+            vnCopyMemory( pSlot + uiRingSize * uiSrcWidth, pSlot, uiSrcWidth );
+        }
+
+        g_pResizeFixedKernels.m_pfnRowVertical( pRing + ( uiFirst % uiRingSize ) * uiSrcWidth, uiSrcWidth, pVertTable, j, uiSrcWidth, pTempBlock + j * uiSrcWidth );
+    }
+
+    //
+    // Perform the horizontal filter sampling.
+    //
+
+    for ( UINT32 j = 0; j < uiDestHeight; j++ )
+    {
+        g_pResizeFixedKernels.m_pfnRowHorizontal( pTempBlock + j * uiSrcWidth, pHorizTable, uiDestWidth, pDestImage->QueryData() + pDestImage->BlockOffset( 0, j ), uiDestPixelSize );
+    }
+
+    delete [] pOwnedScratch;
+
+    return VN_SUCCESS;
+}
+
+//
+// Area Contributor Tables
+//
+//   The area filter averages the box of source samples that each output covers. We measure both
+//   axes in units of 1 / ( source length x dest length ) so that every boundary lies on an integer,
+//   i.e. each source sample spans m_uiSampleWeight units and each output spans m_uiOutputWeight.
+//   An output thus covers a partial first sample, a run of whole samples, and a partial last 
+//   sample, and its box sum is exact. The cost of an output is a single (vectorized) sum of its
+//   run, regardless of how many samples the run holds.
+//
+
+class VN_NONVIRTUAL CVResizeAreaContributors
 {
-    if ( VN_PARAM_CHECK )
+public:
+
+    UINT32                      m_uiSampleWeight;   // units spanned by each source sample
+    UINT32                      m_uiOutputWeight;   // units spanned by each output sample
+    UINT32 *                    m_puiFirst;         // index of the first source sample of each output
+    UINT32 *                    m_puiLast;          // index of the last source sample of each output
+    UINT32 *                    m_puiFirstWeight;   // units of the first sample covered by each output
+    UINT32 *                    m_puiLastWeight;    // units of the last sample covered by each output
+
+public:
+
+    CVResizeAreaContributors() : m_uiSampleWeight( 0 ), m_uiOutputWeight( 0 ), m_puiFirst( 0 ), m_puiLast( 0 ),
+                                 m_puiFirstWeight( 0 ), m_puiLastWeight( 0 ) {}
+};
+
+//
+// vnBuildAreaContributors
+//
+//   Fills pTable for uiDestLength outputs that evenly partition uiSrcLength inputs. The table 
+//   storage must already be attached.
+//
+
+VOID vnBuildAreaContributors( UINT32 uiSrcLength, UINT32 uiDestLength, INOUT CVResizeAreaContributors * pTable )
+{
+    pTable->m_uiSampleWeight = uiDestLength;
+    pTable->m_uiOutputWeight = uiSrcLength;
+
+    for ( UINT32 i = 0; i < uiDestLength; i++ )
     {
-        if ( 0 == fRadius || !VN_IS_IMAGE_VALID( pSrcImage ) )
+        UINT64 uiStart = (UINT64) i * uiSrcLength;
+        UINT64 uiEnd   = uiStart + uiSrcLength;
+        UINT32 uiFirst = uiStart / uiDestLength;
+        UINT32 uiLast  = ( uiEnd - 1 ) / uiDestLength;
+
+        pTable->m_puiFirst[ i ] = uiFirst;
+        pTable->m_puiLast[ i ]  = uiLast;
+
+        if ( uiFirst == uiLast )
         {
-            return vnPostError( VN_ERROR_INVALIDARG );
+            //
+            // The output lies entirely within a single source sample (e.g. when magnifying).
+            //
+
+            pTable->m_puiFirstWeight[ i ] = uiSrcLength;
+            pTable->m_puiLastWeight[ i ]  = 0;
+
+            continue;
         }
+
+        pTable->m_puiFirstWeight[ i ] = (UINT64) ( uiFirst + 1 ) * uiDestLength - uiStart;
+        pTable->m_puiLastWeight[ i ]  = uiEnd - (UINT64) uiLast * uiDestLength;
     }
+}
 
-    FLOAT32 fSampleCount = 0;
-    FLOAT32 fMaxDistance = fRadius;    
-    INT32 iRadius        = fRadius + 1.0f;
-    INT32 iResult        = 0;
+//
+// vnResizeAreaSumSamples
+//
+//   Returns the sum of uiCount samples that are uiStride bytes apart.
+//
 
-    //
-    // Scan the kernel space adding up the pixel values
-    //
+template < UINT32 LEVEL >
+UINT32 vnResizeAreaSumSamples( CONST UINT8 * pSrc, UINT32 uiCount, UINT32 uiStride )
+{
+    UINT32 uiResult = 0;
+    UINT32 k        = 0;
 
-    for ( INT32 j = -iRadius + 1; j <= iRadius; j++ )
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+    if ( LEVEL >= VN_CPU_LEVEL_SSE2 && 1 == uiStride )
     {
-        INT32 iX = fX;
-        INT32 iY = fY + j;
+        __m128i vZero = _mm_setzero_si128();
+        __m128i vSum  = _mm_setzero_si128();
 
-        if ( iX < 0 || iY < 0 || iX > pSrcImage.QueryWidth() - 1 || iY > pSrcImage.QueryHeight() - 1 )
+        for ( ; k + 16 <= uiCount; k += 16 )
         {
-             continue;
+            vSum = _mm_add_epi64( vSum, _mm_sad_epu8( _mm_loadu_si128( (CONST __m128i *) ( pSrc + k ) ), vZero ) );
         }
 
-        UINT8 * pSrcPixel   = pSrcImage.QueryData() + pSrcImage.BlockOffset( iX, iY );
-
-        FLOAT32 fYDelta     = fY - iY;
-        FLOAT32 fDistance   = fabs( fYDelta );
-        FLOAT32 fWeight     = 0.0f;
+        uiResult = _mm_cvtsi128_si32( vSum ) + _mm_cvtsi128_si32( _mm_srli_si128( vSum, 8 ) );
+    }
 
-        //
-        // Since we're minifying, we can compute a simple distance based weighted average 
-        // using our calculated radius (fRadius)
-        //
+#endif
 
-        fDistance     = VN_MIN2( fMaxDistance, fDistance );
-        fWeight       = 1.0f - fDistance / fMaxDistance;
-        iResult      += fWeight * pSrcPixel[0];
-        fSampleCount += fWeight;
+    for ( ; k < uiCount; k++ )
+    {
+        uiResult += pSrc[ k * uiStride ];
     }
 
-    //
-    // Normalize our sum back to the valid pixel range
-    //
-
-    return ( iResult / fSampleCount );
+    return uiResult;
 }
 
-UINT8 vnCoverageSampleHorizontal( CONST CVImage & pSrcImage, FLOAT32 fX, FLOAT32 fY, FLOAT32 fRadius )
+//
+// vnResizeAreaRowHorizontal
+//
+//   Computes the unnormalized box sums of a single row of pixels (each uiSrcPixelSize bytes).
+//   Each sum is at most m_uiOutputWeight * 255.
+//
+
+template < UINT32 LEVEL >
+VOID vnResizeAreaRowHorizontal( CONST UINT8 * pSrcLine, UINT32 uiSrcPixelSize, CONST CVResizeAreaContributors & pTable, UINT32 uiDestWidth, UINT32 * puiDestLine )
 {
-    if ( VN_PARAM_CHECK )
+    for ( UINT32 i = 0; i < uiDestWidth; i++ )
     {
-        if ( 0 == fRadius || !VN_IS_IMAGE_VALID( pSrcImage ) )
+        UINT32 uiFirst  = pTable.m_puiFirst[ i ];
+        UINT32 uiLast   = pTable.m_puiLast[ i ];
+        UINT32 uiResult = pTable.m_puiFirstWeight[ i ] * pSrcLine[ uiFirst * uiSrcPixelSize ] + 
+                          pTable.m_puiLastWeight[ i ] * pSrcLine[ uiLast * uiSrcPixelSize ];
+
+        if ( uiLast > uiFirst + 1 )
         {
-            return vnPostError( VN_ERROR_INVALIDARG );
+            uiResult += pTable.m_uiSampleWeight * vnResizeAreaSumSamples< LEVEL >( pSrcLine + ( uiFirst + 1 ) * uiSrcPixelSize, uiLast - uiFirst - 1, uiSrcPixelSize );
         }
+
+        puiDestLine[ i ] = uiResult;
+    }
+}
+
+//
+// vnBindResizeAreaKernel
+//
+//   Returns the row kernel of our area filter that best suits the host processor. Kernels are
+//   bound once, when the module is loaded.
+//
+
+typedef VOID ( *VN_RESIZE_AREA_KERNEL )( CONST UINT8 * pSrcLine, UINT32 uiSrcPixelSize, CONST CVResizeAreaContributors & pTable, UINT32 uiDestWidth, UINT32 * puiDestLine );
+
+VN_RESIZE_AREA_KERNEL vnBindResizeAreaKernel()
+{
+#if defined ( VN_RESIZE_USE_VECTOR )
+
+    if ( vnQueryCpuLevel() >= VN_CPU_LEVEL_SSE2 )
+    {
+        return vnResizeAreaRowHorizontal< VN_CPU_LEVEL_SSE2 >;
     }
 
-    FLOAT32 fSampleCount = 0;
-    FLOAT32 fMaxDistance = fRadius;    
-    INT32 iRadius        = fRadius + 1.0f;
-    INT32 iResult        = 0;
- 
+#endif
+
+    return vnResizeAreaRowHorizontal< VN_CPU_LEVEL_SCALAR >;
+}
+
+static VN_RESIZE_AREA_KERNEL g_pfnResizeAreaRowHorizontal = vnBindResizeAreaKernel();
+
+VN_STATUS vnResizeImageArea( CONST CVImage & pSrcImage, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
+    //
+    // We visit each source row once, reducing it to uiDestWidth box sums, and accumulate those
+    // sums (weighted by their vertical coverage) into the current output row. A source row that
+    // straddles two output rows is reduced once and shared between them. All arithmetic is exact
+    // until the final division, which rounds to the nearest value.
     //
-    // Scan the kernel space adding up the pixel values
+    // Our scratch memory holds both contributor tables, a row of box sums, and a row of 64 bit
+    // accumulators.
     //
 
-    for ( INT32 i = -iRadius + 1; i <= iRadius; i++ )
+    UINT32 uiSrcWidth       = pSrcImage.QueryWidth();
+    UINT32 uiSrcHeight      = pSrcImage.QueryHeight();
+    UINT32 uiDestWidth      = pDestImage->QueryWidth();
+    UINT32 uiDestHeight     = pDestImage->QueryHeight();
+    UINT32 uiSrcPixelSize   = pSrcImage.QueryBitsPerPixel() >> 3;
+    UINT32 uiDestPixelSize  = pDestImage->QueryBitsPerPixel() >> 3;
+    UINT64 uiScratchSize    = uiDestWidth * sizeof( UINT64 ) + ( ( (UINT64) uiDestWidth + uiDestHeight ) * 4 + uiDestWidth ) * sizeof( UINT32 );
+    UINT64 uiOutputWeight   = (UINT64) uiSrcWidth * uiSrcHeight;
+    UINT8 * pOwnedScratch   = NULL;
+    UINT8 * pScratch        = vnAcquireResizeScratch( uiScratchSize, pWorkspace, &pOwnedScratch );
+
+    if ( !pScratch )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    CVResizeAreaContributors pHorizTable, pVertTable;
+
+    UINT64 * puiAccumulator         = reinterpret_cast<UINT64 *>( pScratch );
+
+    pHorizTable.m_puiFirst          = reinterpret_cast<UINT32 *>( puiAccumulator + uiDestWidth );
+    pHorizTable.m_puiLast           = pHorizTable.m_puiFirst + uiDestWidth;
+    pHorizTable.m_puiFirstWeight    = pHorizTable.m_puiLast + uiDestWidth;
+    pHorizTable.m_puiLastWeight     = pHorizTable.m_puiFirstWeight + uiDestWidth;
+    pVertTable.m_puiFirst           = pHorizTable.m_puiLastWeight + uiDestWidth;
+    pVertTable.m_puiLast            = pVertTable.m_puiFirst + uiDestHeight;
+    pVertTable.m_puiFirstWeight     = pVertTable.m_puiLast + uiDestHeight;
+    pVertTable.m_puiLastWeight      = pVertTable.m_puiFirstWeight + uiDestHeight;
+
+    UINT32 * puiRowSums             = pVertTable.m_puiLastWeight + uiDestHeight;
+    UINT32 uiCachedRow              = uiSrcHeight;
+
+    vnBuildAreaContributors( uiSrcWidth, uiDestWidth, &pHorizTable );
+    vnBuildAreaContributors( uiSrcHeight, uiDestHeight, &pVertTable );
+
+    for ( UINT32 j = 0; j < uiDestHeight; j++ )
     {
-        INT32 iX = fX + i;
-        INT32 iY = fY;
+        UINT32 uiFirst      = pVertTable.m_puiFirst[ j ];
+        UINT32 uiLast       = pVertTable.m_puiLast[ j ];
+        UINT8 * pDestLine   = pDestImage->QueryData() + pDestImage->BlockOffset( 0, j );
+
+        vnZeroMemory( puiAccumulator, uiDestWidth * sizeof( UINT64 ) );
+
+        for ( UINT32 y = uiFirst; y <= uiLast; y++ )
+        {
+            UINT32 uiWeight = ( y == uiFirst ? pVertTable.m_puiFirstWeight[ j ] : 
+                              ( y == uiLast  ? pVertTable.m_puiLastWeight[ j ] : pVertTable.m_uiSampleWeight ) );
+
+            if ( y != uiCachedRow )
+            {
+                g_pfnResizeAreaRowHorizontal( pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, y ), uiSrcPixelSize, pHorizTable, uiDestWidth, puiRowSums );
+
+                uiCachedRow = y;
+            }
 
-        if ( iX < 0 || iY < 0 || iX > pSrcImage.QueryWidth() - 1 || iY > pSrcImage.QueryHeight() - 1 )
+            for ( UINT32 i = 0; i < uiDestWidth; i++ )
+            {
+                puiAccumulator[ i ] += (UINT64) uiWeight * puiRowSums[ i ];
+            }
+        }
+
+        for ( UINT32 i = 0; i < uiDestWidth; i++ )
         {
-             continue;
+            pDestLine[ i * uiDestPixelSize ] = ( puiAccumulator[ i ] + ( uiOutputWeight >> 1 ) ) / uiOutputWeight;
         }
+    }
+
+    delete [] pOwnedScratch;
+
+    return VN_SUCCESS;
+}
+
+//
+// vnHalveRow
+//
+//   Averages each 2x2 block of pixels from a pair of rows into a single sample. Pass the same
+//   row twice to halve only horizontally. A trailing odd pixel is averaged with itself.
+//
 
-        UINT8 * pSrcPixel   = pSrcImage.QueryData() + pSrcImage.BlockOffset( iX, iY );
+template < UINT32 LEVEL >
+VOID vnHalveRow( CONST UINT8 * pSrcLine0, CONST UINT8 * pSrcLine1, UINT32 uiSrcWidth, UINT32 uiSrcPixelSize, UINT8 * pDestLine )
+{
+    UINT32 uiDestWidth = ( uiSrcWidth + 1 ) >> 1;
+    UINT32 i           = 0;
 
-        FLOAT32 fXDelta     = fX - iX;
-        FLOAT32 fDistance   = fabs( fXDelta );
-        FLOAT32 fWeight     = 0.0f;
+#if defined ( VN_RESIZE_USE_VECTOR )
 
+    if ( LEVEL >= VN_CPU_LEVEL_SSE2 && 1 == uiSrcPixelSize )
+    {
         //
-        // Since we're minifying, we can compute a simple distance based weighted average 
-        // using our calculated radius (fRadius)
+        // We sum adjacent byte pairs within 16 bit lanes, add the sums of both rows, and then
+        // round and pack sixteen samples at a time.
         //
 
-        fDistance     = VN_MIN2( fMaxDistance, fDistance );
-        fWeight       = 1.0f - fDistance / fMaxDistance;
-        iResult      += fWeight * pSrcPixel[0];
-        fSampleCount += fWeight;
+        __m128i vMask  = _mm_set1_epi16( 0x00FF );
+        __m128i vRound = _mm_set1_epi16( 2 );
+
+        for ( ; ( i + 16 ) * 2 <= uiSrcWidth; i += 16 )
+        {
+            __m128i vA0 = _mm_loadu_si128( (CONST __m128i *) ( pSrcLine0 + i * 2 ) );
+            __m128i vA1 = _mm_loadu_si128( (CONST __m128i *) ( pSrcLine0 + i * 2 + 16 ) );
+            __m128i vB0 = _mm_loadu_si128( (CONST __m128i *) ( pSrcLine1 + i * 2 ) );
+            __m128i vB1 = _mm_loadu_si128( (CONST __m128i *) ( pSrcLine1 + i * 2 + 16 ) );
+
+            __m128i vSum0 = _mm_add_epi16( _mm_add_epi16( _mm_and_si128( vA0, vMask ), _mm_srli_epi16( vA0, 8 ) ),
+                                           _mm_add_epi16( _mm_and_si128( vB0, vMask ), _mm_srli_epi16( vB0, 8 ) ) );
+            __m128i vSum1 = _mm_add_epi16( _mm_add_epi16( _mm_and_si128( vA1, vMask ), _mm_srli_epi16( vA1, 8 ) ),
+                                           _mm_add_epi16( _mm_and_si128( vB1, vMask ), _mm_srli_epi16( vB1, 8 ) ) );
+
+            vSum0 = _mm_srli_epi16( _mm_add_epi16( vSum0, vRound ), 2 );
+            vSum1 = _mm_srli_epi16( _mm_add_epi16( vSum1, vRound ), 2 );
+
+            _mm_storeu_si128( (__m128i *) ( pDestLine + i ), _mm_packus_epi16( vSum0, vSum1 ) );
+        }
     }
 
-    //
-    // Normalize our sum back to the valid pixel range
-    //
+#endif
+
+    for ( ; i < uiDestWidth; i++ )
+    {
+        UINT32 uiLeft  = ( i * 2 ) * uiSrcPixelSize;
+        UINT32 uiRight = VN_MIN2( i * 2 + 1, uiSrcWidth - 1 ) * uiSrcPixelSize;
 
-    return ( iResult / fSampleCount );
+        pDestLine[ i ] = ( pSrcLine0[ uiLeft ] + pSrcLine0[ uiRight ] + pSrcLine1[ uiLeft ] + pSrcLine1[ uiRight ] + 2 ) >> 2;
+    }
 }
 
-VN_STATUS vnResizeImageSeparable( CONST CVImage & pSrcImage, FLOAT32 fHRatio, FLOAT32 fVRatio, INOUT CVImage * pDestImage )
+//
+// vnAverageRows
+//
+//   Averages a pair of rows into a single row, halving vertically.
+//
+
+template < UINT32 LEVEL >
+VOID vnAverageRows( CONST UINT8 * pSrcLine0, CONST UINT8 * pSrcLine1, UINT32 uiSrcWidth, UINT32 uiSrcPixelSize, UINT8 * pDestLine )
 {
-    //
-    // We rely upon coverage filtering because it allows us to perform very large
-    // resolution changes without suffering from precision, range, and sampling issues.
-    //
+    UINT32 i = 0;
 
-    CVImage * tempImage;
+#if defined ( VN_RESIZE_USE_VECTOR )
 
-    if ( VN_FAILED( vnCreateImage( pSrcImage.QueryFormat(), pDestImage->QueryWidth(), pSrcImage.QueryHeight(), &tempImage ) ) )
+    if ( LEVEL >= VN_CPU_LEVEL_SSE2 && 1 == uiSrcPixelSize )
     {
-        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        for ( ; i + 16 <= uiSrcWidth; i += 16 )
+        {
+            __m128i vA = _mm_loadu_si128( (CONST __m128i *) ( pSrcLine0 + i ) );
+            __m128i vB = _mm_loadu_si128( (CONST __m128i *) ( pSrcLine1 + i ) );
+
+            _mm_storeu_si128( (__m128i *) ( pDestLine + i ), _mm_avg_epu8( vA, vB ) );
+        }
     }
 
-    //
-    // Perform the horizontal filter sampling.
-    //
+#endif
+
+    for ( ; i < uiSrcWidth; i++ )
+    {
+        pDestLine[ i ] = ( pSrcLine0[ i * uiSrcPixelSize ] + pSrcLine1[ i * uiSrcPixelSize ] + 1 ) >> 1;
+    }
+}
+
+//
+// vnBindResizePyramidKernels
+//
+//   Returns the row kernels of our pyramid filter that best suit the host processor. Kernels
+//   are bound once, when the module is loaded.
+//
+
+struct CVResizePyramidKernels
+{
+    VOID ( *m_pfnHalveRow )( CONST UINT8 * pSrcLine0, CONST UINT8 * pSrcLine1, UINT32 uiSrcWidth, UINT32 uiSrcPixelSize, UINT8 * pDestLine );
+    VOID ( *m_pfnAverageRows )( CONST UINT8 * pSrcLine0, CONST UINT8 * pSrcLine1, UINT32 uiSrcWidth, UINT32 uiSrcPixelSize, UINT8 * pDestLine );
+};
+
+CVResizePyramidKernels vnBindResizePyramidKernels()
+{
+    CVResizePyramidKernels pKernels = { vnHalveRow< VN_CPU_LEVEL_SCALAR >, vnAverageRows< VN_CPU_LEVEL_SCALAR > };
+
+#if defined ( VN_RESIZE_USE_VECTOR )
 
-    for ( UINT32 j = 0; j < pSrcImage.QueryHeight(); j++ )
-    for ( UINT32 i = 0; i < pDestImage->QueryWidth(); i++ )
+    if ( vnQueryCpuLevel() >= VN_CPU_LEVEL_SSE2 )
     {
-        UINT8 * pOutputData = tempImage->QueryData() + tempImage->BlockOffset( i, j );
+        pKernels.m_pfnHalveRow      = vnHalveRow< VN_CPU_LEVEL_SSE2 >;
+        pKernels.m_pfnAverageRows   = vnAverageRows< VN_CPU_LEVEL_SSE2 >;
+    }
 
-        //
-        // Determine the sub-pixel location of our *target* (i,j) coordinate, in the space
-        // of our source image.
-        //
+#endif
+
+    return pKernels;
+}
+
+static CVResizePyramidKernels g_pResizePyramidKernels = vnBindResizePyramidKernels();
+
+//
+// vnHalveImage
+//
+//   Halves the first channel of pSrcImage along the selected axes into the R8 image pDestImage, 
+//   which must already be shaped. Odd dimensions round up.
+//
+
+VOID vnHalveImage( CONST CVImage & pSrcImage, BOOL bHorizontal, BOOL bVertical, INOUT CVImage * pDestImage )
+{
+    UINT32 uiSrcWidth       = pSrcImage.QueryWidth();
+    UINT32 uiSrcHeight      = pSrcImage.QueryHeight();
+    UINT32 uiSrcPixelSize   = pSrcImage.QueryBitsPerPixel() >> 3;
 
-        pOutputData[0] = vnCoverageSampleHorizontal( pSrcImage, i * fHRatio, j, fHRatio );
+    for ( UINT32 j = 0; j < pDestImage->QueryHeight(); j++ )
+    {
+        UINT32 uiRow0           = ( bVertical ? j * 2 : j );
+        UINT32 uiRow1           = ( bVertical ? VN_MIN2( j * 2 + 1, uiSrcHeight - 1 ) : j );
+        CONST UINT8 * pSrcLine0 = pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, uiRow0 );
+        CONST UINT8 * pSrcLine1 = pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, uiRow1 );
+        UINT8 * pDestLine       = pDestImage->QueryData() + pDestImage->BlockOffset( 0, j );
+
+        if ( bHorizontal )
+        {
+            g_pResizePyramidKernels.m_pfnHalveRow( pSrcLine0, pSrcLine1, uiSrcWidth, uiSrcPixelSize, pDestLine );
+        }
+        else
+        {
+            g_pResizePyramidKernels.m_pfnAverageRows( pSrcLine0, pSrcLine1, uiSrcWidth, uiSrcPixelSize, pDestLine );
+        }
     }
+}
 
+VN_STATUS vnResizeImagePyramid( CONST CVImage & pSrcImage, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
     //
-    // Perform the vertical filter sampling.
+    // We repeatedly halve the source (along any axis that remains at least twice the size of 
+    // the destination) with simple box averages, and then apply our coverage filter to the final
+    // level. Each level only retains the first channel. Levels alternate between two images, so
+    // every level after the first two reuses the memory of an earlier (larger) level.
     //
 
-    for ( UINT32 j = 0; j < pDestImage->QueryHeight(); j++ )
-    for ( UINT32 i = 0; i < pDestImage->QueryWidth(); i++ )
+    UINT32 uiDestWidth      = pDestImage->QueryWidth();
+    UINT32 uiDestHeight     = pDestImage->QueryHeight();
+    CONST CVImage * pLevel  = &pSrcImage;
+    CVImage * pLevels[2]    = { NULL, NULL };
+    VN_STATUS vnResult      = VN_SUCCESS;
+
+    for ( UINT32 uiLevel = 0; VN_SUCCEEDED( vnResult ); uiLevel++ )
     {
-        UINT8 * pOutputData = pDestImage->QueryData() + pDestImage->BlockOffset( i, j );
+        BOOL bHorizontal = ( pLevel->QueryWidth()  >= uiDestWidth * 2 );
+        BOOL bVertical   = ( pLevel->QueryHeight() >= uiDestHeight * 2 );
 
-        //
-        // Determine the sub-pixel location of our *target* (i,j) coordinate, in the space
-        // of our temp image.
-        //
+        if ( !bHorizontal && !bVertical )
+        {
+            break;
+        }
+
+        UINT32 uiWidth   = ( bHorizontal ? ( pLevel->QueryWidth() + 1 ) >> 1 : pLevel->QueryWidth() );
+        UINT32 uiHeight  = ( bVertical ? ( pLevel->QueryHeight() + 1 ) >> 1 : pLevel->QueryHeight() );
+        CVImage ** ppNext = &pLevels[ uiLevel & 1 ];
+
+        if ( !(*ppNext) )
+        {
+            vnResult = vnCreateImage( VN_IMAGE_FORMAT_R8, uiWidth, uiHeight, ppNext );
+        }
+        else
+        {
+            vnResult = vnReshapeImage( VN_IMAGE_FORMAT_R8, uiWidth, uiHeight, *ppNext );
+        }
+
+        if ( VN_SUCCEEDED( vnResult ) )
+        {
+            vnHalveImage( *pLevel, bHorizontal, bVertical, *ppNext );
 
-        pOutputData[0] = vnCoverageSampleVertical( *tempImage, i, j * fVRatio, fVRatio );
+            pLevel = *ppNext;
+        }
     }
 
-    vnDestroyImage( tempImage );
+    if ( VN_SUCCEEDED( vnResult ) )
+    {
+        vnResult = vnResizeImageSeparable( *pLevel, FALSE, pDestImage, pWorkspace );
+    }
 
-    return VN_SUCCESS;
+    vnDestroyImage( pLevels[0] );
+    vnDestroyImage( pLevels[1] );
+
+    return vnResult;
 }
 
-VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage ** pDestImage )
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, VN_IMAGE_RESIZE_FILTER uiFilter, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
 {
     if ( VN_PARAM_CHECK )
     {
@@ -172,6 +1434,28 @@ VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHei
         {
             return vnPostError( VN_ERROR_INVALIDARG );
         }
+
+        if ( uiFilter > VN_IMAGE_RESIZE_PYRAMID || VN_IS_IMAGE_PLANAR_420( pSrcImage.QueryFormat() ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( &pSrcImage == pDestImage || &pSrcImage == pWorkspace || ( pWorkspace && pWorkspace == pDestImage ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_RESIZE, VN_IMAGE_PIXEL_BYTES( pSrcImage ) + ( ( (UINT64) uiWidth * uiHeight * pSrcImage.QueryBitsPerPixel() ) >> 3 ) );
+
+    //
+    // Shape our destination image.
+    //
+
+    if ( VN_FAILED( vnReshapeImage( pSrcImage.QueryFormat(), uiWidth, uiHeight, pDestImage ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
     //
@@ -180,16 +1464,23 @@ VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHei
 
     if ( uiWidth == pSrcImage.QueryWidth() && uiHeight == pSrcImage.QueryHeight() )
     {
-        return vnCloneImage( pSrcImage, pDestImage );
+        return vnCopyImage( pSrcImage, pDestImage );
     }
 
     //
-    // Create our destination image.
+    // Large reductions are cheaper (and no less accurate) when averaged over exact areas.
     //
 
-    if ( VN_FAILED( vnCreateImage( pSrcImage.QueryFormat(), uiWidth, uiHeight, pDestImage ) ) )
+    if ( VN_IMAGE_RESIZE_AREA == uiFilter || ( VN_IMAGE_RESIZE_DEFAULT == uiFilter && 
+         pSrcImage.QueryWidth()  >= uiWidth  * VN_RESIZE_AREA_MIN_RATIO && 
+         pSrcImage.QueryHeight() >= uiHeight * VN_RESIZE_AREA_MIN_RATIO ) )
     {
-        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        return vnResizeImageArea( pSrcImage, pDestImage, pWorkspace );
+    }
+
+    if ( VN_IMAGE_RESIZE_PYRAMID == uiFilter )
+    {
+        return vnResizeImagePyramid( pSrcImage, pDestImage, pWorkspace );
     }
 
     //
@@ -199,13 +1490,99 @@ VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHei
     // source image that represent a reflection of our destination pixels. 
     //                                           
 
-    FLOAT32 fHorizRatio = ( 1 == uiWidth  ? 1.0f : static_cast<FLOAT32>( pSrcImage.QueryWidth() - 1 )  / ( uiWidth - 1 ) );
-    FLOAT32 fVertRatio  = ( 1 == uiHeight ? 1.0f : static_cast<FLOAT32>( pSrcImage.QueryHeight() - 1 ) / ( uiHeight - 1 ) );
+    FLOAT32 fHorizRatio = vnQueryResizeRatio( pSrcImage.QueryWidth(), uiWidth );
+    FLOAT32 fVertRatio  = vnQueryResizeRatio( pSrcImage.QueryHeight(), uiHeight );
+
+    //
+    // Our resize filters are separable, so we perform them one axis at a time.
+    //
+
+    if ( VN_IMAGE_RESIZE_FIXED_POINT == uiFilter )
+    {
+        return vnResizeImageFixedPoint( pSrcImage, fHorizRatio, fVertRatio, pDestImage, pWorkspace );
+    }
+
+    return vnResizeImageSeparable( pSrcImage, FALSE, pDestImage, pWorkspace );
+}
+
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
+    return vnResizeImage( pSrcImage, uiWidth, uiHeight, VN_IMAGE_RESIZE_DEFAULT, pDestImage, pWorkspace );
+}
+
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, VN_IMAGE_RESIZE_FILTER uiFilter, INOUT CVImage ** pDestImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || 0 == uiWidth || 0 == uiHeight || !pDestImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    //
+    // Create our destination image.
+    //
+
+    if ( VN_FAILED( vnCreateImage( pSrcImage.QueryFormat(), uiWidth, uiHeight, pDestImage ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return vnResizeImage( pSrcImage, uiWidth, uiHeight, uiFilter, *pDestImage, NULL );
+}
+
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage ** pDestImage )
+{
+    return vnResizeImage( pSrcImage, uiWidth, uiHeight, VN_IMAGE_RESIZE_DEFAULT, pDestImage );
+}
+
+VN_STATUS vnDesaturateResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !VN_IS_IMAGE_VALID( pSrcImage ) || 0 == uiWidth || 0 == uiHeight || !pDestImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( &pSrcImage == pDestImage || &pSrcImage == pWorkspace || ( pWorkspace && pWorkspace == pDestImage ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( !VN_IS_IMAGE_LUMA_FORMAT( pSrcImage.QueryFormat() ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_RESIZE, VN_IMAGE_PIXEL_BYTES( pSrcImage ) + (UINT64) uiWidth * uiHeight );
+
+    //
+    // Shape our destination image as a single channel 8 bit format.
+    //
+
+    if ( VN_FAILED( vnReshapeImage( VN_IMAGE_FORMAT_R8, uiWidth, uiHeight, pDestImage ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
 
     //
-    // Our resize filter is separable, so we perform it in the horizontal space first, and 
-    // then in the vertical.
+    // Resampling to the same dimensions is an identity, so we need only desaturate.
     //
 
-    return vnResizeImageSeparable( pSrcImage, fHorizRatio, fVertRatio, *pDestImage );
+    if ( uiWidth == pSrcImage.QueryWidth() && uiHeight == pSrcImage.QueryHeight() )
+    {
+        return vnDesaturateImage( pSrcImage, pDestImage );
+    }
+
+    //
+    // Gray images and Y planes are already luma, so we resample their rows in place.
+    //
+
+    BOOL bDesaturate = !VN_IS_IMAGE_LUMA_PLANE( pSrcImage.QueryFormat() );
+
+    return vnResizeImageSeparable( pSrcImage, bDesaturate, pDestImage, pWorkspace );
 }
@@ -1,144 +1,2372 @@
 
 #include "vnImagine.h"
+#include "../Platform/vnAtomic.h"
 
 //
-// (!) Note: this transform is very slow but flexible. For optimized versions consult the full Imagine Framework (v1.05+)
-// 
+// (!) Note: this transform is flexible but unoptimized. For faster versions consult the full Imagine Framework (v1.05+)
+//
+
+//
+// Plans larger than this are built on demand and released after use, rather than cached. A plan
+// stores uiCount^2 basis values, so caching very long lines would pin a significant amount of memory.
+//
+
+#define VN_TRANSFORM_MAX_CACHED_PLAN_SIZE           (1024)
+
+//
+// Power of two lines at least this long use the fast factorized transform. Shorter lines are
+// cheaper to evaluate directly. Set VN_TRANSFORM_ENABLE_FAST_PATH to zero to force the direct form.
+//
+
+#define VN_TRANSFORM_ENABLE_FAST_PATH               (1)
+#define VN_TRANSFORM_MIN_FAST_SIZE                  (8)
+
+//
+// The edge length of the square tiles used when transposing intermediate coefficients. Two tiles
+// of this size (source and destination) should comfortably fit within the L1 cache.
+//
+
+#define VN_TRANSFORM_TRANSPOSE_TILE_SIZE            (32)
+
+//
+// Vector kernels evaluate the direct form eight coefficients (or eight columns) at a time, which
+// outpaces the fast factorization on short lines. Hosts that run our vector kernels (SSE2 or AVX2,
+// whichever is wider) therefore only use the butterfly form of fast plans above 
+// VN_TRANSFORM_MAX_VECTOR_DIRECT_SIZE. Set VN_TRANSFORM_ENABLE_VECTOR to zero to force the scalar 
+// reference kernels.
+//
+
+#define VN_TRANSFORM_ENABLE_VECTOR                  (1)
+#define VN_TRANSFORM_MAX_VECTOR_DIRECT_SIZE         (64)
+#define VN_TRANSFORM_VECTOR_WIDTH                   (8)
+
+//
+// Fixed point column groups whose coefficients fit within 16 bits are interleaved into pairs of
+// rows on the stack, so that they may use the paired basis. Longer columns use 32 bit multiplies.
+//
+
+#define VN_TRANSFORM_MAX_PAIRED_COLUMN_SIZE         (256)
+
+//
+// Batched transforms are evaluated as matrix products. Each product is tiled along its inner 
+// dimension so that a panel of the basis stays resident in the L1 cache, and we stack at most
+// VN_TRANSFORM_BATCH_CHUNK_SIZE bytes of source lines at a time so that the intermediate 
+// coefficients of a chunk remain resident in the L2 cache.
+//
+
+#define VN_TRANSFORM_MATRIX_DEPTH_TILE              (128)
+#define VN_TRANSFORM_BATCH_CHUNK_SIZE               (256 * 1024)
+
+#if VN_TRANSFORM_ENABLE_VECTOR && ( defined ( VN_SIMD_AVX2 ) || defined ( VN_SIMD_DISPATCH ) )
+    #define VN_TRANSFORM_USE_AVX2
+    #define VN_TRANSFORM_USE_VECTOR
+    #include <immintrin.h>
+#elif VN_TRANSFORM_ENABLE_VECTOR && defined ( VN_SIMD_SSE2 )
+    #define VN_TRANSFORM_USE_VECTOR
+    #include <emmintrin.h>
+#endif
+
+//
+// Our matrix kernels hold a block of this many rows and columns of the product in registers. 
+// Vector kernels hold a full vector of columns.
+//
+
+#define VN_TRANSFORM_MATRIX_ROW_BLOCK               (4)
+#define VN_TRANSFORM_MATRIX_COLUMN_BLOCK( x )       ( VN_CPU_LEVEL_SCALAR == (x) ? 4 : VN_TRANSFORM_VECTOR_WIDTH )
+
+//
+// Fixed point plans store their (scaled) basis with this many fractional bits. Lines whose 
+// products are guaranteed to fit within 32 bits are accumulated in 32 bits, and all others in
+// 64 bits. Either way the sums are exact, so the choice never affects the result.
+//
+
+#define VN_TRANSFORM_FIXED_POINT_SHIFT              (VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT)
+
+//
+// Transform Plan
+//
+//   A plan holds the scaled DCT-II basis for a single line length, so that our line transforms
+//   reduce to a series of multiply-accumulates. Power of two lengths also carry the butterfly
+//   factors for a Lee factorization, which needs O(N log N) operations per line. The basis is
+//   still kept for these lengths (when cached) so that pruned transforms can evaluate a handful 
+//   of coefficients directly. Fixed point plans instead hold an integer basis that is generated 
+//   without relying upon the platform math library. Vector builds also keep a transposed copy of
+//   each basis, so that a group of adjacent coefficients can be accumulated with a single vector 
+//   per input sample. Fixed point bases whose values all fit within 16 bits are also kept in 
+//   pairs of input samples, which lets 8 bit lines accumulate two samples per multiply. Plans are
+//   immutable once built and may be shared freely between threads.
+//
 
-VN_STATUS vnTransformLine( IN UINT8 * pInput, UINT32 uiSrcStride, UINT32 uiCount, INT32 * pOutput, UINT32 uiDestStride )
+class VN_NONVIRTUAL CVTransformPlan
 {
-    if ( VN_PARAM_CHECK )
-	{
-		if ( !pInput || 0 == uiSrcStride || !pOutput || 0 == uiDestStride )
-		{
-			return vnPostError( VN_ERROR_INVALIDARG );
-		}
-	}
+public:
 
-    for ( UINT8 i = 0; i < uiCount; i++ )
-	{
-		INT32 iiTotal	    = 0;             
-		INT32 * pOutputCell = pOutput + i * uiDestStride;
+    UINT32                      m_uiCount;
+    FLOAT32 *                   m_pfBasis;          // m_uiCount rows of m_uiCount values, one row per coefficient (optional for fast plans)
+    FLOAT32 *                   m_pfScale;          // normalization factor of each coefficient
+    FLOAT32 *                   m_pfFastFactors;    // butterfly factors of each stage, largest first (fast form only)
+    INT32 *                     m_piFixedBasis;     // m_uiCount rows of m_uiCount fixed point values (fixed point plans only)
+    UINT64                      m_uiFixedBasisNorm; // the largest sum of absolute values of any fixed point basis row
+    FLOAT64                     m_fBasisNorm;       // the largest sum of absolute values of any basis row (zero if the plan has no basis)
+    FLOAT32 *                   m_pfBasisColumns;   // m_pfBasis stored one row per input sample (vector builds only)
+    INT32 *                     m_piFixedBasisColumns; // m_piFixedBasis stored one row per input sample (vector builds only)
+    INT16 *                     m_psFixedBasisPairs;   // m_piFixedBasis stored one row per pair of input samples (vector builds only, optional)
 
-		for ( UINT8 k = 0; k < uiCount; k++ )
-		{
-			UINT8 * pInputCell = pInput + k * uiSrcStride;
+public:
 
-            iiTotal += (*pInputCell) * cos( ( ( 2 * k + 1 ) * i * VN_PI ) / ( 2 * uiCount ) );
-		}
+    CVTransformPlan() : m_uiCount( 0 ), m_pfBasis( 0 ), m_pfScale( 0 ), m_pfFastFactors( 0 ), m_piFixedBasis( 0 ), m_uiFixedBasisNorm( 0 ), m_fBasisNorm( 0 ), m_pfBasisColumns( 0 ), m_piFixedBasisColumns( 0 ), m_psFixedBasisPairs( 0 ) {}
+    ~CVTransformPlan() { delete [] m_pfBasis; delete [] m_pfScale; delete [] m_pfFastFactors; delete [] m_piFixedBasis; delete [] m_pfBasisColumns; delete [] m_piFixedBasisColumns; delete [] m_psFixedBasisPairs; }
 
-		if ( 0 == i ) iiTotal = iiTotal * vnSqrt( 1.0f / uiCount );
-		else		  iiTotal = iiTotal * vnSqrt( 2.0f / uiCount ); 
+    BOOL                        IsFast() CONST { return ( 0 != m_pfFastFactors ); }
+    BOOL                        IsFixedPoint() CONST { return ( 0 != m_piFixedBasis ); }
+    BOOL                        HasBasis() CONST { return ( 0 != m_pfBasis ); }
+    CONST FLOAT32 *             QueryBasis( UINT32 i ) CONST { return m_pfBasis + i * m_uiCount; }
+    CONST INT32 *               QueryFixedBasis( UINT32 i ) CONST { return m_piFixedBasis + i * m_uiCount; }
+    CONST FLOAT32 *             QueryBasisColumn( UINT32 k ) CONST { return m_pfBasisColumns + k * m_uiCount; }
+    CONST INT32 *               QueryFixedBasisColumn( UINT32 k ) CONST { return m_piFixedBasisColumns + k * m_uiCount; }
+    CONST INT16 *               QueryFixedBasisPair( UINT32 p ) CONST { return m_psFixedBasisPairs + p * ( m_uiCount << 1 ); }
+};
 
-		(*pOutputCell) = iiTotal;
-	}
+//
+// We maintain separate caches for floating point (0) and fixed point (1) plans.
+//
 
-	return VN_SUCCESS;
+static CVTransformPlan * volatile g_pTransformPlanCache[ 2 ][ VN_TRANSFORM_MAX_CACHED_PLAN_SIZE + 1 ] = { { 0 } };
+
+//
+// vnFixedPointCosine
+//
+//   Returns cos( uiPhase * pi / ( 2 * uiCount ) ). We reduce the angle to the first octant using 
+//   exact integer arithmetic, and then evaluate a fixed length Taylor series using only basic 
+//   IEEE operations (which are correctly rounded). Unlike the platform cos(), the result is 
+//   therefore identical on every conforming host.
+//
+//   (!) Note: this assumes strict floating point semantics (e.g. /fp:precise). Any residual
+//             difference under relaxed models is far below the precision of our fixed point
+//             basis, but it is no longer guaranteed to be.
+//
+
+FLOAT64 vnFixedPointCosine( UINT32 uiPhase, UINT32 uiCount )
+{
+    UINT64 uiPeriod   = 4 * (UINT64) uiCount;
+    UINT64 uiReduced  = ( uiPhase % uiPeriod ) << 1;
+    UINT64 uiQuadrant = uiReduced / ( uiCount << 1 );
+    UINT64 uiOffset   = uiReduced % ( uiCount << 1 );
+    FLOAT64 fSign     = ( 1 == uiQuadrant || 2 == uiQuadrant ) ? -1.0 : 1.0;
+    BOOL bSine        = ( 1 == uiQuadrant || 3 == uiQuadrant );
+
+    //
+    // Our offset is measured in units of pi / ( 4 * uiCount ) within the quadrant. Angles beyond
+    // the octant are reflected onto the complementary function.
+    //
+
+    if ( uiOffset > uiCount )
+    {
+        uiOffset = ( uiCount << 1 ) - uiOffset;
+        bSine    = !bSine;
+    }
+
+    FLOAT64 fAngle  = ( uiOffset * 3.14159265358979323846 ) / ( 4.0 * uiCount );
+    FLOAT64 fSquare = fAngle * fAngle;
+    FLOAT64 fTerm   = ( bSine ? fAngle : 1.0 );
+    FLOAT64 fResult = fTerm;
+
+    for ( UINT32 n = ( bSine ? 2 : 1 ); n < 24; n += 2 )
+    {
+        fTerm   = -fTerm * fSquare / ( (FLOAT64) n * ( n + 1 ) );
+        fResult = fResult + fTerm;
+    }
+
+    return fSign * fResult;
+}
+
+//
+// vnFixedPointRound
+//
+//   Removes the fractional bits of a fixed point value, rounding half away from zero. We avoid
+//   shifting negative values since the result of doing so is implementation defined.
+//
+
+inline INT32 vnFixedPointRound( INT64 iValue )
+{
+    CONST INT64 iHalf = (INT64) 1 << ( VN_TRANSFORM_FIXED_POINT_SHIFT - 1 );
+
+    if ( iValue < 0 )
+    {
+        return -(INT32) ( ( -iValue + iHalf ) >> VN_TRANSFORM_FIXED_POINT_SHIFT );
+    }
+
+    return (INT32) ( ( iValue + iHalf ) >> VN_TRANSFORM_FIXED_POINT_SHIFT );
 }
 
-VN_STATUS vnTransformLine( IN INT32 * pInput, UINT32 uiSrcStride, UINT32 uiCount, INT32 * pOutput, UINT32 uiDestStride )
+VN_STATUS vnBuildFixedPointTransformPlan( UINT32 uiCount, OUT CVTransformPlan ** ppPlan )
 {
     if ( VN_PARAM_CHECK )
-	{
-		if ( !pInput || 0 == uiSrcStride || !pOutput || 0 == uiDestStride )
-		{
-			return vnPostError( VN_ERROR_INVALIDARG );
-		}
-	}
+    {
+        if ( 0 == uiCount || !ppPlan )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
 
-    for ( UINT8 i = 0; i < uiCount; i++ )
-	{
-		INT32 iiTotal	    = 0;             
-		INT32 * pOutputCell = pOutput + i * uiDestStride;
+    CVTransformPlan * pPlan = new CVTransformPlan;
 
-		for ( UINT8 k = 0; k < uiCount; k++ )
-		{
-			INT32 * pInputCell = pInput + k * uiSrcStride;
+    if ( !pPlan )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
 
-            iiTotal += (*pInputCell) * cos( ( ( 2 * k + 1 ) * i * VN_PI ) / ( 2 * uiCount ) );
-		}
+    pPlan->m_uiCount      = uiCount;
+    pPlan->m_piFixedBasis = new INT32[ uiCount * uiCount ];
 
-		if ( 0 == i ) iiTotal = iiTotal * vnSqrt( 1.0f / uiCount );
-		else		  iiTotal = iiTotal * vnSqrt( 2.0f / uiCount ); 
+    if ( !pPlan->m_piFixedBasis )
+    {
+        delete pPlan;
 
-		(*pOutputCell) = iiTotal;
-	}
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
 
-	return VN_SUCCESS;
+    //
+    // Fold the normalization factor of each coefficient into its basis row. We use the same
+    // scale as our floating point plans so that both modes produce comparable coefficients. 
+    // vnSqrt is composed entirely of basic IEEE operations, so it is as reproducible as our 
+    // cosine.
+    //
+
+    for ( UINT32 i = 0; i < uiCount; i++ )
+    {
+        INT32 * pBasisRow = pPlan->m_piFixedBasis + i * uiCount;
+        FLOAT64 fScale    = ( 0 == i ? vnSqrt( 1.0f / uiCount ) : vnSqrt( 2.0f / uiCount ) ) * (FLOAT64) ( 1 << VN_TRANSFORM_FIXED_POINT_SHIFT );
+        UINT64 uiRowNorm  = 0;
+
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        {
+            FLOAT64 fValue = fScale * vnFixedPointCosine( ( 2 * k + 1 ) * i % ( 4 * uiCount ), uiCount );
+
+            pBasisRow[ k ] = (INT32) ( fValue < 0 ? fValue - 0.5 : fValue + 0.5 );
+            uiRowNorm     += ( pBasisRow[ k ] < 0 ? -pBasisRow[ k ] : pBasisRow[ k ] );
+        }
+
+        pPlan->m_uiFixedBasisNorm = VN_MAX2( pPlan->m_uiFixedBasisNorm, uiRowNorm );
+    }
+
+    pPlan->m_fBasisNorm = pPlan->m_uiFixedBasisNorm / (FLOAT64) ( 1 << VN_TRANSFORM_FIXED_POINT_SHIFT );
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    pPlan->m_piFixedBasisColumns = new INT32[ uiCount * uiCount ];
+
+    if ( !pPlan->m_piFixedBasisColumns )
+    {
+        delete pPlan;
+
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    INT32 iMaxValue = 0;
+
+    for ( UINT32 i = 0; i < uiCount; i++ )
+    for ( UINT32 k = 0; k < uiCount; k++ )
+    {
+        pPlan->m_piFixedBasisColumns[ k * uiCount + i ] = pPlan->m_piFixedBasis[ i * uiCount + k ];
+        iMaxValue = VN_MAX2( iMaxValue, VN_MAX2( pPlan->m_piFixedBasis[ i * uiCount + k ], -pPlan->m_piFixedBasis[ i * uiCount + k ] ) );
+    }
+
+    //
+    // Each row of our paired basis interleaves the values of two adjacent input samples for every
+    // coefficient, and the final row of an odd length line is padded with zeros. The values of 
+    // short lines (fewer than eight samples) exceed 16 bits, so those plans go without.
+    //
+
+    if ( iMaxValue <= VN_MAX_INT16 )
+    {
+        UINT32 uiPairCount = ( uiCount + 1 ) >> 1;
+
+        pPlan->m_psFixedBasisPairs = new INT16[ uiPairCount * ( uiCount << 1 ) ];
+
+        if ( !pPlan->m_psFixedBasisPairs )
+        {
+            delete pPlan;
+
+            return vnPostError( VN_ERROR_OUTOFMEMORY );
+        }
+
+        for ( UINT32 p = 0; p < uiPairCount; p++ )
+        for ( UINT32 i = 0; i < uiCount; i++ )
+        {
+            INT16 * psPair = pPlan->m_psFixedBasisPairs + p * ( uiCount << 1 ) + ( i << 1 );
+
+            psPair[ 0 ] = (INT16) pPlan->m_piFixedBasis[ i * uiCount + ( p << 1 ) ];
+            psPair[ 1 ] = (INT16) ( ( p << 1 ) + 1 < uiCount ? pPlan->m_piFixedBasis[ i * uiCount + ( p << 1 ) + 1 ] : 0 );
+        }
+    }
+
+#endif
+
+    (*ppPlan) = pPlan;
+
+    return VN_SUCCESS;
 }
 
-VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, OUT CVImage ** pOutput )
+VN_STATUS vnBuildTransformPlan( UINT32 uiCount, OUT CVTransformPlan ** ppPlan )
 {
     if ( VN_PARAM_CHECK )
-	{
-		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pOutput )
-		{
-			return vnPostError( VN_ERROR_INVALIDARG );
-		}
-	}
+    {
+        if ( 0 == uiCount || !ppPlan )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
 
-    INT32 * pScratchBlock = new INT32[ pSrcImage.QueryWidth() * pSrcImage.QueryHeight() ];
+    BOOL bFast              = VN_TRANSFORM_ENABLE_FAST_PATH && vnIsPow2( uiCount ) && uiCount >= VN_TRANSFORM_MIN_FAST_SIZE;
+    BOOL bBasis             = !bFast || uiCount <= VN_TRANSFORM_MAX_CACHED_PLAN_SIZE;
+    CVTransformPlan * pPlan = new CVTransformPlan;
 
-    if ( !pScratchBlock )
+    if ( !pPlan )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    pPlan->m_uiCount       = uiCount;
+    pPlan->m_pfScale       = new FLOAT32[ uiCount ];
+    pPlan->m_pfBasis       = ( bBasis ? new FLOAT32[ uiCount * uiCount ] : 0 );
+    pPlan->m_pfFastFactors = ( bFast ? new FLOAT32[ uiCount ] : 0 );
+
+    if ( !pPlan->m_pfScale || ( bBasis && !pPlan->m_pfBasis ) || ( bFast && !pPlan->m_pfFastFactors ) )
     {
+        delete pPlan;
+
         return vnPostError( VN_ERROR_OUTOFMEMORY );
     }
 
+    for ( UINT32 i = 0; i < uiCount; i++ )
+    {
+        pPlan->m_pfScale[ i ] = ( 0 == i ? vnSqrt( 1.0f / uiCount ) : vnSqrt( 2.0f / uiCount ) );
+    }
+
+    if ( bFast )
+    {
+        //
+        // Each stage of length uiLength splits its input into sums and scaled differences. The
+        // two half length sub-transforms share the factors of the next stage.
+        //
+
+        FLOAT32 * pfFactors = pPlan->m_pfFastFactors;
+
+        for ( UINT32 uiLength = uiCount; uiLength > 1; uiLength >>= 1 )
+        {
+            for ( UINT32 i = 0; i < ( uiLength >> 1 ); i++ )
+            {
+                pfFactors[ i ] = 1.0 / ( 2.0 * cos( ( i + 0.5 ) * VN_PI / uiLength ) );
+            }
+
+            pfFactors += ( uiLength >> 1 );
+        }
+    }
+
     //
-    // Create our destination image as a single channel 16 bit format.
+    // Fold the normalization factor of each coefficient into its basis row.
     //
 
-    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R32S, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), pOutput ) ) )
+    for ( UINT32 i = 0; bBasis && i < uiCount; i++ )
     {
-        delete [] pScratchBlock;
+        FLOAT32 * pBasisRow = pPlan->m_pfBasis + i * uiCount;
+        FLOAT64 fRowNorm    = 0;
 
-        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        {
+            pBasisRow[ k ] = pPlan->m_pfScale[ i ] * cos( ( ( 2 * k + 1 ) * i * VN_PI ) / ( 2 * uiCount ) );
+            fRowNorm      += ( pBasisRow[ k ] < 0 ? -pBasisRow[ k ] : pBasisRow[ k ] );
+        }
+
+        pPlan->m_fBasisNorm = VN_MAX2( pPlan->m_fBasisNorm, fRowNorm );
+    }
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( bBasis )
+    {
+        pPlan->m_pfBasisColumns = new FLOAT32[ uiCount * uiCount ];
+
+        if ( !pPlan->m_pfBasisColumns )
+        {
+            delete pPlan;
+
+            return vnPostError( VN_ERROR_OUTOFMEMORY );
+        }
+
+        for ( UINT32 i = 0; i < uiCount; i++ )
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        {
+            pPlan->m_pfBasisColumns[ k * uiCount + i ] = pPlan->m_pfBasis[ i * uiCount + k ];
+        }
+    }
+
+#endif
+
+    (*ppPlan) = pPlan;
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnAcquireTransformPlan( UINT32 uiCount, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CONST CVTransformPlan ** ppPlan )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( 0 == uiCount || !ppPlan )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    CVTransformPlan * pPlan = NULL;
+    UINT32 uiCacheIndex     = !!( uiFlags & VN_IMAGE_TRANSFORM_FIXED_POINT );
+
+    if ( uiCount > VN_TRANSFORM_MAX_CACHED_PLAN_SIZE )
+    {
+        if ( VN_FAILED( uiCacheIndex ? vnBuildFixedPointTransformPlan( uiCount, &pPlan ) : vnBuildTransformPlan( uiCount, &pPlan ) ) )
+        {
+            return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        }
+
+        (*ppPlan) = pPlan;
+
+        return VN_SUCCESS;
+    }
+
+    pPlan = (CVTransformPlan *) vnAtomicLoadPointer( (VOID * volatile *) &g_pTransformPlanCache[ uiCacheIndex ][ uiCount ] );
+
+    if ( !pPlan )
+    {
+        //
+        // Multiple threads may race to build the same plan. Only the first one to publish
+        // its result wins, and the others discard their copies in favor of the cached plan.
+        // Cached plans live for the duration of the process.
+        //
+
+        CVTransformPlan * pCachedPlan = NULL;
+
+        if ( VN_FAILED( uiCacheIndex ? vnBuildFixedPointTransformPlan( uiCount, &pPlan ) : vnBuildTransformPlan( uiCount, &pPlan ) ) )
+        {
+            return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        }
+
+        pCachedPlan = (CVTransformPlan *) vnAtomicCompareExchangePointer( (VOID * volatile *) &g_pTransformPlanCache[ uiCacheIndex ][ uiCount ], pPlan, NULL );
+
+        if ( pCachedPlan )
+        {
+            delete pPlan;
+
+            pPlan = pCachedPlan;
+        }
+    }
+
+    (*ppPlan) = pPlan;
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnReleaseTransformPlan( CONST CVTransformPlan * pPlan )
+{
+    if ( pPlan && pPlan->m_uiCount > VN_TRANSFORM_MAX_CACHED_PLAN_SIZE )
+    {
+        delete pPlan;
     }
 
+    return VN_SUCCESS;
+}
+
+VOID vnFastTransform( INOUT FLOAT32 * pfVector, FLOAT32 * pfTemp, UINT32 uiLength, CONST FLOAT32 * pfFactors )
+{
+    //
+    // Lee's recursive factorization of an unnormalized DCT-II. pfVector holds the input and 
+    // receives the output, while pfTemp is scratch space of equal length.
     //
-	// Horizontal DCT-II
-	// 
 
-	for ( UINT32 j = 0; j < pSrcImage.QueryHeight(); j++ )
-	{
-        UINT8 * pSrcLine  = pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, j );
-        INT32 * pDestLine = pScratchBlock + j * pSrcImage.QueryWidth();
+    if ( 1 == uiLength )
+    {
+        return;
+    }
 
-		if ( VN_FAILED( vnTransformLine( pSrcLine, 1, pSrcImage.QueryWidth(), pDestLine, 1 ) ) )
-		{
-            delete [] pScratchBlock;
+    UINT32 uiHalfLength = uiLength >> 1;
 
-            vnDestroyImage( *pOutput );
+    for ( UINT32 i = 0; i < uiHalfLength; i++ )
+    {
+        FLOAT32 fX = pfVector[ i ];
+        FLOAT32 fY = pfVector[ uiLength - 1 - i ];
 
-			return vnPostError( VN_ERROR_EXECUTION_FAILURE );
-		}
-	}
+        pfTemp[ i ]                = fX + fY;
+        pfTemp[ i + uiHalfLength ] = ( fX - fY ) * pfFactors[ i ];
+    }
 
-	//
-	// Vertical DCT-II
-	//
+    vnFastTransform( pfTemp, pfVector, uiHalfLength, pfFactors + uiHalfLength );
+    vnFastTransform( pfTemp + uiHalfLength, pfVector, uiHalfLength, pfFactors + uiHalfLength );
 
-	for ( UINT32 i = 0; i < pSrcImage.QueryWidth(); i++ )
-	{
-        INT32 * pSrcLine  = pScratchBlock + i;
-        INT32 * pDestLine = reinterpret_cast<INT32 *>( (*pOutput)->QueryData() + (*pOutput)->BlockOffset( i, 0 ) );
-        
-        if ( VN_FAILED( vnTransformLine( pSrcLine, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), pDestLine, (*pOutput)->QueryWidth() ) ) )
-		{
-            delete [] pScratchBlock;
+    for ( UINT32 i = 0; i < uiHalfLength - 1; i++ )
+    {
+        pfVector[ ( i << 1 ) + 0 ] = pfTemp[ i ];
+        pfVector[ ( i << 1 ) + 1 ] = pfTemp[ i + uiHalfLength ] + pfTemp[ i + uiHalfLength + 1 ];
+    }
 
-            vnDestroyImage( *pOutput );
+    pfVector[ uiLength - 2 ] = pfTemp[ uiHalfLength - 1 ];
+    pfVector[ uiLength - 1 ] = pfTemp[ uiLength - 1 ];
+}
 
-			return vnPostError( VN_ERROR_EXECUTION_FAILURE );
-		}
-	}
+VN_TEMPLATE_T VN_STATUS vnTransformLineFast( IN T * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace )
+{
+    UINT32 uiCount     = pPlan.m_uiCount;
+    FLOAT32 * pfVector = pfWorkspace;
+    FLOAT32 * pfTemp   = pfWorkspace + uiCount;
+
+    for ( UINT32 k = 0; k < uiCount; k++ )
+    {
+        pfVector[ k ] = pInput[ k * uiSrcStride ];
+    }
+
+    vnFastTransform( pfVector, pfTemp, uiCount, pPlan.m_pfFastFactors );
+
+    for ( UINT32 i = 0; i < uiOutputCount; i++ )
+    {
+        pOutput[ i * uiDestStride ] = pfVector[ i ] * pPlan.m_pfScale[ i ];
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_TEMPLATE_T VN_STATUS vnTransformLineDirect( IN T * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace )
+{
+    UINT32 uiCount     = pPlan.m_uiCount;
+    FLOAT32 * pfVector = pfWorkspace;
 
     //
-    // Cleanup
+    // Gather the (possibly strided) line once, so that each coefficient is a contiguous dot
+    // product. We keep four partial sums to break up the dependency chain of the accumulation.
     //
 
-    delete [] pScratchBlock;
+    for ( UINT32 k = 0; k < uiCount; k++ )
+    {
+        pfVector[ k ] = pInput[ k * uiSrcStride ];
+    }
+
+    for ( UINT32 i = 0; i < uiOutputCount; i++ )
+    {
+        FLOAT32 fTotal[ 4 ]       = { 0 };
+        CONST FLOAT32 * pfBasis   = pPlan.QueryBasis( i );
+        UINT32 k                  = 0;
 
-	return VN_SUCCESS;
+        for ( ; k + 4 <= uiCount; k += 4 )
+        {
+            fTotal[ 0 ] += pfVector[ k + 0 ] * pfBasis[ k + 0 ];
+            fTotal[ 1 ] += pfVector[ k + 1 ] * pfBasis[ k + 1 ];
+            fTotal[ 2 ] += pfVector[ k + 2 ] * pfBasis[ k + 2 ];
+            fTotal[ 3 ] += pfVector[ k + 3 ] * pfBasis[ k + 3 ];
+        }
+
+        for ( ; k < uiCount; k++ )
+        {
+            fTotal[ 0 ] += pfVector[ k ] * pfBasis[ k ];
+        }
+
+        pOutput[ i * uiDestStride ] = ( fTotal[ 0 ] + fTotal[ 1 ] ) + ( fTotal[ 2 ] + fTotal[ 3 ] );
+    }
+
+    return VN_SUCCESS;
 }
 
+VN_TEMPLATE_T VN_STATUS vnTransformLineFixedPoint( IN T * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, INT32 * piWorkspace )
+{
+    UINT32 uiCount    = pPlan.m_uiCount;
+    UINT32 uiMaxInput = 0;
+    INT32 * piVector  = piWorkspace;
+
+    //
+    // Gather the (possibly strided) line once, noting its largest magnitude. Integer accumulation 
+    // is associative, so neither our partial sums nor our choice of accumulator affect the result.
+    //
+
+    for ( UINT32 k = 0; k < uiCount; k++ )
+    {
+        piVector[ k ] = pInput[ k * uiSrcStride ];
+        uiMaxInput    = VN_MAX2( uiMaxInput, (UINT32) ( piVector[ k ] < 0 ? -piVector[ k ] : piVector[ k ] ) );
+    }
+
+    if ( (UINT64) uiMaxInput * pPlan.m_uiFixedBasisNorm <= VN_MAX_INT32 )
+    {
+        for ( UINT32 i = 0; i < uiOutputCount; i++ )
+        {
+            INT32 iTotal[ 4 ]       = { 0 };
+            CONST INT32 * piBasis   = pPlan.QueryFixedBasis( i );
+            UINT32 k                = 0;
+
+            for ( ; k + 4 <= uiCount; k += 4 )
+            {
+                iTotal[ 0 ] += piVector[ k + 0 ] * piBasis[ k + 0 ];
+                iTotal[ 1 ] += piVector[ k + 1 ] * piBasis[ k + 1 ];
+                iTotal[ 2 ] += piVector[ k + 2 ] * piBasis[ k + 2 ];
+                iTotal[ 3 ] += piVector[ k + 3 ] * piBasis[ k + 3 ];
+            }
+
+            for ( ; k < uiCount; k++ )
+            {
+                iTotal[ 0 ] += piVector[ k ] * piBasis[ k ];
+            }
+
+            pOutput[ i * uiDestStride ] = vnFixedPointRound( iTotal[ 0 ] + iTotal[ 1 ] + iTotal[ 2 ] + iTotal[ 3 ] );
+        }
+
+        return VN_SUCCESS;
+    }
+
+    for ( UINT32 i = 0; i < uiOutputCount; i++ )
+    {
+        INT64 iTotal[ 4 ]       = { 0 };
+        CONST INT32 * piBasis   = pPlan.QueryFixedBasis( i );
+        UINT32 k                = 0;
+
+        for ( ; k + 4 <= uiCount; k += 4 )
+        {
+            iTotal[ 0 ] += (INT64) piVector[ k + 0 ] * piBasis[ k + 0 ];
+            iTotal[ 1 ] += (INT64) piVector[ k + 1 ] * piBasis[ k + 1 ];
+            iTotal[ 2 ] += (INT64) piVector[ k + 2 ] * piBasis[ k + 2 ];
+            iTotal[ 3 ] += (INT64) piVector[ k + 3 ] * piBasis[ k + 3 ];
+        }
+
+        for ( ; k < uiCount; k++ )
+        {
+            iTotal[ 0 ] += (INT64) piVector[ k ] * piBasis[ k ];
+        }
+
+        pOutput[ i * uiDestStride ] = vnFixedPointRound( iTotal[ 0 ] + iTotal[ 1 ] + iTotal[ 2 ] + iTotal[ 3 ] );
+    }
+
+    return VN_SUCCESS;
+}
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+//
+// Vector Primitives
+//
+//   Our vector kernels operate on groups of eight 32 bit lanes. AVX2 kernels map each group onto 
+//   a single register, while SSE2 kernels split it across a pair of registers. SSE2 lacks a 32 bit
+//   multiply (low), so we assemble one from two 32x32->64 bit multiplies. The low 32 bits of a
+//   product do not depend upon signedness, so the result is exact for any products that fit.
+//   Every level can multiply pairs of 16 bit values and sum each pair into a 32 bit lane with a
+//   single instruction, which is considerably cheaper than a 32 bit multiply.
+//   Primitives that do not take a group are selected by the instruction set level of their caller,
+//   and every level below AVX2 uses the SSE2 primitives.
+//
+
+struct VN_FLOAT32X4X2 { __m128 m_vLow; __m128 m_vHigh; };
+struct VN_INT32X4X2 { __m128i m_vLow; __m128i m_vHigh; };
+
+template < UINT32 LEVEL > struct CVTransformVector { typedef VN_FLOAT32X4X2 FLOAT32X8; typedef VN_INT32X4X2 INT32X8; };
+
+#if defined ( VN_TRANSFORM_USE_AVX2 )
+template <> struct CVTransformVector< VN_CPU_LEVEL_AVX2 > { typedef __m256 FLOAT32X8; typedef __m256i INT32X8; };
+#endif
+
+inline VN_FLOAT32X4X2 vnMakeFloat32x8( CONST __m128 & vLow, CONST __m128 & vHigh ) { VN_FLOAT32X4X2 vResult = { vLow, vHigh }; return vResult; }
+inline VN_INT32X4X2 vnMakeInt32x8( CONST __m128i & vLow, CONST __m128i & vHigh ) { VN_INT32X4X2 vResult = { vLow, vHigh }; return vResult; }
+
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::FLOAT32X8 vnZeroFloat32x8() { return vnMakeFloat32x8( _mm_setzero_ps(), _mm_setzero_ps() ); }
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::FLOAT32X8 vnSplatFloat32x8( FLOAT32 fValue ) { __m128 vValue = _mm_set1_ps( fValue ); return vnMakeFloat32x8( vValue, vValue ); }
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::FLOAT32X8 vnLoadFloat32x8( CONST FLOAT32 * pfSrc ) { return vnMakeFloat32x8( _mm_loadu_ps( pfSrc ), _mm_loadu_ps( pfSrc + 4 ) ); }
+inline VOID vnStoreFloat32x8( FLOAT32 * pfDest, CONST VN_FLOAT32X4X2 & vA ) { _mm_storeu_ps( pfDest, vA.m_vLow ); _mm_storeu_ps( pfDest + 4, vA.m_vHigh ); }
+inline VN_FLOAT32X4X2 vnAddFloat32x8( CONST VN_FLOAT32X4X2 & vA, CONST VN_FLOAT32X4X2 & vB ) { return vnMakeFloat32x8( _mm_add_ps( vA.m_vLow, vB.m_vLow ), _mm_add_ps( vA.m_vHigh, vB.m_vHigh ) ); }
+inline VN_FLOAT32X4X2 vnMultiplyAddFloat32x8( CONST VN_FLOAT32X4X2 & vSum, CONST VN_FLOAT32X4X2 & vA, CONST VN_FLOAT32X4X2 & vB ) { return vnAddFloat32x8( vSum, vnMakeFloat32x8( _mm_mul_ps( vA.m_vLow, vB.m_vLow ), _mm_mul_ps( vA.m_vHigh, vB.m_vHigh ) ) ); }
+inline VN_FLOAT32X4X2 vnConvertInt32x8( CONST VN_INT32X4X2 & vA ) { return vnMakeFloat32x8( _mm_cvtepi32_ps( vA.m_vLow ), _mm_cvtepi32_ps( vA.m_vHigh ) ); }
+
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::INT32X8 vnZeroInt32x8() { return vnMakeInt32x8( _mm_setzero_si128(), _mm_setzero_si128() ); }
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::INT32X8 vnSplatInt32x8( INT32 iValue ) { __m128i vValue = _mm_set1_epi32( iValue ); return vnMakeInt32x8( vValue, vValue ); }
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::INT32X8 vnLoadInt32x8( CONST INT32 * piSrc ) { return vnMakeInt32x8( _mm_loadu_si128( (CONST __m128i *) piSrc ), _mm_loadu_si128( (CONST __m128i *) ( piSrc + 4 ) ) ); }
+inline VOID vnStoreInt32x8( INT32 * piDest, CONST VN_INT32X4X2 & vA ) { _mm_storeu_si128( (__m128i *) piDest, vA.m_vLow ); _mm_storeu_si128( (__m128i *) ( piDest + 4 ), vA.m_vHigh ); }
+inline VN_INT32X4X2 vnAddInt32x8( CONST VN_INT32X4X2 & vA, CONST VN_INT32X4X2 & vB ) { return vnMakeInt32x8( _mm_add_epi32( vA.m_vLow, vB.m_vLow ), _mm_add_epi32( vA.m_vHigh, vB.m_vHigh ) ); }
+inline VN_INT32X4X2 vnTruncateFloat32x8( CONST VN_FLOAT32X4X2 & vA ) { return vnMakeInt32x8( _mm_cvttps_epi32( vA.m_vLow ), _mm_cvttps_epi32( vA.m_vHigh ) ); }
+
+inline __m128i vnMultiplyLowInt32x4( CONST __m128i & vA, CONST __m128i & vB )
+{
+    __m128i vEven = _mm_mul_epu32( vA, vB );
+    __m128i vOdd  = _mm_mul_epu32( _mm_srli_si128( vA, 4 ), _mm_srli_si128( vB, 4 ) );
+
+    return _mm_unpacklo_epi32( _mm_shuffle_epi32( vEven, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( vOdd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+
+inline VN_INT32X4X2 vnMultiplyAddInt32x8( CONST VN_INT32X4X2 & vSum, CONST VN_INT32X4X2 & vA, CONST VN_INT32X4X2 & vB ) 
+{ 
+    return vnAddInt32x8( vSum, vnMakeInt32x8( vnMultiplyLowInt32x4( vA.m_vLow, vB.m_vLow ), vnMultiplyLowInt32x4( vA.m_vHigh, vB.m_vHigh ) ) ); 
+}
+
+inline VN_INT32X4X2 vnMultiplyAddPairs16x8( CONST VN_INT32X4X2 & vSum, CONST VN_INT32X4X2 & vPair, CONST INT16 * psPairs )
+{
+    __m128i vLow  = _mm_madd_epi16( vPair.m_vLow, _mm_loadu_si128( (CONST __m128i *) psPairs ) );
+    __m128i vHigh = _mm_madd_epi16( vPair.m_vHigh, _mm_loadu_si128( (CONST __m128i *) ( psPairs + 8 ) ) );
+
+    return vnAddInt32x8( vSum, vnMakeInt32x8( vLow, vHigh ) );
+}
+
+inline INT32 vnPackBasisPair( CONST INT16 * psPair )
+{
+    //
+    // Packs a pair of 16 bit basis values into a single 32 bit value, first value lowest, as
+    // vnInterleavePairs16x8 does.
+    //
+
+    return (INT32) ( (UINT32) (UINT16) psPair[ 0 ] | ( (UINT32) (UINT16) psPair[ 1 ] << 16 ) );
+}
+
+inline VOID vnInterleavePairs16x8( CONST INT32 * piFirst, CONST INT32 * piSecond, INT16 * psDest )
+{
+    //
+    // Narrows eight values of each of two rows (which must fit within 16 bits), and interleaves 
+    // them into eight pairs in the layout expected by vnMultiplyAddPairs16x8.
+    //
+
+    __m128i vFirst  = _mm_packs_epi32( _mm_loadu_si128( (CONST __m128i *) piFirst ), _mm_loadu_si128( (CONST __m128i *) ( piFirst + 4 ) ) );
+    __m128i vSecond = _mm_packs_epi32( _mm_loadu_si128( (CONST __m128i *) piSecond ), _mm_loadu_si128( (CONST __m128i *) ( piSecond + 4 ) ) );
+
+    _mm_storeu_si128( (__m128i *) psDest, _mm_unpacklo_epi16( vFirst, vSecond ) );
+    _mm_storeu_si128( (__m128i *) ( psDest + 8 ), _mm_unpackhi_epi16( vFirst, vSecond ) );
+}
+
+inline __m128i vnFixedPointRoundInt32x4( CONST __m128i & vA )
+{
+    //
+    // Equivalent to vnFixedPointRound. We take the magnitude with a sign mask, and shift it as
+    // an unsigned value since it may exceed VN_MAX_INT32 once rounded.
+    //
+
+    __m128i vSign      = _mm_srai_epi32( vA, 31 );
+    __m128i vHalf      = _mm_set1_epi32( 1 << ( VN_TRANSFORM_FIXED_POINT_SHIFT - 1 ) );
+    __m128i vMagnitude = _mm_sub_epi32( _mm_xor_si128( vA, vSign ), vSign );
+
+    vMagnitude = _mm_srli_epi32( _mm_add_epi32( vMagnitude, vHalf ), VN_TRANSFORM_FIXED_POINT_SHIFT );
+
+    return _mm_sub_epi32( _mm_xor_si128( vMagnitude, vSign ), vSign );
+}
+
+inline VN_INT32X4X2 vnFixedPointRoundInt32x8( CONST VN_INT32X4X2 & vA ) { return vnMakeInt32x8( vnFixedPointRoundInt32x4( vA.m_vLow ), vnFixedPointRoundInt32x4( vA.m_vHigh ) ); }
+
+#if defined ( VN_TRANSFORM_USE_AVX2 )
+
+template <> inline __m256 vnZeroFloat32x8< VN_CPU_LEVEL_AVX2 >() { return _mm256_setzero_ps(); }
+template <> inline __m256 vnSplatFloat32x8< VN_CPU_LEVEL_AVX2 >( FLOAT32 fValue ) { return _mm256_set1_ps( fValue ); }
+template <> inline __m256 vnLoadFloat32x8< VN_CPU_LEVEL_AVX2 >( CONST FLOAT32 * pfSrc ) { return _mm256_loadu_ps( pfSrc ); }
+inline VOID vnStoreFloat32x8( FLOAT32 * pfDest, CONST __m256 & vA ) { _mm256_storeu_ps( pfDest, vA ); }
+inline __m256 vnAddFloat32x8( CONST __m256 & vA, CONST __m256 & vB ) { return _mm256_add_ps( vA, vB ); }
+inline __m256 vnMultiplyAddFloat32x8( CONST __m256 & vSum, CONST __m256 & vA, CONST __m256 & vB ) { return _mm256_add_ps( vSum, _mm256_mul_ps( vA, vB ) ); }
+inline __m256 vnConvertInt32x8( CONST __m256i & vA ) { return _mm256_cvtepi32_ps( vA ); }
+
+template <> inline __m256i vnZeroInt32x8< VN_CPU_LEVEL_AVX2 >() { return _mm256_setzero_si256(); }
+template <> inline __m256i vnSplatInt32x8< VN_CPU_LEVEL_AVX2 >( INT32 iValue ) { return _mm256_set1_epi32( iValue ); }
+template <> inline __m256i vnLoadInt32x8< VN_CPU_LEVEL_AVX2 >( CONST INT32 * piSrc ) { return _mm256_loadu_si256( (CONST __m256i *) piSrc ); }
+inline VOID vnStoreInt32x8( INT32 * piDest, CONST __m256i & vA ) { _mm256_storeu_si256( (__m256i *) piDest, vA ); }
+inline __m256i vnAddInt32x8( CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_add_epi32( vA, vB ); }
+inline __m256i vnMultiplyAddInt32x8( CONST __m256i & vSum, CONST __m256i & vA, CONST __m256i & vB ) { return _mm256_add_epi32( vSum, _mm256_mullo_epi32( vA, vB ) ); }
+inline __m256i vnMultiplyAddPairs16x8( CONST __m256i & vSum, CONST __m256i & vPair, CONST INT16 * psPairs ) { return _mm256_add_epi32( vSum, _mm256_madd_epi16( vPair, _mm256_loadu_si256( (CONST __m256i *) psPairs ) ) ); }
+inline __m256i vnTruncateFloat32x8( CONST __m256 & vA ) { return _mm256_cvttps_epi32( vA ); }
+
+inline __m256i vnFixedPointRoundInt32x8( CONST __m256i & vA )
+{
+    //
+    // Equivalent to vnFixedPointRound. The rounded magnitude may exceed VN_MAX_INT32 before it
+    // is shifted, so we shift it as an unsigned value.
+    //
+
+    __m256i vHalf      = _mm256_set1_epi32( 1 << ( VN_TRANSFORM_FIXED_POINT_SHIFT - 1 ) );
+    __m256i vMagnitude = _mm256_srli_epi32( _mm256_add_epi32( _mm256_abs_epi32( vA ), vHalf ), VN_TRANSFORM_FIXED_POINT_SHIFT );
+
+    return _mm256_sign_epi32( vMagnitude, vA );
+}
+
+#endif
+
+//
+// Overloads of the above for use by code that is templated upon the lane type.
+//
+
+template < class T, UINT32 LEVEL > struct CVVectorType {};
+template < UINT32 LEVEL > struct CVVectorType< FLOAT32, LEVEL > { typedef typename CVTransformVector< LEVEL >::FLOAT32X8 TYPE; };
+template < UINT32 LEVEL > struct CVVectorType< INT32, LEVEL > { typedef typename CVTransformVector< LEVEL >::INT32X8 TYPE; };
+
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::FLOAT32X8 vnSplatVector( FLOAT32 fValue ) { return vnSplatFloat32x8< LEVEL >( fValue ); }
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::FLOAT32X8 vnLoadVector( CONST FLOAT32 * pfSrc ) { return vnLoadFloat32x8< LEVEL >( pfSrc ); }
+template < class V > inline VOID vnStoreVector( FLOAT32 * pfDest, CONST V & vA ) { vnStoreFloat32x8( pfDest, vA ); }
+
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::INT32X8 vnSplatVector( INT32 iValue ) { return vnSplatInt32x8< LEVEL >( iValue ); }
+template < UINT32 LEVEL > inline typename CVTransformVector< LEVEL >::INT32X8 vnLoadVector( CONST INT32 * piSrc ) { return vnLoadInt32x8< LEVEL >( piSrc ); }
+template < class V > inline VOID vnStoreVector( INT32 * piDest, CONST V & vA ) { vnStoreInt32x8( piDest, vA ); }
+
+inline VN_FLOAT32X4X2 vnMultiplyAddVector( CONST VN_FLOAT32X4X2 & vSum, CONST VN_FLOAT32X4X2 & vA, CONST VN_FLOAT32X4X2 & vB ) { return vnMultiplyAddFloat32x8( vSum, vA, vB ); }
+inline VN_INT32X4X2 vnMultiplyAddVector( CONST VN_INT32X4X2 & vSum, CONST VN_INT32X4X2 & vA, CONST VN_INT32X4X2 & vB ) { return vnMultiplyAddInt32x8( vSum, vA, vB ); }
+
+#if defined ( VN_TRANSFORM_USE_AVX2 )
+inline __m256 vnMultiplyAddVector( CONST __m256 & vSum, CONST __m256 & vA, CONST __m256 & vB ) { return vnMultiplyAddFloat32x8( vSum, vA, vB ); }
+inline __m256i vnMultiplyAddVector( CONST __m256i & vSum, CONST __m256i & vA, CONST __m256i & vB ) { return vnMultiplyAddInt32x8( vSum, vA, vB ); }
+#endif
+
+template < class V > inline VOID vnStoreInt32x8( INT32 * piDest, UINT32 uiDestStride, CONST V & vA )
+{
+    if ( 1 == uiDestStride )
+    {
+        vnStoreInt32x8( piDest, vA );
+        return;
+    }
+
+    INT32 iLanes[ VN_TRANSFORM_VECTOR_WIDTH ];
+
+    vnStoreInt32x8( iLanes, vA );
+
+    for ( UINT32 i = 0; i < VN_TRANSFORM_VECTOR_WIDTH; i++ )
+    {
+        piDest[ i * uiDestStride ] = iLanes[ i ];
+    }
+}
+
+//
+// vnTransformLineDirectVector
+//
+//   Vector form of vnTransformLineDirect. Each group of eight adjacent coefficients accumulates
+//   one scaled column of the basis per input sample, using two sums to shorten the dependency
+//   chain. Any remaining coefficients are evaluated as scalar dot products.
+//
+
+template < UINT32 LEVEL, class T >
+VN_STATUS vnTransformLineDirectVector( IN T * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace )
+{
+    typedef typename CVTransformVector< LEVEL >::FLOAT32X8 VN_FLOAT32X8;
+
+    UINT32 uiCount     = pPlan.m_uiCount;
+    FLOAT32 * pfVector = pfWorkspace;
+    UINT32 i           = 0;
+
+    for ( UINT32 k = 0; k < uiCount; k++ )
+    {
+        pfVector[ k ] = pInput[ k * uiSrcStride ];
+    }
+
+    for ( ; i + VN_TRANSFORM_VECTOR_WIDTH <= uiOutputCount; i += VN_TRANSFORM_VECTOR_WIDTH )
+    {
+        VN_FLOAT32X8 vTotal[ 2 ] = { vnZeroFloat32x8< LEVEL >(), vnZeroFloat32x8< LEVEL >() };
+        UINT32 k                 = 0;
+
+        for ( ; k + 2 <= uiCount; k += 2 )
+        {
+            vTotal[ 0 ] = vnMultiplyAddFloat32x8( vTotal[ 0 ], vnSplatFloat32x8< LEVEL >( pfVector[ k + 0 ] ), vnLoadFloat32x8< LEVEL >( pPlan.QueryBasisColumn( k + 0 ) + i ) );
+            vTotal[ 1 ] = vnMultiplyAddFloat32x8( vTotal[ 1 ], vnSplatFloat32x8< LEVEL >( pfVector[ k + 1 ] ), vnLoadFloat32x8< LEVEL >( pPlan.QueryBasisColumn( k + 1 ) + i ) );
+        }
+
+        if ( k < uiCount )
+        {
+            vTotal[ 0 ] = vnMultiplyAddFloat32x8( vTotal[ 0 ], vnSplatFloat32x8< LEVEL >( pfVector[ k ] ), vnLoadFloat32x8< LEVEL >( pPlan.QueryBasisColumn( k ) + i ) );
+        }
+
+        vnStoreInt32x8( pOutput + i * uiDestStride, uiDestStride, vnTruncateFloat32x8( vnAddFloat32x8( vTotal[ 0 ], vTotal[ 1 ] ) ) );
+    }
+
+    for ( ; i < uiOutputCount; i++ )
+    {
+        FLOAT32 fTotal          = 0.0f;
+        CONST FLOAT32 * pfBasis = pPlan.QueryBasis( i );
+
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        {
+            fTotal += pfVector[ k ] * pfBasis[ k ];
+        }
+
+        pOutput[ i * uiDestStride ] = fTotal;
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// vnTransformLineFixedPointVector
+//
+//   Vector form of vnTransformLineFixedPoint. Lines that require 64 bit accumulation are handed
+//   to the scalar kernel. Integer sums are exact, so both kernels produce identical results.
+//
+
+template < UINT32 LEVEL, class T >
+VN_STATUS vnTransformLineFixedPointVector( IN T * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, INT32 * piWorkspace )
+{
+    typedef typename CVTransformVector< LEVEL >::INT32X8 VN_INT32X8;
+
+    UINT32 uiCount    = pPlan.m_uiCount;
+    UINT32 uiMaxInput = 0;
+    INT32 * piVector  = piWorkspace;
+    UINT32 i          = 0;
+
+    for ( UINT32 k = 0; k < uiCount; k++ )
+    {
+        piVector[ k ] = pInput[ k * uiSrcStride ];
+        uiMaxInput    = VN_MAX2( uiMaxInput, (UINT32) ( piVector[ k ] < 0 ? -piVector[ k ] : piVector[ k ] ) );
+    }
+
+    if ( (UINT64) uiMaxInput * pPlan.m_uiFixedBasisNorm > VN_MAX_INT32 )
+    {
+        return vnTransformLineFixedPoint( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, piWorkspace );
+    }
+
+    for ( ; i + VN_TRANSFORM_VECTOR_WIDTH <= uiOutputCount; i += VN_TRANSFORM_VECTOR_WIDTH )
+    {
+        VN_INT32X8 vTotal[ 2 ] = { vnZeroInt32x8< LEVEL >(), vnZeroInt32x8< LEVEL >() };
+        UINT32 k               = 0;
+
+        for ( ; k + 2 <= uiCount; k += 2 )
+        {
+            vTotal[ 0 ] = vnMultiplyAddInt32x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( piVector[ k + 0 ] ), vnLoadInt32x8< LEVEL >( pPlan.QueryFixedBasisColumn( k + 0 ) + i ) );
+            vTotal[ 1 ] = vnMultiplyAddInt32x8( vTotal[ 1 ], vnSplatInt32x8< LEVEL >( piVector[ k + 1 ] ), vnLoadInt32x8< LEVEL >( pPlan.QueryFixedBasisColumn( k + 1 ) + i ) );
+        }
+
+        if ( k < uiCount )
+        {
+            vTotal[ 0 ] = vnMultiplyAddInt32x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( piVector[ k ] ), vnLoadInt32x8< LEVEL >( pPlan.QueryFixedBasisColumn( k ) + i ) );
+        }
+
+        vnStoreInt32x8( pOutput + i * uiDestStride, uiDestStride, vnFixedPointRoundInt32x8( vnAddInt32x8( vTotal[ 0 ], vTotal[ 1 ] ) ) );
+    }
+
+    for ( ; i < uiOutputCount; i++ )
+    {
+        INT32 iTotal          = 0;
+        CONST INT32 * piBasis = pPlan.QueryFixedBasis( i );
+
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        {
+            iTotal += piVector[ k ] * piBasis[ k ];
+        }
+
+        pOutput[ i * uiDestStride ] = vnFixedPointRound( iTotal );
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// vnTransformLineFixedPointPairs
+//
+//   Form of vnTransformLineFixedPointVector for 8 bit lines. We pack each pair of adjacent samples
+//   into a single 32 bit value and accumulate it against the paired basis, which takes half as 
+//   many multiplies and avoids the 32 bit multiply entirely. Every sample is at most 255, so one 
+//   check of the plan tells us whether the sums fit within 32 bits. Plans without a paired basis,
+//   and lines that require 64 bit accumulation, use the general kernel. All of these kernels 
+//   produce identical results.
+//
+
+template < UINT32 LEVEL >
+VN_STATUS vnTransformLineFixedPointPairs( IN UINT8 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, INT32 * piWorkspace )
+{
+    typedef typename CVTransformVector< LEVEL >::INT32X8 VN_INT32X8;
+
+    UINT32 uiCount     = pPlan.m_uiCount;
+    UINT32 uiPairCount = ( uiCount + 1 ) >> 1;
+    INT32 * piPairs    = piWorkspace;
+    UINT32 i           = 0;
+
+    if ( !pPlan.m_psFixedBasisPairs || 255 * pPlan.m_uiFixedBasisNorm > VN_MAX_INT32 )
+    {
+        return vnTransformLineFixedPointVector< LEVEL >( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, piWorkspace );
+    }
+
+    for ( UINT32 p = 0; p < uiPairCount; p++ )
+    {
+        UINT32 k = p << 1;
+
+        piPairs[ p ] = pInput[ k * uiSrcStride ] | ( k + 1 < uiCount ? pInput[ ( k + 1 ) * uiSrcStride ] << 16 : 0 );
+    }
+
+    for ( ; i + VN_TRANSFORM_VECTOR_WIDTH <= uiOutputCount; i += VN_TRANSFORM_VECTOR_WIDTH )
+    {
+        VN_INT32X8 vTotal[ 2 ] = { vnZeroInt32x8< LEVEL >(), vnZeroInt32x8< LEVEL >() };
+        UINT32 p               = 0;
+
+        for ( ; p + 2 <= uiPairCount; p += 2 )
+        {
+            vTotal[ 0 ] = vnMultiplyAddPairs16x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( piPairs[ p + 0 ] ), pPlan.QueryFixedBasisPair( p + 0 ) + ( i << 1 ) );
+            vTotal[ 1 ] = vnMultiplyAddPairs16x8( vTotal[ 1 ], vnSplatInt32x8< LEVEL >( piPairs[ p + 1 ] ), pPlan.QueryFixedBasisPair( p + 1 ) + ( i << 1 ) );
+        }
+
+        if ( p < uiPairCount )
+        {
+            vTotal[ 0 ] = vnMultiplyAddPairs16x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( piPairs[ p ] ), pPlan.QueryFixedBasisPair( p ) + ( i << 1 ) );
+        }
+
+        vnStoreInt32x8( pOutput + i * uiDestStride, uiDestStride, vnFixedPointRoundInt32x8( vnAddInt32x8( vTotal[ 0 ], vTotal[ 1 ] ) ) );
+    }
+
+    for ( ; i < uiOutputCount; i++ )
+    {
+        INT32 iTotal          = 0;
+        CONST INT32 * piBasis = pPlan.QueryFixedBasis( i );
+
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        {
+            iTotal += pInput[ k * uiSrcStride ] * piBasis[ k ];
+        }
+
+        pOutput[ i * uiDestStride ] = vnFixedPointRound( iTotal );
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// vnTransformColumnGroup
+//
+//   Transforms eight adjacent columns of a coefficient block at once. Each input row contributes
+//   a single contiguous vector, so we never gather along a column. Returns false if the group 
+//   requires 64 bit fixed point accumulation, in which case nothing is written.
+//
+
+template < UINT32 LEVEL >
+BOOL vnTransformColumnGroup( IN CONST INT32 * pInput, UINT32 uiSrcPitch, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestPitch )
+{
+    typedef typename CVTransformVector< LEVEL >::FLOAT32X8 VN_FLOAT32X8;
+    typedef typename CVTransformVector< LEVEL >::INT32X8 VN_INT32X8;
+
+    UINT32 uiCount = pPlan.m_uiCount;
+
+    if ( pPlan.IsFixedPoint() )
+    {
+        UINT32 uiMaxInput = 0;
+
+        for ( UINT32 k = 0; k < uiCount; k++ )
+        for ( UINT32 j = 0; j < VN_TRANSFORM_VECTOR_WIDTH; j++ )
+        {
+            INT32 iValue = pInput[ k * uiSrcPitch + j ];
+            uiMaxInput   = VN_MAX2( uiMaxInput, (UINT32) ( iValue < 0 ? -iValue : iValue ) );
+        }
+
+        if ( (UINT64) uiMaxInput * pPlan.m_uiFixedBasisNorm > VN_MAX_INT32 )
+        {
+            return FALSE;
+        }
+
+        if ( pPlan.m_psFixedBasisPairs && uiMaxInput <= VN_MAX_INT16 && uiCount <= VN_TRANSFORM_MAX_PAIRED_COLUMN_SIZE )
+        {
+            CONST INT32 iZeroRow[ VN_TRANSFORM_VECTOR_WIDTH ] = { 0 };
+            INT16 psPairs[ VN_TRANSFORM_MAX_PAIRED_COLUMN_SIZE * VN_TRANSFORM_VECTOR_WIDTH ];
+            UINT32 uiPairCount = ( uiCount + 1 ) >> 1;
+
+            for ( UINT32 p = 0; p < uiPairCount; p++ )
+            {
+                UINT32 k = p << 1;
+
+                vnInterleavePairs16x8( pInput + k * uiSrcPitch, ( k + 1 < uiCount ? pInput + ( k + 1 ) * uiSrcPitch : iZeroRow ), psPairs + ( p << 4 ) );
+            }
+
+            for ( UINT32 i = 0; i < uiOutputCount; i++ )
+            {
+                VN_INT32X8 vTotal[ 2 ] = { vnZeroInt32x8< LEVEL >(), vnZeroInt32x8< LEVEL >() };
+                UINT32 p               = 0;
+
+                for ( ; p + 2 <= uiPairCount; p += 2 )
+                {
+                    CONST INT16 * psBasis0 = pPlan.QueryFixedBasisPair( p + 0 ) + ( i << 1 );
+                    CONST INT16 * psBasis1 = pPlan.QueryFixedBasisPair( p + 1 ) + ( i << 1 );
+
+                    vTotal[ 0 ] = vnMultiplyAddPairs16x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( vnPackBasisPair( psBasis0 ) ), psPairs + ( ( p + 0 ) << 4 ) );
+                    vTotal[ 1 ] = vnMultiplyAddPairs16x8( vTotal[ 1 ], vnSplatInt32x8< LEVEL >( vnPackBasisPair( psBasis1 ) ), psPairs + ( ( p + 1 ) << 4 ) );
+                }
+
+                if ( p < uiPairCount )
+                {
+                    CONST INT16 * psBasis = pPlan.QueryFixedBasisPair( p ) + ( i << 1 );
+
+                    vTotal[ 0 ] = vnMultiplyAddPairs16x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( vnPackBasisPair( psBasis ) ), psPairs + ( p << 4 ) );
+                }
+
+                vnStoreInt32x8( pOutput + i * uiDestPitch, vnFixedPointRoundInt32x8( vnAddInt32x8( vTotal[ 0 ], vTotal[ 1 ] ) ) );
+            }
+
+            return TRUE;
+        }
+
+        for ( UINT32 i = 0; i < uiOutputCount; i++ )
+        {
+            VN_INT32X8 vTotal[ 2 ] = { vnZeroInt32x8< LEVEL >(), vnZeroInt32x8< LEVEL >() };
+            CONST INT32 * piBasis  = pPlan.QueryFixedBasis( i );
+            UINT32 k               = 0;
+
+            for ( ; k + 2 <= uiCount; k += 2 )
+            {
+                vTotal[ 0 ] = vnMultiplyAddInt32x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( piBasis[ k + 0 ] ), vnLoadInt32x8< LEVEL >( pInput + ( k + 0 ) * uiSrcPitch ) );
+                vTotal[ 1 ] = vnMultiplyAddInt32x8( vTotal[ 1 ], vnSplatInt32x8< LEVEL >( piBasis[ k + 1 ] ), vnLoadInt32x8< LEVEL >( pInput + ( k + 1 ) * uiSrcPitch ) );
+            }
+
+            if ( k < uiCount )
+            {
+                vTotal[ 0 ] = vnMultiplyAddInt32x8( vTotal[ 0 ], vnSplatInt32x8< LEVEL >( piBasis[ k ] ), vnLoadInt32x8< LEVEL >( pInput + k * uiSrcPitch ) );
+            }
+
+            vnStoreInt32x8( pOutput + i * uiDestPitch, vnFixedPointRoundInt32x8( vnAddInt32x8( vTotal[ 0 ], vTotal[ 1 ] ) ) );
+        }
+
+        return TRUE;
+    }
+
+    for ( UINT32 i = 0; i < uiOutputCount; i++ )
+    {
+        VN_FLOAT32X8 vTotal[ 2 ] = { vnZeroFloat32x8< LEVEL >(), vnZeroFloat32x8< LEVEL >() };
+        CONST FLOAT32 * pfBasis  = pPlan.QueryBasis( i );
+        UINT32 k                 = 0;
+
+        for ( ; k + 2 <= uiCount; k += 2 )
+        {
+            vTotal[ 0 ] = vnMultiplyAddFloat32x8( vTotal[ 0 ], vnSplatFloat32x8< LEVEL >( pfBasis[ k + 0 ] ), vnConvertInt32x8( vnLoadInt32x8< LEVEL >( pInput + ( k + 0 ) * uiSrcPitch ) ) );
+            vTotal[ 1 ] = vnMultiplyAddFloat32x8( vTotal[ 1 ], vnSplatFloat32x8< LEVEL >( pfBasis[ k + 1 ] ), vnConvertInt32x8( vnLoadInt32x8< LEVEL >( pInput + ( k + 1 ) * uiSrcPitch ) ) );
+        }
+
+        if ( k < uiCount )
+        {
+            vTotal[ 0 ] = vnMultiplyAddFloat32x8( vTotal[ 0 ], vnSplatFloat32x8< LEVEL >( pfBasis[ k ] ), vnConvertInt32x8( vnLoadInt32x8< LEVEL >( pInput + k * uiSrcPitch ) ) );
+        }
+
+        vnStoreInt32x8( pOutput + i * uiDestPitch, vnTruncateFloat32x8( vnAddFloat32x8( vTotal[ 0 ], vTotal[ 1 ] ) ) );
+    }
+
+    return TRUE;
+}
+
+#endif
+
+//
+// vnBindTransformKernels
+//
+//   Returns the line kernels that best suit the host processor. Kernels are bound once, when
+//   the module is loaded. Hosts that run our vector kernels also favor the direct form (see
+//   vnUseDirectTransform), so we record the level that we bound.
+//
+
+struct CVTransformKernels
+{
+    UINT32 m_uiLevel;
+
+    VN_STATUS ( *m_pfnLineDirect8 )( IN UINT8 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace );
+    VN_STATUS ( *m_pfnLineDirect32 )( IN INT32 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace );
+    VN_STATUS ( *m_pfnLineFixedPoint8 )( IN UINT8 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, INT32 * piWorkspace );
+    VN_STATUS ( *m_pfnLineFixedPoint32 )( IN INT32 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, INT32 * piWorkspace );
+    BOOL ( *m_pfnColumnGroup )( IN CONST INT32 * pInput, UINT32 uiSrcPitch, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestPitch );
+};
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+template < UINT32 LEVEL >
+CVTransformKernels vnQueryVectorTransformKernels()
+{
+    CVTransformKernels pKernels = { LEVEL, 
+                                    vnTransformLineDirectVector< LEVEL, UINT8 >, 
+                                    vnTransformLineDirectVector< LEVEL, INT32 >, 
+                                    vnTransformLineFixedPointPairs< LEVEL >, 
+                                    vnTransformLineFixedPointVector< LEVEL, INT32 >, 
+                                    vnTransformColumnGroup< LEVEL > };
+    return pKernels;
+}
+
+#endif
+
+CVTransformKernels vnBindTransformKernels()
+{
+    UINT32 uiLevel = vnQueryCpuLevel();
+
+#if defined ( VN_TRANSFORM_USE_AVX2 )
+
+    if ( uiLevel >= VN_CPU_LEVEL_AVX2 )
+    {
+        return vnQueryVectorTransformKernels< VN_CPU_LEVEL_AVX2 >();
+    }
+
+#endif
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( uiLevel >= VN_CPU_LEVEL_SSE2 )
+    {
+        return vnQueryVectorTransformKernels< VN_CPU_LEVEL_SSE2 >();
+    }
+
+#endif
+
+    CVTransformKernels pKernels = { VN_CPU_LEVEL_SCALAR, 
+                                    vnTransformLineDirect< UINT8 >, 
+                                    vnTransformLineDirect< INT32 >, 
+                                    vnTransformLineFixedPoint< UINT8 >, 
+                                    vnTransformLineFixedPoint< INT32 >, 
+                                    NULL };
+    return pKernels;
+}
+
+static CVTransformKernels g_pTransformKernels = vnBindTransformKernels();
+
+//
+// vnUseDirectTransform
+//
+//   Returns true if a floating point line should be evaluated directly from the basis of pPlan, 
+//   rather than with the fast factorization.
+//
+
+BOOL vnUseDirectTransform( CONST CVTransformPlan & pPlan, UINT32 uiOutputCount )
+{
+    if ( !pPlan.HasBasis() )
+    {
+        return FALSE;
+    }
+
+    if ( !pPlan.IsFast() || uiOutputCount < pPlan.m_uiCount )
+    {
+        return TRUE;
+    }
+
+    return ( VN_CPU_LEVEL_SCALAR != g_pTransformKernels.m_uiLevel && pPlan.m_uiCount <= VN_TRANSFORM_MAX_VECTOR_DIRECT_SIZE );
+}
+
+//
+// vnTransformLine
+//
+//   Transforms a single line and writes its first uiOutputCount coefficients. Fixed point plans
+//   always use their integer basis. Otherwise, full lines use the fast form when the plan 
+//   supports it (see vnUseDirectTransform), while pruned lines evaluate only the requested 
+//   coefficients directly. Both direct forms use the kernels bound for the host processor. 
+//   pfWorkspace must hold at least ( 2 * uiCount ) values.
+//
+
+VN_STATUS vnTransformLine( IN UINT8 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pInput || 0 == uiSrcStride || !pOutput || 0 == uiDestStride || !pfWorkspace || uiOutputCount > pPlan.m_uiCount )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( pPlan.IsFixedPoint() )
+    {
+        return g_pTransformKernels.m_pfnLineFixedPoint8( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, reinterpret_cast<INT32 *>( pfWorkspace ) );
+    }
+
+    if ( vnUseDirectTransform( pPlan, uiOutputCount ) )
+    {
+        return g_pTransformKernels.m_pfnLineDirect8( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, pfWorkspace );
+    }
+
+    return vnTransformLineFast( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, pfWorkspace );
+}
+
+VN_STATUS vnTransformLine( IN INT32 * pInput, UINT32 uiSrcStride, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pOutput, UINT32 uiDestStride, FLOAT32 * pfWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pInput || 0 == uiSrcStride || !pOutput || 0 == uiDestStride || !pfWorkspace || uiOutputCount > pPlan.m_uiCount )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( pPlan.IsFixedPoint() )
+    {
+        return g_pTransformKernels.m_pfnLineFixedPoint32( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, reinterpret_cast<INT32 *>( pfWorkspace ) );
+    }
+
+    if ( vnUseDirectTransform( pPlan, uiOutputCount ) )
+    {
+        return g_pTransformKernels.m_pfnLineDirect32( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, pfWorkspace );
+    }
+
+    return vnTransformLineFast( pInput, uiSrcStride, pPlan, uiOutputCount, pOutput, uiDestStride, pfWorkspace );
+}
+
+//
+// vnTransposeBlock
+//
+//   Transposes a ( uiWidth x uiHeight ) block of coefficients into pDest. Pitches are specified
+//   in elements. We walk the block in square tiles so that both the reads and the writes of a 
+//   tile stay resident in the cache, regardless of the size of the block.
+//
+
+VN_STATUS vnTransposeBlock( IN CONST INT32 * pSrc, UINT32 uiSrcPitch, UINT32 uiWidth, UINT32 uiHeight, INT32 * pDest, UINT32 uiDestPitch )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pSrc || !pDest || uiSrcPitch < uiWidth || uiDestPitch < uiHeight )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    for ( UINT32 jj = 0; jj < uiHeight; jj += VN_TRANSFORM_TRANSPOSE_TILE_SIZE )
+    for ( UINT32 ii = 0; ii < uiWidth; ii += VN_TRANSFORM_TRANSPOSE_TILE_SIZE )
+    {
+        UINT32 uiTileWidth  = VN_MIN2( VN_TRANSFORM_TRANSPOSE_TILE_SIZE, uiWidth - ii );
+        UINT32 uiTileHeight = VN_MIN2( VN_TRANSFORM_TRANSPOSE_TILE_SIZE, uiHeight - jj );
+
+        for ( UINT32 j = jj; j < jj + uiTileHeight; j++ )
+        {
+            CONST INT32 * pSrcLine = pSrc + j * uiSrcPitch;
+
+            for ( UINT32 i = ii; i < ii + uiTileWidth; i++ )
+            {
+                pDest[ i * uiDestPitch + j ] = pSrcLine[ i ];
+            }
+        }
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// Benchmark Switch
+//
+//   Benchmarks may route every column pass through vnTransformColumnsStrided, our original 
+//   strided column pass, so that it can be timed against the passes below. The switch is not
+//   part of the public interface, and must not be changed while a transform is in progress.
+//
+
+static BOOL g_bStridedTransformColumns = FALSE;
+
+VOID vnEnableStridedTransformColumns( BOOL bEnable )
+{
+    g_bStridedTransformColumns = bEnable;
+}
+
+//
+// vnTransformColumnsStrided
+//
+//   The reference column pass, which transforms each column of the block in place, with a
+//   stride of one row. Arguments are as for vnTransformColumns.
+//
+
+VN_STATUS vnTransformColumnsStrided( IN INT32 * pBlock, UINT32 uiWidth, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pDest, UINT32 uiDestPitch, FLOAT32 * pfWorkspace )
+{
+    for ( UINT32 i = 0; i < uiWidth; i++ )
+    {
+        if ( VN_FAILED( vnTransformLine( pBlock + i, uiWidth, pPlan, uiOutputCount, pDest + i, uiDestPitch, pfWorkspace ) ) )
+        {
+            return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        }
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// vnTransformColumns
+//
+//   Writes the first uiOutputCount coefficients of each column of a ( uiWidth x uiHeight ) block
+//   into the rows of pDest. The block is overwritten, and pColumnBlock must hold an equal number
+//   of scratch values. Pitches are specified in elements.
+//
+//   Hosts that run our vector kernels transform groups of adjacent columns in place, reading each
+//   row of the group contiguously. Otherwise (and for the fast form, which requires contiguous 
+//   lines) we transpose the block tile by tile and run the column pass as a second row pass. The 
+//   result is transposed back into the destination, so every line transform streams through 
+//   contiguous memory.
+//
+
+VN_STATUS vnTransformColumns( INOUT INT32 * pBlock, UINT32 uiWidth, UINT32 uiHeight, CONST CVTransformPlan & pPlan, UINT32 uiOutputCount, INT32 * pDest, UINT32 uiDestPitch, INT32 * pColumnBlock, FLOAT32 * pfWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pBlock || !pDest || !pColumnBlock || !pfWorkspace || uiHeight != pPlan.m_uiCount || uiOutputCount > uiHeight || uiDestPitch < uiWidth )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( g_bStridedTransformColumns )
+    {
+        return vnTransformColumnsStrided( pBlock, uiWidth, pPlan, uiOutputCount, pDest, uiDestPitch, pfWorkspace );
+    }
+
+    if ( g_pTransformKernels.m_pfnColumnGroup && ( pPlan.IsFixedPoint() || vnUseDirectTransform( pPlan, uiOutputCount ) ) )
+    {
+        for ( UINT32 i = 0; i < uiWidth; i += VN_TRANSFORM_VECTOR_WIDTH )
+        {
+            UINT32 uiGroupWidth = VN_MIN2( VN_TRANSFORM_VECTOR_WIDTH, uiWidth - i );
+
+            if ( VN_TRANSFORM_VECTOR_WIDTH == uiGroupWidth && g_pTransformKernels.m_pfnColumnGroup( pBlock + i, uiWidth, pPlan, uiOutputCount, pDest + i, uiDestPitch ) )
+            {
+                continue;
+            }
+
+            //
+            // Partial groups, and groups that require 64 bit accumulation, fall back to strided
+            // line transforms.
+            //
+
+            for ( UINT32 j = i; j < i + uiGroupWidth; j++ )
+            {
+                if ( VN_FAILED( vnTransformLine( pBlock + j, uiWidth, pPlan, uiOutputCount, pDest + j, uiDestPitch, pfWorkspace ) ) )
+                {
+                    return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+                }
+            }
+        }
+
+        return VN_SUCCESS;
+    }
+
+    //
+    // The vertical pass writes its ( uiOutputCount x uiWidth ) result back over the block, which 
+    // is no longer needed once transposed.
+    //
+
+    vnTransposeBlock( pBlock, uiWidth, uiWidth, uiHeight, pColumnBlock, uiHeight );
+
+    for ( UINT32 i = 0; i < uiWidth; i++ )
+    {
+        INT32 * pSrcLine  = pColumnBlock + i * uiHeight;
+        INT32 * pDestLine = pBlock + i * uiOutputCount;
+
+        if ( VN_FAILED( vnTransformLine( pSrcLine, 1, pPlan, uiOutputCount, pDestLine, 1, pfWorkspace ) ) )
+        {
+            return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        }
+    }
+
+    return vnTransposeBlock( pBlock, uiOutputCount, uiOutputCount, uiWidth, pDest, uiDestPitch );
+}
+
+//
+// vnQueryTransformFormat
+//
+//   Returns the format of the coefficients produced by transforming an 8 bit image with the 
+//   given plans. Compact transforms produce R16S coefficients whenever all of them are certain
+//   to fit. Our row pass produces values of at most 255 times the largest basis norm of the row 
+//   plan (plus a unit of rounding), and the column pass scales those by its own basis norm.
+//
+
+VN_IMAGE_FORMAT vnQueryTransformFormat( CONST CVTransformPlan & pRowPlan, CONST CVTransformPlan & pColumnPlan, VN_IMAGE_TRANSFORM_FLAGS uiFlags )
+{
+    if ( !( uiFlags & VN_IMAGE_TRANSFORM_COMPACT ) || 0 == pRowPlan.m_fBasisNorm || 0 == pColumnPlan.m_fBasisNorm )
+    {
+        return VN_IMAGE_FORMAT_R32S;
+    }
+
+    FLOAT64 fMaxRowValue = 255.0 * pRowPlan.m_fBasisNorm + 1.0;
+    FLOAT64 fMaxValue    = fMaxRowValue * pColumnPlan.m_fBasisNorm + 1.0;
+
+    return ( fMaxValue <= VN_MAX_INT16 ? VN_IMAGE_FORMAT_R16S : VN_IMAGE_FORMAT_R32S );
+}
+
+//
+// vnStoreCoefficientBlock
+//
+//   Copies a packed ( uiWidth x uiHeight ) block of coefficients into pDest, narrowing them if
+//   pDest uses the compact R16S format.
+//
+
+VN_TEMPLATE_T VOID vnStoreCoefficientBlock( CONST T * pBlock, UINT32 uiWidth, UINT32 uiHeight, CVImage * pDest )
+{
+    for ( UINT32 j = 0; j < uiHeight; j++ )
+    {
+        UINT8 * pDestLine   = pDest->QueryData() + pDest->BlockOffset( 0, j );
+        CONST T * pSrcLine  = pBlock + j * uiWidth;
+
+        if ( VN_IMAGE_FORMAT_R16S == pDest->QueryFormat() )
+        {
+            for ( UINT32 i = 0; i < uiWidth; i++ )
+            {
+                reinterpret_cast<INT16 *>( pDestLine )[ i ] = (INT16) pSrcLine[ i ];
+            }
+        }
+        else
+        {
+            for ( UINT32 i = 0; i < uiWidth; i++ )
+            {
+                reinterpret_cast<INT32 *>( pDestLine )[ i ] = (INT32) pSrcLine[ i ];
+            }
+        }
+    }
+}
+
+//
+// vnTransformImageBlock
+//
+//   Computes the upper left ( uiBlockWidth x uiBlockHeight ) coefficients of the DCT-II of 
+//   pSrcImage. The row pass only produces uiBlockWidth coefficients per row, and the column
+//   pass only visits those columns, so pruned blocks cost a fraction of the full transform.
+//
+
+VN_STATUS vnTransformImageBlock( CONST CVImage & pSrcImage, UINT32 uiBlockWidth, UINT32 uiBlockHeight, VN_IMAGE_TRANSFORM_FLAGS uiFlags, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+	{
+		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pOutput || &pSrcImage == pOutput || &pSrcImage == pWorkspace || pOutput == pWorkspace )
+		{
+			return vnPostError( VN_ERROR_INVALIDARG );
+		}
+
+        if ( 0 == uiBlockWidth || 0 == uiBlockHeight || uiBlockWidth > pSrcImage.QueryWidth() || uiBlockHeight > pSrcImage.QueryHeight() )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+	}
+
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_TRANSFORM, VN_IMAGE_PIXEL_BYTES( pSrcImage ) + (UINT64) uiBlockWidth * uiBlockHeight * sizeof( INT32 ) );
+
+    CONST CVTransformPlan * pRowPlan    = NULL;
+    CONST CVTransformPlan * pColumnPlan = NULL;
+
+    if ( VN_FAILED( vnAcquireTransformPlan( pSrcImage.QueryWidth(), uiFlags, &pRowPlan ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( VN_FAILED( vnAcquireTransformPlan( pSrcImage.QueryHeight(), uiFlags, &pColumnPlan ) ) )
+    {
+        vnReleaseTransformPlan( pRowPlan );
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    //
+    // Our scratch block holds two intermediate images of ( uiBlockWidth x height ) coefficients,
+    // followed by the working space required by our line transforms. Compact outputs also need
+    // a full precision copy of the final block, which we narrow into the destination. The block
+    // lives within the caller's workspace image, if one is provided. Sizes are computed in 64 
+    // bits, and must fit a single R32S workspace row as well as the address space of the build.
+    //
+
+    VN_IMAGE_FORMAT uiFormat = vnQueryTransformFormat( *pRowPlan, *pColumnPlan, uiFlags );
+    UINT32 uiHeight          = pSrcImage.QueryHeight();
+    UINT64 uiBlockSize       = (UINT64) uiBlockWidth * uiHeight;
+    UINT64 uiWorkspaceSize   = (UINT64) VN_MAX2( pSrcImage.QueryWidth(), uiHeight ) << 1;
+    UINT64 uiCompactSize     = ( VN_IMAGE_FORMAT_R16S == uiFormat ? (UINT64) uiBlockWidth * uiBlockHeight : 0 );
+    UINT64 uiScratchSize     = ( uiBlockSize << 1 ) + uiWorkspaceSize + uiCompactSize;
+    INT32 * pOwnedBlock      = NULL;
+    INT32 * pScratchBlock    = NULL;
+
+    if ( uiScratchSize > VN_MAX_UINT32 / sizeof( INT32 ) || uiScratchSize * sizeof( INT32 ) != (SIZE_T) ( uiScratchSize * sizeof( INT32 ) ) )
+    {
+        vnReleaseTransformPlan( pRowPlan );
+        vnReleaseTransformPlan( pColumnPlan );
+
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    if ( !pWorkspace )
+    {
+        pOwnedBlock   = new INT32[ (SIZE_T) uiScratchSize ];
+        pScratchBlock = pOwnedBlock;
+    }
+    else if ( VN_SUCCEEDED( vnReshapeImage( VN_IMAGE_FORMAT_R32S, (UINT32) uiScratchSize, 1, pWorkspace ) ) )
+    {
+        pScratchBlock = reinterpret_cast<INT32 *>( pWorkspace->QueryData() );
+    }
+
+    INT32 * pRowBlock        = pScratchBlock;
+    INT32 * pColumnBlock     = pScratchBlock + uiBlockSize;
+    FLOAT32 * pfWorkspace    = reinterpret_cast<FLOAT32 *>( pScratchBlock + ( uiBlockSize << 1 ) );
+    INT32 * pCompactBlock    = pScratchBlock + ( uiBlockSize << 1 ) + uiWorkspaceSize;
+
+    if ( !pScratchBlock )
+    {
+        vnReleaseTransformPlan( pRowPlan );
+        vnReleaseTransformPlan( pColumnPlan );
+
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    //
+    // Shape our destination image as a single channel 32 bit (or compact 16 bit) format.
+    //
+
+    if ( VN_FAILED( vnReshapeImage( uiFormat, uiBlockWidth, uiBlockHeight, pOutput ) ) )
+    {
+        delete [] pOwnedBlock;
+
+        vnReleaseTransformPlan( pRowPlan );
+        vnReleaseTransformPlan( pColumnPlan );
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    //
+	// Horizontal DCT-II, producing a ( uiBlockWidth x uiHeight ) row block.
+	//
+
+	for ( UINT32 j = 0; j < uiHeight; j++ )
+	{
+        UINT8 * pSrcLine  = pSrcImage.QueryData() + pSrcImage.BlockOffset( 0, j );
+        INT32 * pDestLine = pRowBlock + (UINT64) j * uiBlockWidth;
+
+		if ( VN_FAILED( vnTransformLine( pSrcLine, 1, *pRowPlan, uiBlockWidth, pDestLine, 1, pfWorkspace ) ) )
+		{
+            delete [] pOwnedBlock;
+
+            vnReleaseTransformPlan( pRowPlan );
+            vnReleaseTransformPlan( pColumnPlan );
+
+			return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+		}
+	}
+
+	//
+	// Vertical DCT-II
+	//
+
+    INT32 * pDestBlock = reinterpret_cast<INT32 *>( pOutput->QueryData() );
+    UINT32 uiDestPitch = pOutput->RowPitch() / sizeof( INT32 );
+
+    if ( uiCompactSize )
+    {
+        pDestBlock  = pCompactBlock;
+        uiDestPitch = uiBlockWidth;
+    }
+
+    if ( VN_FAILED( vnTransformColumns( pRowBlock, uiBlockWidth, uiHeight, *pColumnPlan, uiBlockHeight, pDestBlock, uiDestPitch, pColumnBlock, pfWorkspace ) ) )
+    {
+        delete [] pOwnedBlock;
+
+        vnReleaseTransformPlan( pRowPlan );
+        vnReleaseTransformPlan( pColumnPlan );
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( uiCompactSize )
+    {
+        vnStoreCoefficientBlock( pCompactBlock, uiBlockWidth, uiBlockHeight, pOutput );
+    }
+
+    //
+    // Cleanup
+    //
+
+    delete [] pOwnedBlock;
+
+    vnReleaseTransformPlan( pRowPlan );
+    vnReleaseTransformPlan( pColumnPlan );
+
+	return VN_SUCCESS;
+}
+
+VN_STATUS vnTransformImageBlock( CONST CVImage & pSrcImage, UINT32 uiBlockWidth, UINT32 uiBlockHeight, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** pOutput )
+{
+    if ( VN_PARAM_CHECK )
+	{
+		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pOutput )
+		{
+			return vnPostError( VN_ERROR_INVALIDARG );
+		}
+	}
+
+    //
+    // Our output is reshaped to its final (possibly compact) format by the transform, which
+    // never requires more memory than a full precision block.
+    //
+
+    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R32S, uiBlockWidth, uiBlockHeight, pOutput ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( VN_FAILED( vnTransformImageBlock( pSrcImage, uiBlockWidth, uiBlockHeight, uiFlags, *pOutput, NULL ) ) )
+    {
+        vnDestroyImage( *pOutput );
+
+        (*pOutput) = NULL;
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** pOutput )
+{
+    if ( VN_PARAM_CHECK )
+	{
+		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pOutput )
+		{
+			return vnPostError( VN_ERROR_INVALIDARG );
+		}
+	}
+
+    return vnTransformImageBlock( pSrcImage, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), uiFlags, pOutput );
+}
+
+VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, VN_IMAGE_TRANSFORM_FLAGS uiFlags, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+	{
+		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || !pOutput )
+		{
+			return vnPostError( VN_ERROR_INVALIDARG );
+		}
+	}
+
+    return vnTransformImageBlock( pSrcImage, pSrcImage.QueryWidth(), pSrcImage.QueryHeight(), uiFlags, pOutput, pWorkspace );
+}
+
+VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, OUT CVImage ** pOutput )
+{
+    return vnTransformImage( pSrcImage, VN_IMAGE_TRANSFORM_DEFAULT, pOutput );
+}
+
+VN_STATUS vnTransformImageLowFrequency( CONST CVImage & pSrcImage, UINT32 uiBlockSize, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** pOutput )
+{
+    if ( VN_PARAM_CHECK )
+	{
+		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || 0 == uiBlockSize || !pOutput )
+		{
+			return vnPostError( VN_ERROR_INVALIDARG );
+		}
+	}
+
+    UINT32 uiBlockWidth  = VN_MIN2( uiBlockSize, pSrcImage.QueryWidth() );
+    UINT32 uiBlockHeight = VN_MIN2( uiBlockSize, pSrcImage.QueryHeight() );
+
+    return vnTransformImageBlock( pSrcImage, uiBlockWidth, uiBlockHeight, uiFlags, pOutput );
+}
+
+VN_STATUS vnTransformImageLowFrequency( CONST CVImage & pSrcImage, UINT32 uiBlockSize, VN_IMAGE_TRANSFORM_FLAGS uiFlags, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace )
+{
+    if ( VN_PARAM_CHECK )
+	{
+		if ( !VN_IS_IMAGE_VALID( pSrcImage ) || 0 == uiBlockSize || !pOutput )
+		{
+			return vnPostError( VN_ERROR_INVALIDARG );
+		}
+	}
+
+    UINT32 uiBlockWidth  = VN_MIN2( uiBlockSize, pSrcImage.QueryWidth() );
+    UINT32 uiBlockHeight = VN_MIN2( uiBlockSize, pSrcImage.QueryHeight() );
+
+    return vnTransformImageBlock( pSrcImage, uiBlockWidth, uiBlockHeight, uiFlags, pOutput, pWorkspace );
+}
+
+VN_STATUS vnTransformImageLowFrequency( CONST CVImage & pSrcImage, UINT32 uiBlockSize, OUT CVImage ** pOutput )
+{
+    return vnTransformImageLowFrequency( pSrcImage, uiBlockSize, VN_IMAGE_TRANSFORM_DEFAULT, pOutput );
+}
+
+VN_STATUS vnQueryTransformBasis( UINT32 uiCount, OUT CONST INT32 ** ppBasis )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( 0 == uiCount || !ppBasis )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    //
+    // Only cached plans are guaranteed to outlive this call, so we refuse larger lengths
+    // rather than hand out a basis that would have to be released.
+    //
+
+    CONST CVTransformPlan * pPlan = NULL;
+
+    if ( uiCount > VN_TRANSFORM_MAX_CACHED_PLAN_SIZE )
+    {
+        return vnPostError( VN_ERROR_INVALIDARG );
+    }
+
+    if ( VN_FAILED( vnAcquireTransformPlan( uiCount, VN_IMAGE_TRANSFORM_FIXED_POINT, &pPlan ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    (*ppBasis) = pPlan->m_piFixedBasis;
+
+    return VN_SUCCESS;
+}
+
+//
+// vnResolveCoefficient
+//
+//   Converts an accumulated coefficient into its final integer form, exactly as our line
+//   transforms do for floating point and fixed point plans respectively.
+//
+
+inline INT32 vnResolveCoefficient( FLOAT32 fValue ) { return (INT32) fValue; }
+inline INT32 vnResolveCoefficient( INT32 iValue ) { return vnFixedPointRound( iValue ); }
+
+template < UINT32 LEVEL >
+VOID vnResolveCoefficients( INOUT FLOAT32 * pfValues, UINT32 uiCount )
+{
+    UINT32 i = 0;
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( VN_CPU_LEVEL_SCALAR != LEVEL )
+    {
+        for ( ; i + VN_TRANSFORM_VECTOR_WIDTH <= uiCount; i += VN_TRANSFORM_VECTOR_WIDTH )
+        {
+            vnStoreFloat32x8( pfValues + i, vnConvertInt32x8( vnTruncateFloat32x8( vnLoadFloat32x8< LEVEL >( pfValues + i ) ) ) );
+        }
+    }
+
+#endif
+
+    for ( ; i < uiCount; i++ )
+    {
+        pfValues[ i ] = vnResolveCoefficient( pfValues[ i ] );
+    }
+}
+
+template < UINT32 LEVEL >
+VOID vnResolveCoefficients( INOUT INT32 * piValues, UINT32 uiCount )
+{
+    UINT32 i = 0;
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( VN_CPU_LEVEL_SCALAR != LEVEL )
+    {
+        for ( ; i + VN_TRANSFORM_VECTOR_WIDTH <= uiCount; i += VN_TRANSFORM_VECTOR_WIDTH )
+        {
+            vnStoreInt32x8( piValues + i, vnFixedPointRoundInt32x8( vnLoadInt32x8< LEVEL >( piValues + i ) ) );
+        }
+    }
+
+#endif
+
+    for ( ; i < uiCount; i++ )
+    {
+        piValues[ i ] = vnResolveCoefficient( piValues[ i ] );
+    }
+}
+
+VN_TEMPLATE_T VOID vnMultiplyMatrixEdge( CONST T * pA, UINT32 uiPitchA, CONST T * pB, UINT32 uiPitchB, T * pC, UINT32 uiPitchC, UINT32 uiRows, UINT32 uiColumns, UINT32 uiDepth, BOOL bAccumulate )
+{
+    for ( UINT32 i = 0; i < uiRows; i++ )
+    for ( UINT32 j = 0; j < uiColumns; j++ )
+    {
+        T tTotal = ( bAccumulate ? pC[ i * uiPitchC + j ] : 0 );
+
+        for ( UINT32 k = 0; k < uiDepth; k++ )
+        {
+            tTotal += pA[ i * uiPitchA + k ] * pB[ k * uiPitchB + j ];
+        }
+
+        pC[ i * uiPitchC + j ] = tTotal;
+    }
+}
+
+template < class T, UINT32 LEVEL >
+VOID vnMultiplyMatrixBlock( CONST T * pA, UINT32 uiPitchA, CONST T * pB, UINT32 uiPitchB, T * pC, UINT32 uiPitchC, UINT32 uiDepth, BOOL bAccumulate )
+{
+    //
+    // Evaluates a single ( VN_TRANSFORM_MATRIX_ROW_BLOCK x VN_TRANSFORM_MATRIX_COLUMN_BLOCK ) block
+    // of the product, which is held in registers for the duration of the depth tile. Each row of B
+    // is loaded once and shared by every row of the block.
+    //
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( VN_CPU_LEVEL_SCALAR != LEVEL )
+    {
+        typename CVVectorType< T, LEVEL >::TYPE vTotal[ VN_TRANSFORM_MATRIX_ROW_BLOCK ];
+
+        for ( UINT32 i = 0; i < VN_TRANSFORM_MATRIX_ROW_BLOCK; i++ )
+        {
+            vTotal[ i ] = ( bAccumulate ? vnLoadVector< LEVEL >( pC + i * uiPitchC ) : vnSplatVector< LEVEL >( (T) 0 ) );
+        }
+
+        for ( UINT32 k = 0; k < uiDepth; k++ )
+        {
+            typename CVVectorType< T, LEVEL >::TYPE vRow = vnLoadVector< LEVEL >( pB + k * uiPitchB );
+
+            vTotal[ 0 ] = vnMultiplyAddVector( vTotal[ 0 ], vnSplatVector< LEVEL >( pA[ 0 * uiPitchA + k ] ), vRow );
+            vTotal[ 1 ] = vnMultiplyAddVector( vTotal[ 1 ], vnSplatVector< LEVEL >( pA[ 1 * uiPitchA + k ] ), vRow );
+            vTotal[ 2 ] = vnMultiplyAddVector( vTotal[ 2 ], vnSplatVector< LEVEL >( pA[ 2 * uiPitchA + k ] ), vRow );
+            vTotal[ 3 ] = vnMultiplyAddVector( vTotal[ 3 ], vnSplatVector< LEVEL >( pA[ 3 * uiPitchA + k ] ), vRow );
+        }
+
+        for ( UINT32 i = 0; i < VN_TRANSFORM_MATRIX_ROW_BLOCK; i++ )
+        {
+            vnStoreVector( pC + i * uiPitchC, vTotal[ i ] );
+        }
+
+        return;
+    }
+
+#endif
+
+    T tTotal[ VN_TRANSFORM_MATRIX_ROW_BLOCK ][ VN_TRANSFORM_MATRIX_COLUMN_BLOCK( VN_CPU_LEVEL_SCALAR ) ];
+
+    for ( UINT32 i = 0; i < VN_TRANSFORM_MATRIX_ROW_BLOCK; i++ )
+    for ( UINT32 j = 0; j < VN_TRANSFORM_MATRIX_COLUMN_BLOCK( VN_CPU_LEVEL_SCALAR ); j++ )
+    {
+        tTotal[ i ][ j ] = ( bAccumulate ? pC[ i * uiPitchC + j ] : 0 );
+    }
+
+    for ( UINT32 k = 0; k < uiDepth; k++ )
+    {
+        CONST T * pRow = pB + k * uiPitchB;
+
+        for ( UINT32 i = 0; i < VN_TRANSFORM_MATRIX_ROW_BLOCK; i++ )
+        {
+            T tValue = pA[ i * uiPitchA + k ];
+
+            tTotal[ i ][ 0 ] += tValue * pRow[ 0 ];
+            tTotal[ i ][ 1 ] += tValue * pRow[ 1 ];
+            tTotal[ i ][ 2 ] += tValue * pRow[ 2 ];
+            tTotal[ i ][ 3 ] += tValue * pRow[ 3 ];
+        }
+    }
+
+    for ( UINT32 i = 0; i < VN_TRANSFORM_MATRIX_ROW_BLOCK; i++ )
+    for ( UINT32 j = 0; j < VN_TRANSFORM_MATRIX_COLUMN_BLOCK( VN_CPU_LEVEL_SCALAR ); j++ )
+    {
+        pC[ i * uiPitchC + j ] = tTotal[ i ][ j ];
+    }
+}
+
+//
+// vnMultiplyMatrix
+//
+//   Computes C = A * B for the row major matrices A ( uiRows x uiDepth ), B ( uiDepth x uiColumns )
+//   and C ( uiRows x uiColumns ). Pitches are specified in elements. We walk the depth in tiles so 
+//   that the active panel of B stays resident in the L1 cache while every row of A streams past
+//   it. Integer products must be known to fit within 32 bits.
+//
+
+template < class T, UINT32 LEVEL >
+VOID vnMultiplyMatrix( CONST T * pA, UINT32 uiPitchA, CONST T * pB, UINT32 uiPitchB, T * pC, UINT32 uiPitchC, UINT32 uiRows, UINT32 uiColumns, UINT32 uiDepth )
+{
+    UINT32 uiBlockRows    = uiRows - uiRows % VN_TRANSFORM_MATRIX_ROW_BLOCK;
+    UINT32 uiBlockColumns = uiColumns - uiColumns % VN_TRANSFORM_MATRIX_COLUMN_BLOCK( LEVEL );
+
+    for ( UINT32 kk = 0; kk < uiDepth; kk += VN_TRANSFORM_MATRIX_DEPTH_TILE )
+    {
+        UINT32 uiTileDepth = VN_MIN2( VN_TRANSFORM_MATRIX_DEPTH_TILE, uiDepth - kk );
+        BOOL bAccumulate   = ( 0 != kk );
+        CONST T * pTileA   = pA + kk;
+        CONST T * pTileB   = pB + kk * uiPitchB;
+
+        for ( UINT32 i = 0; i < uiBlockRows; i += VN_TRANSFORM_MATRIX_ROW_BLOCK )
+        for ( UINT32 j = 0; j < uiBlockColumns; j += VN_TRANSFORM_MATRIX_COLUMN_BLOCK( LEVEL ) )
+        {
+            vnMultiplyMatrixBlock< T, LEVEL >( pTileA + i * uiPitchA, uiPitchA, pTileB + j, uiPitchB, pC + i * uiPitchC + j, uiPitchC, uiTileDepth, bAccumulate );
+        }
+
+        //
+        // Evaluate the remaining columns of our blocked rows, followed by any remaining rows.
+        //
+
+        vnMultiplyMatrixEdge( pTileA, uiPitchA, pTileB + uiBlockColumns, uiPitchB, pC + uiBlockColumns, uiPitchC, uiBlockRows, uiColumns - uiBlockColumns, uiTileDepth, bAccumulate );
+        vnMultiplyMatrixEdge( pTileA + uiBlockRows * uiPitchA, uiPitchA, pTileB, uiPitchB, pC + uiBlockRows * uiPitchC, uiPitchC, uiRows - uiBlockRows, uiColumns, uiTileDepth, bAccumulate );
+    }
+}
+
+//
+// vnTransformBatchRowGroup
+//
+//   Evaluates eight adjacent row coefficients of VN_TRANSFORM_MATRIX_ROW_BLOCK stacked lines 
+//   (or of a single line), exactly as vnTransformLineDirectVector evaluates them: the products of
+//   even and odd samples accumulate in separate sums that are added before truncation. Every 
+//   line shares each load of the packed basis.
+//
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+template < UINT32 LEVEL, UINT32 LINES >
+VOID vnTransformBatchRowGroup( CONST FLOAT32 * pStack, UINT32 uiWidth, CONST FLOAT32 * pRowPanel, UINT32 uiBlockWidth, FLOAT32 * pRows )
+{
+    typedef typename CVTransformVector< LEVEL >::FLOAT32X8 VN_FLOAT32X8;
+
+    VN_FLOAT32X8 vEven[ VN_TRANSFORM_MATRIX_ROW_BLOCK ];
+    VN_FLOAT32X8 vOdd[ VN_TRANSFORM_MATRIX_ROW_BLOCK ];
+    UINT32 k = 0;
+
+    for ( UINT32 j = 0; j < VN_TRANSFORM_MATRIX_ROW_BLOCK; j++ )
+    {
+        vEven[ j ] = vnZeroFloat32x8< LEVEL >();
+        vOdd[ j ]  = vnZeroFloat32x8< LEVEL >();
+    }
+
+    for ( ; k + 2 <= uiWidth; k += 2 )
+    {
+        VN_FLOAT32X8 vEvenBasis = vnLoadFloat32x8< LEVEL >( pRowPanel + ( k + 0 ) * uiBlockWidth );
+        VN_FLOAT32X8 vOddBasis  = vnLoadFloat32x8< LEVEL >( pRowPanel + ( k + 1 ) * uiBlockWidth );
+
+        vEven[ 0 ] = vnMultiplyAddFloat32x8( vEven[ 0 ], vnSplatFloat32x8< LEVEL >( pStack[ k + 0 ] ), vEvenBasis );
+        vOdd[ 0 ]  = vnMultiplyAddFloat32x8( vOdd[ 0 ], vnSplatFloat32x8< LEVEL >( pStack[ k + 1 ] ), vOddBasis );
+
+        if ( LINES > 1 )
+        {
+            vEven[ 1 ] = vnMultiplyAddFloat32x8( vEven[ 1 ], vnSplatFloat32x8< LEVEL >( pStack[ 1 * uiWidth + k + 0 ] ), vEvenBasis );
+            vOdd[ 1 ]  = vnMultiplyAddFloat32x8( vOdd[ 1 ], vnSplatFloat32x8< LEVEL >( pStack[ 1 * uiWidth + k + 1 ] ), vOddBasis );
+            vEven[ 2 ] = vnMultiplyAddFloat32x8( vEven[ 2 ], vnSplatFloat32x8< LEVEL >( pStack[ 2 * uiWidth + k + 0 ] ), vEvenBasis );
+            vOdd[ 2 ]  = vnMultiplyAddFloat32x8( vOdd[ 2 ], vnSplatFloat32x8< LEVEL >( pStack[ 2 * uiWidth + k + 1 ] ), vOddBasis );
+            vEven[ 3 ] = vnMultiplyAddFloat32x8( vEven[ 3 ], vnSplatFloat32x8< LEVEL >( pStack[ 3 * uiWidth + k + 0 ] ), vEvenBasis );
+            vOdd[ 3 ]  = vnMultiplyAddFloat32x8( vOdd[ 3 ], vnSplatFloat32x8< LEVEL >( pStack[ 3 * uiWidth + k + 1 ] ), vOddBasis );
+        }
+    }
+
+    for ( ; k < uiWidth; k++ )
+    {
+        VN_FLOAT32X8 vEvenBasis = vnLoadFloat32x8< LEVEL >( pRowPanel + k * uiBlockWidth );
+
+        for ( UINT32 j = 0; j < LINES; j++ )
+        {
+            vEven[ j ] = vnMultiplyAddFloat32x8( vEven[ j ], vnSplatFloat32x8< LEVEL >( pStack[ j * uiWidth + k ] ), vEvenBasis );
+        }
+    }
+
+    for ( UINT32 j = 0; j < LINES; j++ )
+    {
+        vnStoreFloat32x8( pRows + j * uiBlockWidth, vnConvertInt32x8( vnTruncateFloat32x8( vnAddFloat32x8( vEven[ j ], vOdd[ j ] ) ) ) );
+    }
+}
+
+#endif
+
+//
+// vnTransformBatchRows
+//
+//   Evaluates the row pass of a batch: the first uiBlockWidth coefficients of uiLineCount stacked
+//   lines, resolved to integers. pRowPanel holds the row basis packed as ( uiWidth x uiBlockWidth ).
+//   Fixed point rows are a single matrix product. Float rows must reproduce the coefficients of
+//   our line kernels exactly, since a single unit of difference before the column pass may grow
+//   to several units after it. They therefore sum their products in the same order as the line
+//   kernel of their level.
+//
+
+template < UINT32 LEVEL >
+VOID vnTransformBatchRows( CONST INT32 * pStack, UINT32 uiWidth, UINT32 uiLineCount, CONST INT32 * pRowPanel, UINT32 uiBlockWidth, INT32 * pRows )
+{
+    vnMultiplyMatrix< INT32, LEVEL >( pStack, uiWidth, pRowPanel, uiBlockWidth, pRows, uiBlockWidth, uiLineCount, uiBlockWidth, uiWidth );
+
+    vnResolveCoefficients< LEVEL >( pRows, uiLineCount * uiBlockWidth );
+}
+
+template < UINT32 LEVEL >
+VOID vnTransformBatchRows( CONST FLOAT32 * pStack, UINT32 uiWidth, UINT32 uiLineCount, CONST FLOAT32 * pRowPanel, UINT32 uiBlockWidth, FLOAT32 * pRows )
+{
+    UINT32 i = 0;
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( VN_CPU_LEVEL_SCALAR != LEVEL )
+    {
+        for ( ; i + VN_TRANSFORM_VECTOR_WIDTH <= uiBlockWidth; i += VN_TRANSFORM_VECTOR_WIDTH )
+        {
+            UINT32 j = 0;
+
+            for ( ; j + VN_TRANSFORM_MATRIX_ROW_BLOCK <= uiLineCount; j += VN_TRANSFORM_MATRIX_ROW_BLOCK )
+            {
+                vnTransformBatchRowGroup< LEVEL, VN_TRANSFORM_MATRIX_ROW_BLOCK >( pStack + j * uiWidth, uiWidth, pRowPanel + i, uiBlockWidth, pRows + j * uiBlockWidth + i );
+            }
+
+            for ( ; j < uiLineCount; j++ )
+            {
+                vnTransformBatchRowGroup< LEVEL, 1 >( pStack + j * uiWidth, uiWidth, pRowPanel + i, uiBlockWidth, pRows + j * uiBlockWidth + i );
+            }
+        }
+
+        //
+        // Any remaining coefficients are single dot products, as in vnTransformLineDirectVector.
+        //
+
+        for ( UINT32 j = 0; j < uiLineCount; j++ )
+        {
+            for ( UINT32 ii = i; ii < uiBlockWidth; ii++ )
+            {
+                CONST FLOAT32 * pfLine = pStack + j * uiWidth;
+                FLOAT32 fTotal         = 0.0f;
+
+                for ( UINT32 k = 0; k < uiWidth; k++ )
+                {
+                    fTotal += pfLine[ k ] * pRowPanel[ k * uiBlockWidth + ii ];
+                }
+
+                pRows[ j * uiBlockWidth + ii ] = (FLOAT32) vnResolveCoefficient( fTotal );
+            }
+        }
+
+        return;
+    }
+
+#endif
+
+    //
+    // Scalar rows keep four partial sums, exactly as vnTransformLineDirect does.
+    //
+
+    for ( UINT32 j = 0; j < uiLineCount; j++ )
+    {
+        CONST FLOAT32 * pfLine = pStack + j * uiWidth;
+
+        for ( i = 0; i < uiBlockWidth; i++ )
+        {
+            FLOAT32 fTotal[ 4 ] = { 0 };
+            UINT32 k            = 0;
+
+            for ( ; k + 4 <= uiWidth; k += 4 )
+            {
+                fTotal[ 0 ] += pfLine[ k + 0 ] * pRowPanel[ ( k + 0 ) * uiBlockWidth + i ];
+                fTotal[ 1 ] += pfLine[ k + 1 ] * pRowPanel[ ( k + 1 ) * uiBlockWidth + i ];
+                fTotal[ 2 ] += pfLine[ k + 2 ] * pRowPanel[ ( k + 2 ) * uiBlockWidth + i ];
+                fTotal[ 3 ] += pfLine[ k + 3 ] * pRowPanel[ ( k + 3 ) * uiBlockWidth + i ];
+            }
+
+            for ( ; k < uiWidth; k++ )
+            {
+                fTotal[ 0 ] += pfLine[ k ] * pRowPanel[ k * uiBlockWidth + i ];
+            }
+
+            pRows[ j * uiBlockWidth + i ] = (FLOAT32) vnResolveCoefficient( ( fTotal[ 0 ] + fTotal[ 1 ] ) + ( fTotal[ 2 ] + fTotal[ 3 ] ) );
+        }
+    }
+}
+
+//
+// vnTransformImageBatchBlocks
+//
+//   Computes the upper left ( uiBlockWidth x uiBlockHeight ) coefficients of a batch of equally
+//   sized images as a pair of matrix products. The row pass multiplies the stacked lines of every
+//   image in a chunk by a packed ( width x uiBlockWidth ) panel of the row basis. The column pass
+//   then multiplies the leading uiBlockHeight rows of the column basis by the row coefficients
+//   of each image. Intermediate coefficients are resolved to integers between the two passes,
+//   exactly as they are by vnTransformImageBlock.
+//
+
+template < class T, UINT32 LEVEL >
+VN_STATUS vnTransformImageBatchBlocks( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockWidth, UINT32 uiBlockHeight, CONST T * pRowBasis, CONST T * pColumnBasis, VN_IMAGE_FORMAT uiFormat, OUT CVImage ** ppOutputs )
+{
+    UINT32 uiWidth      = ppSrcImages[ 0 ]->QueryWidth();
+    UINT32 uiHeight     = ppSrcImages[ 0 ]->QueryHeight();
+    UINT32 uiChunkCount = VN_MIN2( uiImageCount, VN_MAX2( 1, VN_TRANSFORM_BATCH_CHUNK_SIZE / ( uiWidth * uiHeight * sizeof( T ) ) ) );
+
+    //
+    // Our scratch space holds the packed row basis, the stacked lines and row coefficients of a 
+    // single chunk, and the column coefficients of a single image.
+    //
+
+    UINT32 uiPanelSize = uiWidth * uiBlockWidth;
+    UINT32 uiStackSize = uiChunkCount * uiHeight * uiWidth;
+    UINT32 uiRowsSize  = uiChunkCount * uiHeight * uiBlockWidth;
+    T * pScratch       = new T[ uiPanelSize + uiStackSize + uiRowsSize + uiBlockWidth * uiBlockHeight ];
+    T * pRowPanel      = pScratch;
+    T * pStack         = pRowPanel + uiPanelSize;
+    T * pRows          = pStack + uiStackSize;
+    T * pBlock         = pRows + uiRowsSize;
+
+    if ( !pScratch )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    for ( UINT32 k = 0; k < uiWidth; k++ )
+    for ( UINT32 i = 0; i < uiBlockWidth; i++ )
+    {
+        pRowPanel[ k * uiBlockWidth + i ] = pRowBasis[ i * uiWidth + k ];
+    }
+
+    for ( UINT32 uiFirst = 0; uiFirst < uiImageCount; uiFirst += uiChunkCount )
+    {
+        UINT32 uiCount = VN_MIN2( uiChunkCount, uiImageCount - uiFirst );
+
+        for ( UINT32 b = 0; b < uiCount; b++ )
+        {
+            CONST CVImage * pImage = ppSrcImages[ uiFirst + b ];
+
+            for ( UINT32 j = 0; j < uiHeight; j++ )
+            {
+                UINT8 * pSrcLine = pImage->QueryData() + pImage->BlockOffset( 0, j );
+                T * pDestLine    = pStack + ( b * uiHeight + j ) * uiWidth;
+
+                for ( UINT32 i = 0; i < uiWidth; i++ )
+                {
+                    pDestLine[ i ] = pSrcLine[ i ];
+                }
+            }
+        }
+
+        //
+        // Horizontal DCT-II of every line in the chunk.
+        //
+
+        vnTransformBatchRows< LEVEL >( pStack, uiWidth, uiCount * uiHeight, pRowPanel, uiBlockWidth, pRows );
+
+        //
+        // Vertical DCT-II of each image.
+        //
+
+        for ( UINT32 b = 0; b < uiCount; b++ )
+        {
+            CVImage ** ppOutput = ppOutputs + uiFirst + b;
+
+            if ( VN_FAILED( vnCreateImage( uiFormat, uiBlockWidth, uiBlockHeight, ppOutput ) ) )
+            {
+                delete [] pScratch;
+
+                return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+            }
+
+            vnMultiplyMatrix< T, LEVEL >( pColumnBasis, uiHeight, pRows + b * uiHeight * uiBlockWidth, uiBlockWidth, pBlock, uiBlockWidth, uiBlockHeight, uiBlockWidth, uiHeight );
+            vnResolveCoefficients< LEVEL >( pBlock, uiBlockWidth * uiBlockHeight );
+            vnStoreCoefficientBlock( pBlock, uiBlockWidth, uiBlockHeight, *ppOutput );
+        }
+    }
+
+    delete [] pScratch;
+
+    return VN_SUCCESS;
+}
+
+//
+// vnBindTransformBatchKernels
+//
+//   Returns the batch kernels that match the level of our bound line kernels. Fixed point 
+//   batches then produce coefficients identical to unbatched transforms. Float batches also 
+//   reproduce the row coefficients of unbatched transforms exactly (see vnTransformBatchRows), 
+//   but sum their column products in a different order, so their coefficients may differ by one.
+//
+
+struct CVTransformBatchKernels
+{
+    VN_STATUS ( *m_pfnBlocksFloat )( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockWidth, UINT32 uiBlockHeight, CONST FLOAT32 * pRowBasis, CONST FLOAT32 * pColumnBasis, VN_IMAGE_FORMAT uiFormat, OUT CVImage ** ppOutputs );
+    VN_STATUS ( *m_pfnBlocksFixedPoint )( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockWidth, UINT32 uiBlockHeight, CONST INT32 * pRowBasis, CONST INT32 * pColumnBasis, VN_IMAGE_FORMAT uiFormat, OUT CVImage ** ppOutputs );
+};
+
+CVTransformBatchKernels vnBindTransformBatchKernels()
+{
+    CVTransformBatchKernels pKernels = { vnTransformImageBatchBlocks< FLOAT32, VN_CPU_LEVEL_SCALAR >, vnTransformImageBatchBlocks< INT32, VN_CPU_LEVEL_SCALAR > };
+
+#if defined ( VN_TRANSFORM_USE_AVX2 )
+
+    if ( VN_CPU_LEVEL_AVX2 == g_pTransformKernels.m_uiLevel )
+    {
+        pKernels.m_pfnBlocksFloat       = vnTransformImageBatchBlocks< FLOAT32, VN_CPU_LEVEL_AVX2 >;
+        pKernels.m_pfnBlocksFixedPoint  = vnTransformImageBatchBlocks< INT32, VN_CPU_LEVEL_AVX2 >;
+    }
+
+#endif
+
+#if defined ( VN_TRANSFORM_USE_VECTOR )
+
+    if ( VN_CPU_LEVEL_SSE2 == g_pTransformKernels.m_uiLevel )
+    {
+        pKernels.m_pfnBlocksFloat       = vnTransformImageBatchBlocks< FLOAT32, VN_CPU_LEVEL_SSE2 >;
+        pKernels.m_pfnBlocksFixedPoint  = vnTransformImageBatchBlocks< INT32, VN_CPU_LEVEL_SSE2 >;
+    }
+
+#endif
+
+    return pKernels;
+}
+
+static CVTransformBatchKernels g_pTransformBatchKernels = vnBindTransformBatchKernels();
+
+VN_STATUS vnTransformImageBatchPlans( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockWidth, UINT32 uiBlockHeight, CONST CVTransformPlan & pRowPlan, CONST CVTransformPlan & pColumnPlan, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** ppOutputs )
+{
+    VN_IMAGE_FORMAT uiFormat = vnQueryTransformFormat( pRowPlan, pColumnPlan, uiFlags );
+
+    if ( pRowPlan.IsFixedPoint() )
+    {
+        //
+        // Our row pass sees at most 8 bit inputs, and its rounded output bounds that of our column 
+        // pass. If either product could overflow 32 bits then we defer to the line transforms, 
+        // which switch to 64 bit accumulation as needed.
+        //
+
+        UINT64 uiMaxRowTotal    = 255 * pRowPlan.m_uiFixedBasisNorm;
+        UINT64 uiMaxColumnTotal = ( ( uiMaxRowTotal >> VN_TRANSFORM_FIXED_POINT_SHIFT ) + 1 ) * pColumnPlan.m_uiFixedBasisNorm;
+
+        if ( uiMaxRowTotal <= VN_MAX_INT32 && uiMaxColumnTotal <= VN_MAX_INT32 )
+        {
+            return g_pTransformBatchKernels.m_pfnBlocksFixedPoint( ppSrcImages, uiImageCount, uiBlockWidth, uiBlockHeight, pRowPlan.m_piFixedBasis, pColumnPlan.m_piFixedBasis, uiFormat, ppOutputs );
+        }
+    }
+    else if ( vnUseDirectTransform( pRowPlan, uiBlockWidth ) && vnUseDirectTransform( pColumnPlan, uiBlockHeight ) )
+    {
+        return g_pTransformBatchKernels.m_pfnBlocksFloat( ppSrcImages, uiImageCount, uiBlockWidth, uiBlockHeight, pRowPlan.m_pfBasis, pColumnPlan.m_pfBasis, uiFormat, ppOutputs );
+    }
+
+    //
+    // Batches that favor the fast factorization (or that require 64 bit accumulation) are
+    // transformed one image at a time.
+    //
+
+    for ( UINT32 i = 0; i < uiImageCount; i++ )
+    {
+        if ( VN_FAILED( vnTransformImageBlock( *ppSrcImages[ i ], uiBlockWidth, uiBlockHeight, uiFlags, ppOutputs + i ) ) )
+        {
+            return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        }
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnTransformImageBatch( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockSize, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** ppOutputs )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !ppSrcImages || 0 == uiImageCount || 0 == uiBlockSize || !ppOutputs || !ppSrcImages[ 0 ] )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        for ( UINT32 i = 0; i < uiImageCount; i++ )
+        {
+            if ( !ppSrcImages[ i ] || !VN_IS_IMAGE_VALID( *ppSrcImages[ i ] ) || VN_IMAGE_FORMAT_R8 != ppSrcImages[ i ]->QueryFormat() )
+            {
+                return vnPostError( VN_ERROR_INVALIDARG );
+            }
+
+            if ( ppSrcImages[ i ]->QueryWidth() != ppSrcImages[ 0 ]->QueryWidth() || ppSrcImages[ i ]->QueryHeight() != ppSrcImages[ 0 ]->QueryHeight() )
+            {
+                return vnPostError( VN_ERROR_INVALIDARG );
+            }
+        }
+    }
+
+    CONST CVTransformPlan * pRowPlan    = NULL;
+    CONST CVTransformPlan * pColumnPlan = NULL;
+    UINT32 uiBlockWidth                 = VN_MIN2( uiBlockSize, ppSrcImages[ 0 ]->QueryWidth() );
+    UINT32 uiBlockHeight                = VN_MIN2( uiBlockSize, ppSrcImages[ 0 ]->QueryHeight() );
+
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_TRANSFORM, uiImageCount * ( VN_IMAGE_PIXEL_BYTES( *ppSrcImages[ 0 ] ) + (UINT64) uiBlockWidth * uiBlockHeight * sizeof( INT32 ) ) );
+
+    for ( UINT32 i = 0; i < uiImageCount; i++ )
+    {
+        ppOutputs[ i ] = NULL;
+    }
+
+    if ( VN_FAILED( vnAcquireTransformPlan( ppSrcImages[ 0 ]->QueryWidth(), uiFlags, &pRowPlan ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( VN_FAILED( vnAcquireTransformPlan( ppSrcImages[ 0 ]->QueryHeight(), uiFlags, &pColumnPlan ) ) )
+    {
+        vnReleaseTransformPlan( pRowPlan );
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( VN_FAILED( vnTransformImageBatchPlans( ppSrcImages, uiImageCount, uiBlockWidth, uiBlockHeight, *pRowPlan, *pColumnPlan, uiFlags, ppOutputs ) ) )
+    {
+        for ( UINT32 i = 0; i < uiImageCount; i++ )
+        {
+            vnDestroyImage( ppOutputs[ i ] );
+
+            ppOutputs[ i ] = NULL;
+        }
+
+        vnReleaseTransformPlan( pRowPlan );
+        vnReleaseTransformPlan( pColumnPlan );
+
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    vnReleaseTransformPlan( pRowPlan );
+    vnReleaseTransformPlan( pColumnPlan );
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnTransformImageBatch( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockSize, OUT CVImage ** ppOutputs )
+{
+    return vnTransformImageBatch( ppSrcImages, uiImageCount, uiBlockSize, VN_IMAGE_TRANSFORM_DEFAULT, ppOutputs );
+}
@@ -45,13 +45,52 @@
 
 #include "../Platform/vnBase.h"
 #include "../Platform/vnMath.h"
+#include "../Platform/vnAllocator.h"
+#include "../Platform/vnCpu.h"
+#include "../Platform/vnCounters.h"
+#include "../Platform/vnTrace.h"
 
 #define VN_IMAGE_FORMAT                     UINT32
 #define VN_IMAGE_FORMAT_NONE                (0x00000000)
 #define VN_IMAGE_FORMAT_R8                  (0x00200000)
 #define VN_IMAGE_FORMAT_R8G8B8              (0x00208200)
+#define VN_IMAGE_FORMAT_B8G8R8              (0x20208200)
+#define VN_IMAGE_FORMAT_R8G8B8A8            (0x00208208)
+#define VN_IMAGE_FORMAT_B8G8R8A8            (0x20208208)
+#define VN_IMAGE_FORMAT_I420                (0x40200000)
+#define VN_IMAGE_FORMAT_NV12                (0x80200000)
+#define VN_IMAGE_FORMAT_R16S                (0x10400000)
 #define VN_IMAGE_FORMAT_R32S                (0x10800000)
 
+//
+// Creation flags. Aligned images place their first row on a VN_IMAGE_ALIGNMENT byte boundary,
+// and padded images round their row pitch up to a multiple of VN_IMAGE_ALIGNMENT, so that the
+// rows of an aligned and padded image all begin on a vector (and cache line) boundary. The 
+// memory of uninitialized images is not cleared when it is allocated.
+//
+
+#define VN_IMAGE_CREATE_FLAGS               UINT32
+#define VN_IMAGE_CREATE_DEFAULT             (0x00000000)
+#define VN_IMAGE_CREATE_ALIGNED             (0x00000001)
+#define VN_IMAGE_CREATE_PADDED              (0x00000002)
+#define VN_IMAGE_CREATE_UNINITIALIZED       (0x00000004)
+
+#define VN_IMAGE_ALIGNMENT                  (64)
+
+#define VN_IMAGE_TRANSFORM_FLAGS            UINT32
+#define VN_IMAGE_TRANSFORM_DEFAULT          (0x00000000)
+#define VN_IMAGE_TRANSFORM_FIXED_POINT      (0x00000001)
+#define VN_IMAGE_TRANSFORM_COMPACT          (0x00000002)
+
+#define VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT (16)
+
+#define VN_IMAGE_RESIZE_FILTER              UINT32
+#define VN_IMAGE_RESIZE_DEFAULT             (0x00000000)
+#define VN_IMAGE_RESIZE_COVERAGE            (0x00000001)
+#define VN_IMAGE_RESIZE_FIXED_POINT         (0x00000002)
+#define VN_IMAGE_RESIZE_AREA                (0x00000003)
+#define VN_IMAGE_RESIZE_PYRAMID             (0x00000004)
+
 #define VN_IMAGE_MAX_CHANNEL_COUNT          (4)
 #define VN_IMAGE_CHANNEL_MASK               (0x3F)
 #define VN_IMAGE_CHANNEL_0_SHIFT            (0x12)
@@ -69,18 +108,59 @@
                                               ( ( (x) >> VN_IMAGE_CHANNEL_2_SHIFT ) & VN_IMAGE_CHANNEL_MASK ) + \
                                               ( ( (x) >> VN_IMAGE_CHANNEL_3_SHIFT ) & VN_IMAGE_CHANNEL_MASK ) )
 
+//
+// Format layout flags. Swizzled formats store their color channels in reverse (BGR) order. 
+// Planar 4:2:0 formats are addressed as their full resolution 8 bit Y plane, which is followed 
+// in memory by either separate U and V planes (I420) or a single interleaved UV plane (NV12),
+// each subsampled by two in both dimensions.
+//
+
+#define VN_IMAGE_FORMAT_SWIZZLE_FLAG        (0x20000000)
+#define VN_IMAGE_FORMAT_PLANAR_420_MASK     (0xC0000000)
+
+#define VN_IS_IMAGE_SWIZZLED( x )           ( 0 != ( (x) & VN_IMAGE_FORMAT_SWIZZLE_FLAG ) )
+#define VN_IS_IMAGE_PLANAR_420( x )         ( 0 != ( (x) & VN_IMAGE_FORMAT_PLANAR_420_MASK ) )
+
+#define VN_IMAGE_CHROMA_SIZE( x, w, h )     ( VN_IS_IMAGE_PLANAR_420( x ) ? (UINT64) ( ( (w) + 1 ) >> 1 ) * ( ( (h) + 1 ) >> 1 ) * 2 : 0 )
+
+//
+// Formats that carry luma, either directly (gray and Y planes) or as 8 bit color channels
+// that may be desaturated.
+//
+
+#define VN_IS_IMAGE_LUMA_PLANE( x )         ( VN_IMAGE_FORMAT_R8 == (x) || VN_IS_IMAGE_PLANAR_420( x ) )
+
+#define VN_IS_IMAGE_LUMA_FORMAT( x )        ( VN_IS_IMAGE_LUMA_PLANE( x ) ||          \
+                                              VN_IMAGE_FORMAT_R8G8B8   == (x) ||       \
+                                              VN_IMAGE_FORMAT_B8G8R8   == (x) ||       \
+                                              VN_IMAGE_FORMAT_R8G8B8A8 == (x) ||       \
+                                              VN_IMAGE_FORMAT_B8G8R8A8 == (x) )
 
 #define VN_IS_IMAGE_VALID(x)                ( (x).QueryFormat()         != VN_IMAGE_FORMAT_NONE &&  \
                                               (x).QueryBitsPerPixel()   != 0 &&                     \
                                               (x).QueryWidth()          != 0 &&                     \
                                               (x).QueryHeight()         != 0 )
 
+#define VN_IMAGE_PIXEL_BYTES(x)             ( ( (UINT64) (x).QueryWidth() * (x).QueryHeight() * (x).QueryBitsPerPixel() ) >> 3 )
+
 class VN_NONVIRTUAL CVImage
 {
     friend VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidthInBlocks, UINT32 uiHeightInBlocks, CVImage ** pOutImage );
 
+    friend VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidthInBlocks, UINT32 uiHeightInBlocks, VN_IMAGE_CREATE_FLAGS uiFlags, CVImage ** pOutImage );
+
+    friend VN_STATUS vnReshapeImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, CVImage * pImage );
+
+    friend VN_STATUS vnWrapImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT8 * pData, UINT32 uiRowPitch, CVImage ** pOutImage );
+
+    friend VN_STATUS vnWrapImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT8 * pData, UINT32 uiRowPitch, CVImage * pImage );
+
+    friend VN_STATUS vnWrapImage( CONST CVImage & pSrcImage, UINT32 uiX, UINT32 uiY, UINT32 uiWidth, UINT32 uiHeight, CVImage ** pOutImage );
+
     friend VN_STATUS vnDestroyImage( CVImage * pInImage );
 
+    friend CVImage * vnAllocateImage();
+
 private:
 
     VN_IMAGE_FORMAT             m_uiImageFormat;
@@ -98,7 +178,24 @@ private:
     UINT32                      m_uiBitsPerPixel;
     UINT8                       m_uiChannelCount;
     UINT8 *                     m_pbyDataBuffer;
-    UINT32                      m_uiDataCapacity;
+    UINT8 *                     m_pbyAllocation;        // the unaligned allocation behind m_pbyDataBuffer
+    UINT64                      m_uiDataCapacity;
+    UINT32                      m_uiRowPitch;
+    VN_IMAGE_CREATE_FLAGS       m_uiCreateFlags;
+
+    //
+    // Images may also act as views over memory that is owned by the caller (see vnWrapImage). 
+    // Views never allocate or free their data buffer, and keep the row pitch of their memory.
+    //
+
+    BOOL                        m_bExternalData;
+
+    //
+    // The allocator that provided this object and its data buffer. Images are created from 
+    // the current allocator of the creating thread (see vnSetThreadAllocator).
+    //
+
+    CVAllocator *               m_pAllocator;
 
 private:
 
@@ -106,7 +203,7 @@ private:
     // Allocation management
     //
 
-    VN_STATUS                   Allocate( UINT32 uiSize );
+    VN_STATUS                   Allocate( UINT64 uiSize );
     VN_STATUS                   Deallocate();
 
     //
@@ -119,11 +216,20 @@ private:
     //
     // SetDimension will automatically manage the memory of the object. This is the 
     // primary interface that should be used for reserving memory for the image. Note
-    // that the image must contain a valid format prior to calling SetDimension.
+    // that the image must contain a valid format prior to calling SetDimension. The
+    // existing buffer is kept whenever it is large enough for the new dimensions. The
+    // creation flags of the image apply to every allocation that it makes.
     //
    
     VN_STATUS                   SetDimension( UINT32 uiNewWidth, UINT32 uiNewHeight );
 
+    //
+    // Wrap releases any memory owned by the image and turns it into a view over pData. The
+    // image must contain a valid format prior to calling Wrap.
+    //
+
+    VN_STATUS                   Wrap( UINT8 * pData, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiRowPitch );
+
 private:
 
     CVImage();				
@@ -149,7 +255,7 @@ public:
     //
     // RowPitch is the byte delta between two adjacent rows of pixels in the image.
     // This function takes alignment into consideration and may provide a value that
-    // is greater than the byte width of the visible image. 
+    // is greater than the byte width of the visible image (e.g. for views).
     //
 
     UINT32                      RowPitch() CONST;
@@ -159,10 +265,11 @@ public:
     //
     // SlicePitch is the byte size of the entire image. This size may extend beyond the
     // edge of the last row and column of the image, due to alignment and tiling 
-    // requirements on certain platforms.
+    // requirements on certain platforms. Planar formats include their chroma planes,
+    // except for views, which only describe the Y plane.
     //
 
-    UINT32                      SlicePitch() CONST;
+    UINT64                      SlicePitch() CONST;
 
     //
     // Block Offset
@@ -172,7 +279,7 @@ public:
     // point to the start of a pixel block.
     //
 
-    UINT32                      BlockOffset( UINT32 i, UINT32 j ) CONST;
+    UINT64                      BlockOffset( UINT32 i, UINT32 j ) CONST;
 };
 
 //
@@ -182,18 +289,77 @@ public:
 // to guarantee that image creation is high-level atomic (soft RAII). Thus, the consumer is responsible
 // for allocation of the out image pointer (and the interface will manage the internal memory).
 //
+// Both the image object and its memory are acquired from the current allocator of the calling thread,
+// which is the system heap unless the thread has selected another (see vnSetThreadAllocator). 
+//
 
 VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, OUT CVImage ** pOutImage );
 
+//
+// The second form accepts VN_IMAGE_CREATE_* flags, which the image keeps for its lifetime (including
+// when it is reshaped). Padded images of planar formats only pad the rows of their Y plane; their 
+// chroma planes remain tightly packed.
+//
+
+VN_STATUS vnCreateImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, VN_IMAGE_CREATE_FLAGS uiFlags, OUT CVImage ** pOutImage );
+
 //
 // CVImage Destructor
 //
-// CVImage objects will destroy themselves automatically, but we encourage the use of this discreet
-// 'destructor' to allow for future internal memory management.
+// CVImage objects must be destroyed through this interface, which returns the object and its memory
+// to the allocator that they were created from (regardless of the calling thread).
 //
 
 VN_STATUS vnDestroyImage( INOUT CVImage * pInImage );
 
+//
+// CVImage Reshaper
+//
+// Changes the format and dimensions of an existing image. The image keeps its memory whenever that
+// memory is large enough, and only grows otherwise. This allows callers to recycle images across 
+// many operations without allocator traffic. Unlike newly created images, the contents of a 
+// reshaped image are undefined.
+//
+
+VN_STATUS vnReshapeImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pImage );
+
+//
+// CVImage Wrapper
+//
+// Creates an image view over memory that is owned by the caller, without copying it. Rows begin 
+// uiRowPitch bytes apart (or are tightly packed if uiRowPitch is zero). The second form views a 
+// ( uiWidth x uiHeight ) region of an existing image, beginning at pixel ( uiX, uiY ), and uses 
+// the row pitch of that image. The forms that accept an existing image release any memory that 
+// it owns and turn it into a view.
+//
+// Views may be passed to any operator in place of an image. The viewed memory must outlive the
+// view, and is never freed by it. Views may be reshaped, but only to dimensions that fit within
+// the rows of the viewed memory. Views of planar formats only describe their Y plane.
+//
+
+VN_STATUS vnWrapImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, IN UINT8 * pData, UINT32 uiRowPitch, OUT CVImage ** pOutImage );
+
+VN_STATUS vnWrapImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, IN UINT8 * pData, UINT32 uiRowPitch, INOUT CVImage * pImage );
+
+VN_STATUS vnWrapImage( CONST CVImage & pSrcImage, UINT32 uiX, UINT32 uiY, UINT32 uiWidth, UINT32 uiHeight, OUT CVImage ** pOutImage );
+
+VN_STATUS vnWrapImage( CONST CVImage & pSrcImage, UINT32 uiX, UINT32 uiY, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pImage );
+
+//
+// CopyImage Operator
+//
+//   CopyImage copies the contents of an image into another, reshaping the destination to match.
+//   Rows are copied individually, so that either image may be a view with its own row pitch.
+//
+// Parameters:
+// 
+//   pSrcImage:  The read-only source image to copy.
+//
+//   pDestImage: an existing image that will be reshaped to hold the copy.
+//
+
+VN_STATUS vnCopyImage( CONST CVImage & pSrcImage, INOUT CVImage * pDestImage );
+
 
 //
 // CloneImage Operator
@@ -206,7 +372,8 @@ VN_STATUS vnDestroyImage( INOUT CVImage * pInImage );
 //
 //   pDestImage: an uninitialized pointer to an image object. Upon successful
 //               return, this object will be fully initialized and contain a 
-//               clone of pSrcImage.
+//               clone of pSrcImage. The clone always owns its memory and uses 
+//               tightly packed rows, even if pSrcImage is a view.
 //
 // Supported Image Formats: 
 //    
@@ -233,30 +400,60 @@ inline VN_STATUS vnCloneImage( CONST CVImage & pSrcImage, OUT CVImage ** RESTRIC
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
-    vnCopyMemory( (*pDestImage)->QueryData(), pSrcImage.QueryData(), pSrcImage.SlicePitch() );
-
-    return VN_SUCCESS;
+    return vnCopyImage( pSrcImage, *pDestImage );
 }
 
 //
 // ResizeImage Operator
 //
-//   ResizeImage resamples the image to the specified dimensions using a simple coverage kernel.
+//   ResizeImage resamples the image to the specified dimensions using a simple coverage kernel,
+//   or (for large reductions) an area average. Only the first channel of the destination is 
+//   written.
 //
 // Parameters:
 // 
-//   pSrcImage:  The read-only source image to resize.
+//   pSrcImage:  The read-only source image to resize. Planar formats are not supported.
 //
 //   uiWidth:    The destination width to target.
 //
 //   uiHeight:   The destination height to target.
 //
+//   uiFilter:   One of the VN_IMAGE_RESIZE_* filters. VN_IMAGE_RESIZE_COVERAGE evaluates the
+//               kernel in floating point. VN_IMAGE_RESIZE_FIXED_POINT evaluates the same kernel
+//               with normalized 14 bit weights and integer sums, many samples at a time. Its
+//               results are rounded rather than truncated, and may differ slightly from those
+//               of the coverage filter. On upscales, where the total weight of each output is 
+//               small, the truncation of the coverage filter is magnified and the two may 
+//               differ considerably.
+//
+//               VN_IMAGE_RESIZE_AREA averages the exact box of source pixels covered by each
+//               destination pixel, at a cost that does not depend upon the resize ratio. 
+//
+//               VN_IMAGE_RESIZE_PYRAMID repeatedly halves the source with 2x2 box averages
+//               until it is within twice the destination size, and then applies the coverage
+//               filter. This bounds the cost of the coverage filter on very large sources.
+//
+//               VN_IMAGE_RESIZE_DEFAULT selects the area filter when the source is at least 
+//               four times larger than the destination along both axes, and the coverage 
+//               filter otherwise. Use an explicit filter when results must remain stable 
+//               across image sizes (e.g. when hashing).
+//
 //   pDestImage: a pointer to an image object. Upon successful return, this object will
-//               contain a resized view of the source image.
+//               contain a resized view of the source image. The second form reshapes an 
+//               existing image (see vnReshapeImage) rather than creating a new one.
+//
+//   pWorkspace: an optional existing image that will be reshaped to hold intermediate 
+//               results. Reusing a workspace across calls avoids per call allocations.
 //
 
 VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, CVImage ** pDestImage );
 
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace );
+
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, VN_IMAGE_RESIZE_FILTER uiFilter, CVImage ** pDestImage );
+
+VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, VN_IMAGE_RESIZE_FILTER uiFilter, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace );
+
 //
 // DesaturateImage Operator
 //
@@ -264,28 +461,296 @@ VN_STATUS vnResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHei
 //
 // Parameters:
 // 
-//   pSrcImage:   The read-only source RGB8 image to desaturate.
+//   pSrcImage:   The read-only source image to desaturate. Any format that satisfies
+//                VN_IS_IMAGE_LUMA_FORMAT is supported. Gray images and the Y plane of
+//                planar YUV images are copied without conversion.
 //
 //   pDestImage: a pointer to an image object. Upon successful return, this object will
-//               contain a desaturated single channel copy of the source image.
+//               contain a desaturated single channel copy of the source image. The second
+//               form reshapes an existing image rather than creating a new one.
 //
 
 VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage ** pDestImage );
 
+VN_STATUS vnDesaturateImage( CONST CVImage & pSrcImage, INOUT CVImage * pDestImage );
+
+//
+// DesaturatePixel Operator
+//
+//   DesaturatePixel returns the gray value of a single RGB8 pixel. This is the same weighting
+//   that is applied by DesaturateImage.
+//
+
+inline UINT8 vnDesaturatePixel( CONST UINT8 * pSrcPixel )
+{
+    INT16 iSrcRed   = pSrcPixel[0];
+    INT16 iSrcGreen = pSrcPixel[1];
+    INT16 iSrcBlue  = pSrcPixel[2];
+
+    return ( ( iSrcRed * 0x4CC ) + ( iSrcGreen * 0x970 ) + ( iSrcBlue * 0x1C2 ) ) >> 12;
+}
+
+//
+// The second form returns the gray value of a single pixel of any luma format. Gray and Y 
+// plane samples are returned as is, and swizzled pixels are weighted in reverse order.
+//
+
+inline UINT8 vnDesaturatePixel( VN_IMAGE_FORMAT format, CONST UINT8 * pSrcPixel )
+{
+    if ( VN_IS_IMAGE_LUMA_PLANE( format ) )
+    {
+        return pSrcPixel[0];
+    }
+
+    if ( VN_IS_IMAGE_SWIZZLED( format ) )
+    {
+        INT16 iSrcBlue  = pSrcPixel[0];
+        INT16 iSrcGreen = pSrcPixel[1];
+        INT16 iSrcRed   = pSrcPixel[2];
+
+        return ( ( iSrcRed * 0x4CC ) + ( iSrcGreen * 0x970 ) + ( iSrcBlue * 0x1C2 ) ) >> 12;
+    }
+
+    return vnDesaturatePixel( pSrcPixel );
+}
+
+//
+// DesaturateLine Operator
+//
+//   DesaturateLine converts uiPixelCount consecutive pixels of the specified luma format into 
+//   gray values, exactly as DesaturatePixel would.
+//
+
+VN_STATUS vnDesaturateLine( VN_IMAGE_FORMAT format, IN UINT8 * pInput, UINT32 uiPixelCount, UINT8 * pOutput );
+
+//
+// DesaturateResizeImage Operator
+//
+//   DesaturateResizeImage produces the same R8 image as DesaturateImage followed by ResizeImage 
+//   (with VN_IMAGE_RESIZE_COVERAGE), without a full resolution gray intermediate. Each source 
+//   row is desaturated and filtered as it is read, and only a small ring of filtered rows is 
+//   retained for the vertical filter.
+//
+// Parameters:
+// 
+//   pSrcImage:  The read-only source image to desaturate and resize (see DesaturateImage).
+//               Gray images and the Y plane of planar YUV images are resized directly.
+//
+//   uiWidth:    The destination width to target.
+//
+//   uiHeight:   The destination height to target.
+//
+//   pDestImage: an existing image that will be reshaped to hold the R8 result.
+//
+//   pWorkspace: an optional existing image that will be reshaped to hold intermediate 
+//               results. Reusing a workspace across calls avoids per call allocations.
+//
+
+VN_STATUS vnDesaturateResizeImage( CONST CVImage & pSrcImage, UINT32 uiWidth, UINT32 uiHeight, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace );
+
+//
+// CVResizeContributors
+//
+//   The taps of the coverage kernel along a single axis (see vnImageResize.cpp).
+//
+
+class VN_NONVIRTUAL CVResizeContributors
+{
+public:
+
+    UINT32                      m_uiTapCount;       // taps per output sample
+    INT32 *                     m_piOffset;         // source offset of each tap (in elements of the caller's stride)
+    FLOAT32 *                   m_pfWeight;         // weight of each tap
+    FLOAT32 *                   m_pfWeightTotal;    // sum of the weights of each output sample
+
+public:
+
+    CVResizeContributors() : m_uiTapCount( 0 ), m_piOffset( 0 ), m_pfWeight( 0 ), m_pfWeightTotal( 0 ) {}
+};
+
+//
+// CVResizeStream
+//
+//   A push based form of ResizeImage (with VN_IMAGE_RESIZE_COVERAGE) and DesaturateResizeImage.
+//   Source rows are supplied one at a time, from top to bottom, and each destination row is 
+//   written as soon as the last source row that it covers arrives. Only a small ring of filtered
+//   rows is retained, so the full source image never needs to exist in memory. The results are
+//   identical to those of the image operators.
+//
+//   (!) Note: streams are not thread safe. Use a separate stream on each thread.
+//
+
+class VN_NONVIRTUAL CVResizeStream
+{
+    CVImage *                   m_pDestImage;
+    VN_IMAGE_FORMAT             m_uiSrcFormat;
+    UINT32                      m_uiSrcWidth;
+    UINT32                      m_uiSrcHeight;
+    UINT32                      m_uiSrcRow;             // the next source row to arrive
+    UINT32                      m_uiDestRow;            // the next destination row to complete
+    UINT32                      m_uiRingSize;
+    BOOL                        m_bDesaturate;
+
+    CVResizeContributors        m_pHorizTable;
+    CVResizeContributors        m_pVertTable;
+    INT32 *                     m_piAccumulator;
+    UINT8 *                     m_pRing;
+    UINT8 *                     m_pGrayLine;
+    UINT8 *                     m_pOwnedScratch;        // scratch memory, if no workspace was provided
+
+private:
+
+    CVResizeStream( CONST CVResizeStream & rvalue );
+    CVResizeStream &            operator = ( CONST CVResizeStream & rvalue );
+
+public:
+
+    CVResizeStream();
+    ~CVResizeStream();
+
+    //
+    // Begin
+    //
+    //   Prepares to resize a ( uiSrcWidth x uiSrcHeight ) source of the specified format into 
+    //   pDestImage, which must already be shaped to the destination dimensions. Only the first 
+    //   channel of each pixel is filtered, unless bDesaturate is set, in which case each source
+    //   row is desaturated (see DesaturateLine) and pDestImage should be an R8 image. Scratch 
+    //   memory lives within pWorkspace, if one is provided, which must not be reshaped until 
+    //   the stream is complete.
+    //
+
+    VN_STATUS                   Begin( VN_IMAGE_FORMAT format, UINT32 uiSrcWidth, UINT32 uiSrcHeight, BOOL bDesaturate, INOUT CVImage * pDestImage, INOUT CVImage * pWorkspace );
+
+    //
+    // PushRow
+    //
+    //   Supplies the next source row, which holds uiSrcWidth pixels of the format passed to Begin.
+    //   Rows that arrive after the stream is complete are ignored.
+    //
+
+    VN_STATUS                   PushRow( IN UINT8 * pSrcLine );
+
+    //
+    // IsComplete
+    //
+    //   Returns TRUE once every destination row has been written.
+    //
+
+    BOOL                        IsComplete() CONST;
+};
+
 //
 // TransformImage Operator
 //
-//   TransformImage performs a slow (but flexible) DCT-II transformation on the image data.
+//   TransformImage performs a DCT-II transformation on the image data. Power of two dimensions
+//   use a fast O(N log N) factorization, while all other sizes fall back to the direct form.
 //
 // Parameters:
 // 
 //   pSrcImage:   The read-only source R8 image to transform.
 //
+//   uiFlags:     A combination of VN_IMAGE_TRANSFORM_* flags. VN_IMAGE_TRANSFORM_FIXED_POINT
+//                evaluates the transform using only integer arithmetic and a basis that does
+//                not depend upon the platform math library. Its coefficients are bit-identical
+//                across platforms and compilers, but may differ by a small rounding error from
+//                those of the default (floating point) transform.
+//
+//                VN_IMAGE_TRANSFORM_COMPACT stores the coefficients in an R16S image whenever 
+//                the dimensions of the source guarantee that every coefficient will fit (e.g.
+//                up to 128x128 pixels). The coefficients themselves are unaffected.
+//
 //   pDestImage: a pointer to an image object. Upon successful return, this object will
-//               contain transform coefficients in a single channel R32S image of 
-//               matching size to the source.
+//               contain transform coefficients in a single channel R32S (or R16S) image 
+//               of matching size to the source. The workspace form reshapes an existing
+//               image rather than creating a new one.
+//
+//   pWorkspace: an optional existing image that will be reshaped to hold intermediate 
+//               results. Reusing a workspace across calls avoids per call allocations.
 //
 
+VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** pOutput );
+
 VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, OUT CVImage ** pOutput );
 
+VN_STATUS vnTransformImage( CONST CVImage & pSrcImage, VN_IMAGE_TRANSFORM_FLAGS uiFlags, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace );
+
+//
+// TransformImageLowFrequency Operator
+//
+//   TransformImageLowFrequency computes only the upper left (lowest frequency) block of the 
+//   DCT-II of the image. The coefficients match those of TransformImage, but the cost of the
+//   transform scales with the block size rather than the image size.
+//
+// Parameters:
+// 
+//   pSrcImage:   The read-only source R8 image to transform.
+//
+//   uiBlockSize: The width and height of the coefficient block to compute. This value is
+//                clamped to the dimensions of the source image.
+//
+//   uiFlags:     A combination of VN_IMAGE_TRANSFORM_* flags (see TransformImage).
+//
+//   pDestImage: a pointer to an image object. Upon successful return, this object will
+//               contain the requested transform coefficients in a single channel R32S (or 
+//               R16S) image. The workspace form reshapes an existing image instead.
+//
+//   pWorkspace: an optional existing image that will be reshaped to hold intermediate 
+//               results (see TransformImage).
+//
+
+VN_STATUS vnTransformImageLowFrequency( CONST CVImage & pSrcImage, UINT32 uiBlockSize, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** pOutput );
+
+VN_STATUS vnTransformImageLowFrequency( CONST CVImage & pSrcImage, UINT32 uiBlockSize, OUT CVImage ** pOutput );
+
+VN_STATUS vnTransformImageLowFrequency( CONST CVImage & pSrcImage, UINT32 uiBlockSize, VN_IMAGE_TRANSFORM_FLAGS uiFlags, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace );
+
+//
+// TransformImageBatch Operator
+//
+//   TransformImageBatch computes the upper left (lowest frequency) block of the DCT-II of each
+//   image in a batch. The batch is evaluated as a series of blocked matrix products that share 
+//   a single copy of the basis, which is considerably faster than transforming many small images
+//   individually. Fixed point coefficients are identical to those of TransformImageLowFrequency,
+//   while floating point coefficients may differ from them by one.
+//
+// Parameters:
+//
+//   ppSrcImages:  An array of uiImageCount read-only source R8 images. All images must share
+//                 the same dimensions.
+//
+//   uiImageCount: The number of images in the batch.
+//
+//   uiBlockSize:  The width and height of each coefficient block to compute. This value is
+//                 clamped to the dimensions of the source images.
+//
+//   uiFlags:      A combination of VN_IMAGE_TRANSFORM_* flags (see TransformImage).
+//
+//   ppOutputs:    An array of uiImageCount image pointers. Upon successful return, each will
+//                 point to a new single channel R32S (or R16S) image containing the coefficients
+//                 of the corresponding source image. Upon failure, each will be null.
+//
+
+VN_STATUS vnTransformImageBatch( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockSize, VN_IMAGE_TRANSFORM_FLAGS uiFlags, OUT CVImage ** ppOutputs );
+
+VN_STATUS vnTransformImageBatch( CONST CVImage * CONST * ppSrcImages, UINT32 uiImageCount, UINT32 uiBlockSize, OUT CVImage ** ppOutputs );
+
+//
+// QueryTransformBasis Operator
+//
+//   QueryTransformBasis retrieves the fixed point DCT-II basis that VN_IMAGE_TRANSFORM_FIXED_POINT
+//   uses for lines of uiCount samples. Callers that evaluate their own (e.g. specialized) fixed
+//   point transforms can use it to produce coefficients identical to those of TransformImage.
+//
+// Parameters:
+//
+//   uiCount:     The number of samples per line. This may not exceed 1024.
+//
+//   ppBasis:     Upon successful return, this will point to uiCount rows of uiCount values, one 
+//                row per coefficient. Each value carries VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT 
+//                fractional bits, and sums are resolved by rounding half away from zero. The 
+//                basis is shared and remains valid for the lifetime of the process.
+//
+
+VN_STATUS vnQueryTransformBasis( UINT32 uiCount, OUT CONST INT32 ** ppBasis );
+
 #endif // __VN_IMAGE_H__
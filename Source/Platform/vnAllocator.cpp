@@ -0,0 +1,269 @@
+
+#include "vnAllocator.h"
+
+//
+// Threads that have not selected an allocator use the shared heap allocator.
+//
+
+static CVHeapAllocator g_pHeapAllocator;
+static VN_THREAD_LOCAL CVAllocator * g_pThreadAllocator = NULL;
+
+VOID * CVHeapAllocator::Allocate( SIZE_T uiSize )
+{
+    return new UINT8[ uiSize ];
+}
+
+VOID CVHeapAllocator::Free( VOID * pMemory, SIZE_T uiSize )
+{
+    delete [] (UINT8 *) pMemory;
+}
+
+//
+// vnQueryPoolClass
+//
+//   Returns the smallest size class that can hold uiSize bytes, or VN_POOL_CLASS_COUNT
+//   if the request is too large for our pool.
+//
+
+UINT32 vnQueryPoolClass( SIZE_T uiSize )
+{
+    UINT32 uiClass = 0;
+
+    while ( uiClass < VN_POOL_CLASS_COUNT && ( (SIZE_T) 1 << ( uiClass + VN_POOL_MIN_CLASS_SHIFT ) ) < uiSize )
+    {
+        uiClass++;
+    }
+
+    return uiClass;
+}
+
+CVPoolAllocator::CVPoolAllocator()
+{
+    for ( UINT32 i = 0; i < VN_POOL_CLASS_COUNT; i++ )
+    {
+        m_pFreeBlocks[ i ] = NULL;
+
+        InitializeSRWLock( &m_pLocks[ i ] );
+    }
+}
+
+CVPoolAllocator::~CVPoolAllocator()
+{
+    Trim();
+}
+
+VOID * CVPoolAllocator::Allocate( SIZE_T uiSize )
+{
+    UINT32 uiClass = vnQueryPoolClass( uiSize );
+
+    if ( VN_POOL_CLASS_COUNT == uiClass )
+    {
+        return m_pHeap.Allocate( uiSize );
+    }
+
+    //
+    // Free blocks are linked through their first bytes, which are always large enough
+    // to hold a pointer.
+    //
+
+    AcquireSRWLockExclusive( &m_pLocks[ uiClass ] );
+
+    VOID * pBlock = m_pFreeBlocks[ uiClass ];
+
+    if ( pBlock )
+    {
+        m_pFreeBlocks[ uiClass ] = *(VOID **) pBlock;
+    }
+
+    ReleaseSRWLockExclusive( &m_pLocks[ uiClass ] );
+
+    if ( !pBlock )
+    {
+        pBlock = m_pHeap.Allocate( (SIZE_T) 1 << ( uiClass + VN_POOL_MIN_CLASS_SHIFT ) );
+    }
+
+    return pBlock;
+}
+
+VOID CVPoolAllocator::Free( VOID * pMemory, SIZE_T uiSize )
+{
+    if ( !pMemory )
+    {
+        return;
+    }
+
+    UINT32 uiClass = vnQueryPoolClass( uiSize );
+
+    if ( VN_POOL_CLASS_COUNT == uiClass )
+    {
+        m_pHeap.Free( pMemory, uiSize );
+
+        return;
+    }
+
+    AcquireSRWLockExclusive( &m_pLocks[ uiClass ] );
+
+    *(VOID **) pMemory       = m_pFreeBlocks[ uiClass ];
+    m_pFreeBlocks[ uiClass ] = pMemory;
+
+    ReleaseSRWLockExclusive( &m_pLocks[ uiClass ] );
+}
+
+VOID CVPoolAllocator::Trim()
+{
+    for ( UINT32 i = 0; i < VN_POOL_CLASS_COUNT; i++ )
+    {
+        AcquireSRWLockExclusive( &m_pLocks[ i ] );
+
+        VOID * pBlock       = m_pFreeBlocks[ i ];
+        m_pFreeBlocks[ i ]  = NULL;
+
+        ReleaseSRWLockExclusive( &m_pLocks[ i ] );
+
+        while ( pBlock )
+        {
+            VOID * pNext = *(VOID **) pBlock;
+
+            m_pHeap.Free( pBlock, (SIZE_T) 1 << ( i + VN_POOL_MIN_CLASS_SHIFT ) );
+
+            pBlock = pNext;
+        }
+    }
+}
+
+//
+// Our chunk headers are padded so that the data that follows them remains aligned.
+//
+
+#define VN_ARENA_HEADER_SIZE                        ( ( sizeof( CVArenaChunk ) + VN_ARENA_ALIGNMENT - 1 ) & ~( VN_ARENA_ALIGNMENT - 1 ) )
+#define VN_ARENA_CHUNK_DATA( x )                    ( (UINT8 *) (x) + VN_ARENA_HEADER_SIZE )
+
+CVArenaAllocator::CVArenaAllocator()
+{
+    m_pFirstChunk = NULL;
+    m_pChunk      = NULL;
+    m_uiOffset    = 0;
+    m_uiChunkSize = VN_ARENA_DEFAULT_CHUNK_SIZE;
+}
+
+CVArenaAllocator::CVArenaAllocator( SIZE_T uiChunkSize )
+{
+    m_pFirstChunk = NULL;
+    m_pChunk      = NULL;
+    m_uiOffset    = 0;
+    m_uiChunkSize = uiChunkSize;
+}
+
+CVArenaAllocator::~CVArenaAllocator()
+{
+    Release();
+}
+
+VOID * CVArenaAllocator::Allocate( SIZE_T uiSize )
+{
+    if ( uiSize > (SIZE_T) -1 - VN_ARENA_HEADER_SIZE - VN_ARENA_ALIGNMENT )
+    {
+        return NULL;
+    }
+
+    SIZE_T uiAlignedSize = VN_MAX2( VN_ARENA_ALIGNMENT, ( uiSize + VN_ARENA_ALIGNMENT - 1 ) & ~( (SIZE_T) VN_ARENA_ALIGNMENT - 1 ) );
+
+    //
+    // Bump through our current chunk, then through any chunks that we retained across a
+    // reset, and only allocate a new chunk once we have run out of both.
+    //
+
+    while ( m_pChunk && m_uiOffset + uiAlignedSize > m_pChunk->m_uiSize )
+    {
+        if ( !m_pChunk->m_pNext )
+        {
+            break;
+        }
+
+        m_pChunk   = m_pChunk->m_pNext;
+        m_uiOffset = 0;
+    }
+
+    if ( !m_pChunk || m_uiOffset + uiAlignedSize > m_pChunk->m_uiSize )
+    {
+        SIZE_T uiChunkSize      = VN_MAX2( m_uiChunkSize, uiAlignedSize );
+        CVArenaChunk * pChunk   = (CVArenaChunk *) m_pHeap.Allocate( VN_ARENA_HEADER_SIZE + uiChunkSize );
+
+        if ( !pChunk )
+        {
+            return NULL;
+        }
+
+        pChunk->m_pNext  = NULL;
+        pChunk->m_uiSize = uiChunkSize;
+
+        if ( m_pChunk )
+        {
+            m_pChunk->m_pNext = pChunk;
+        }
+        else
+        {
+            m_pFirstChunk = pChunk;
+        }
+
+        m_pChunk   = pChunk;
+        m_uiOffset = 0;
+    }
+
+    VOID * pMemory = VN_ARENA_CHUNK_DATA( m_pChunk ) + m_uiOffset;
+
+    m_uiOffset += uiAlignedSize;
+
+    return pMemory;
+}
+
+VOID CVArenaAllocator::Free( VOID * pMemory, SIZE_T uiSize )
+{
+    if ( !pMemory || !m_pChunk )
+    {
+        return;
+    }
+
+    //
+    // Only the most recent allocation can be returned to the arena. This allows images
+    // that grow immediately after their creation to reuse their space.
+    //
+
+    SIZE_T uiAlignedSize = VN_MAX2( VN_ARENA_ALIGNMENT, ( uiSize + VN_ARENA_ALIGNMENT - 1 ) & ~( (SIZE_T) VN_ARENA_ALIGNMENT - 1 ) );
+
+    if ( m_uiOffset >= uiAlignedSize && (UINT8 *) pMemory == VN_ARENA_CHUNK_DATA( m_pChunk ) + m_uiOffset - uiAlignedSize )
+    {
+        m_uiOffset -= uiAlignedSize;
+    }
+}
+
+VOID CVArenaAllocator::Reset()
+{
+    m_pChunk   = m_pFirstChunk;
+    m_uiOffset = 0;
+}
+
+VOID CVArenaAllocator::Release()
+{
+    while ( m_pFirstChunk )
+    {
+        CVArenaChunk * pNext = m_pFirstChunk->m_pNext;
+
+        m_pHeap.Free( m_pFirstChunk, VN_ARENA_HEADER_SIZE + m_pFirstChunk->m_uiSize );
+
+        m_pFirstChunk = pNext;
+    }
+
+    m_pChunk   = NULL;
+    m_uiOffset = 0;
+}
+
+VOID vnSetThreadAllocator( CVAllocator * pAllocator )
+{
+    g_pThreadAllocator = pAllocator;
+}
+
+CVAllocator * vnQueryThreadAllocator()
+{
+    return ( g_pThreadAllocator ? g_pThreadAllocator : &g_pHeapAllocator );
+}
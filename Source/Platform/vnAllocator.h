@@ -0,0 +1,186 @@
+
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnAllocator.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+//
+
+#ifndef __VN_ALLOCATOR_H__
+#define __VN_ALLOCATOR_H__
+
+#include "vnBase.h"
+
+//
+// CVAllocator
+//
+//   The interface through which images (and other large objects) acquire their memory. 
+//   Allocations must be returned to the allocator that produced them, along with their 
+//   original size. Allocate returns NULL on failure. Returned memory is aligned at least as 
+//   strictly as that of the system heap.
+//
+
+class CVAllocator
+{
+public:
+
+    virtual ~CVAllocator() {}
+
+    virtual VOID *              Allocate( SIZE_T uiSize ) = 0;
+    virtual VOID                Free( VOID * pMemory, SIZE_T uiSize ) = 0;
+};
+
+//
+// CVHeapAllocator
+//
+//   Forwards every request to the system heap. This is the default allocator of all threads.
+//   Heap allocators are thread safe.
+//
+
+class CVHeapAllocator : public CVAllocator
+{
+public:
+
+    VOID *                      Allocate( SIZE_T uiSize );
+    VOID                        Free( VOID * pMemory, SIZE_T uiSize );
+};
+
+//
+// CVPoolAllocator
+//
+//   Rounds each request up to a power of two size class and recycles freed blocks within
+//   their class, so that a steady state workload (e.g. many threads hashing images of similar 
+//   sizes) stops reaching the system heap entirely. Each class is guarded by its own lock.
+//   Requests above the largest class are forwarded to the heap. Pool allocators are thread
+//   safe, and retain their free blocks until Trim is called or the pool is destroyed.
+//
+
+#define VN_POOL_MIN_CLASS_SHIFT                     (6)             // 64 bytes
+#define VN_POOL_CLASS_COUNT                         (21)            // up to 64 MB
+
+class CVPoolAllocator : public CVAllocator
+{
+    VOID *                      m_pFreeBlocks[ VN_POOL_CLASS_COUNT ];
+    SRWLOCK                     m_pLocks[ VN_POOL_CLASS_COUNT ];
+    CVHeapAllocator             m_pHeap;
+
+private:
+
+    CVPoolAllocator( CONST CVPoolAllocator & rvalue );
+    CVPoolAllocator &           operator = ( CONST CVPoolAllocator & rvalue );
+
+public:
+
+    CVPoolAllocator();
+    ~CVPoolAllocator();
+
+    VOID *                      Allocate( SIZE_T uiSize );
+    VOID                        Free( VOID * pMemory, SIZE_T uiSize );
+
+    //
+    // Returns all free blocks to the heap. Outstanding allocations are unaffected.
+    //
+
+    VOID                        Trim();
+};
+
+//
+// CVArenaAllocator
+//
+//   A bump allocator that carves requests out of large chunks. Individual frees are ignored 
+//   (other than that of the most recent allocation, which is rolled back), and all memory is 
+//   instead reclaimed at once by Reset. Chunks are retained across resets, so that a thread 
+//   that resets its arena after each batch of work stops allocating once it has seen its 
+//   largest batch. 
+//
+//   (!) Note: arenas are not thread safe. Use a separate arena on each thread, and destroy (or
+//             stop using) every object allocated from an arena before resetting it.
+//
+
+#define VN_ARENA_DEFAULT_CHUNK_SIZE                 ( 4 * MB )
+#define VN_ARENA_ALIGNMENT                          (16)
+
+class CVArenaAllocator : public CVAllocator
+{
+    struct CVArenaChunk
+    {
+        CVArenaChunk *          m_pNext;
+        SIZE_T                  m_uiSize;           // usable bytes, following the header
+    };
+
+    CVArenaChunk *              m_pFirstChunk;
+    CVArenaChunk *              m_pChunk;           // the chunk that we are bumping through
+    SIZE_T                      m_uiOffset;         // bytes used within m_pChunk
+    SIZE_T                      m_uiChunkSize;
+    CVHeapAllocator             m_pHeap;
+
+private:
+
+    CVArenaAllocator( CONST CVArenaAllocator & rvalue );
+    CVArenaAllocator &          operator = ( CONST CVArenaAllocator & rvalue );
+
+public:
+
+    CVArenaAllocator();
+    CVArenaAllocator( SIZE_T uiChunkSize );
+    ~CVArenaAllocator();
+
+    VOID *                      Allocate( SIZE_T uiSize );
+    VOID                        Free( VOID * pMemory, SIZE_T uiSize );
+
+    //
+    // Reclaims every allocation made since the last reset, while retaining our chunks.
+    //
+
+    VOID                        Reset();
+
+    //
+    // Reclaims every allocation and returns all chunks to the heap.
+    //
+
+    VOID                        Release();
+};
+
+//
+// Thread allocators
+//
+//   Each thread routes its image allocations through its current allocator, which is the
+//   shared heap allocator unless the thread selects another. Images remember the allocator 
+//   that they were created with and always return their memory to it, so a thread may change
+//   its allocator at any time. Passing NULL restores the heap allocator.
+//
+
+VOID vnSetThreadAllocator( CVAllocator * pAllocator );
+
+CVAllocator * vnQueryThreadAllocator();
+
+#endif // __VN_ALLOCATOR_H__
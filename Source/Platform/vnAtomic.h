@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnAtomic.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+//
+
+#ifndef __VN_ATOMIC_H__
+#define __VN_ATOMIC_H__
+
+#include "vnPlatform.h"
+#include "vnStandard.h"
+
+//
+// (!) Note: all atomic operations are full memory barriers.
+//
+
+#if defined ( VN_PLATFORM_WINDOWS )
+
+inline VOID * vnAtomicCompareExchangePointer( VOID * volatile * ppDest, VOID * pExchange, VOID * pComparand )
+{
+    return InterlockedCompareExchangePointer( ppDest, pExchange, pComparand );
+}
+
+inline VOID * vnAtomicLoadPointer( VOID * volatile * ppSrc )
+{
+    //
+    // Volatile reads carry acquire semantics on all supported Windows targets.
+    //
+
+    return *ppSrc;
+}
+
+inline VOID vnAtomicStore32( volatile UINT32 * pDest, UINT32 uiValue )
+{
+    InterlockedExchange( (volatile LONG *) pDest, uiValue );
+}
+
+inline UINT32 vnAtomicLoad32( volatile UINT32 * pSrc )
+{
+    return *pSrc;
+}
+
+inline UINT32 vnAtomicCompareExchange32( volatile UINT32 * pDest, UINT32 uiExchange, UINT32 uiComparand )
+{
+    return InterlockedCompareExchange( (volatile LONG *) pDest, uiExchange, uiComparand );
+}
+
+//
+// Aligned 64 bit accesses are only single instructions on 64 bit targets. 32 bit targets 
+// split them in two, so we route them through cmpxchg8b to prevent tearing.
+//
+
+inline VOID vnAtomicStore64( volatile UINT64 * pDest, UINT64 uiValue )
+{
+#if defined ( VN_ARCH_64BIT )
+    *pDest = uiValue;
+#else
+    InterlockedExchange64( (volatile LONGLONG *) pDest, uiValue );
+#endif
+}
+
+inline UINT64 vnAtomicLoad64( volatile UINT64 * pSrc )
+{
+#if defined ( VN_ARCH_64BIT )
+    return *pSrc;
+#else
+    return InterlockedCompareExchange64( (volatile LONGLONG *) pSrc, 0, 0 );
+#endif
+}
+
+#endif
+
+#endif // __VN_ATOMIC_H__
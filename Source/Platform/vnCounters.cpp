@@ -0,0 +1,183 @@
+
+#include "vnCounters.h"
+#include "vnAtomic.h"
+
+static CONST CHAR * g_szCounterStageNames[ VN_COUNTER_STAGE_COUNT ] = { "desaturate", "resize", "transform", "block_average", "publish" };
+
+//
+// Every thread that records counters registers its counters in our list upon first use. 
+// Entries are never removed, so that our totals remain monotonic as threads exit. Instead,
+// a fiber local storage callback retires the counters of each exiting thread, and new
+// threads adopt retired counters before creating their own, which bounds our list by the
+// greatest number of threads that have recorded counters at once.
+//
+
+static volatile BOOL g_bCountersEnabled = FALSE;
+static CVThreadCounters * volatile g_pCounterList = NULL;
+static VN_THREAD_LOCAL CVThreadCounters * g_pThreadCounters = NULL;
+
+//
+// vnRetireThreadCounters
+//
+//   Invoked as each registered thread exits. The thread records no further counters.
+//
+
+VOID WINAPI vnRetireThreadCounters( VOID * pData )
+{
+    vnAtomicStore32( &( (CVThreadCounters *) pData )->m_uiRetired, 1 );
+}
+
+static DWORD g_uiCounterFlsIndex = FlsAlloc( vnRetireThreadCounters );
+
+//
+// vnQueryCounterFrequency
+//
+//   Returns the number of timer ticks per second.
+//
+
+UINT64 vnQueryCounterFrequency()
+{
+    LARGE_INTEGER uiFrequency;
+
+    QueryPerformanceFrequency( &uiFrequency );
+
+    return uiFrequency.QuadPart;
+}
+
+static UINT64 g_uiCounterFrequency = vnQueryCounterFrequency();
+
+UINT64 vnQueryCounterTicks()
+{
+    LARGE_INTEGER uiTicks;
+
+    QueryPerformanceCounter( &uiTicks );
+
+    return uiTicks.QuadPart;
+}
+
+//
+// vnRegisterThreadCounters
+//
+//   Adopts retired counters for the calling thread, or creates new counters and publishes 
+//   them to our list.
+//
+
+CVThreadCounters * vnRegisterThreadCounters()
+{
+    CVThreadCounters * pCounters = (CVThreadCounters *) vnAtomicLoadPointer( (VOID * volatile *) &g_pCounterList );
+
+    for ( ; pCounters; pCounters = pCounters->m_pNext )
+    {
+        if ( 1 == vnAtomicCompareExchange32( &pCounters->m_uiRetired, 0, 1 ) )
+        {
+            break;
+        }
+    }
+
+    if ( !pCounters )
+    {
+        pCounters = new CVThreadCounters;
+
+        vnZeroMemory( pCounters, sizeof( CVThreadCounters ) );
+
+        VOID * pHead = NULL;
+
+        do
+        {
+            pHead               = vnAtomicLoadPointer( (VOID * volatile *) &g_pCounterList );
+            pCounters->m_pNext  = (CVThreadCounters *) pHead;
+        }
+        while ( pHead != vnAtomicCompareExchangePointer( (VOID * volatile *) &g_pCounterList, pCounters, pHead ) );
+    }
+
+    //
+    // Without an index our counters are simply never retired.
+    //
+
+    if ( FLS_OUT_OF_INDEXES != g_uiCounterFlsIndex )
+    {
+        FlsSetValue( g_uiCounterFlsIndex, pCounters );
+    }
+
+    g_pThreadCounters = pCounters;
+
+    return pCounters;
+}
+
+CVThreadCounters * vnQueryThreadCounters()
+{
+    if ( !g_bCountersEnabled )
+    {
+        return NULL;
+    }
+
+    return ( g_pThreadCounters ? g_pThreadCounters : vnRegisterThreadCounters() );
+}
+
+VOID vnEnableCounters( BOOL bEnable )
+{
+    g_bCountersEnabled = bEnable;
+}
+
+//
+// vnConvertCounterTicks
+//
+//   Converts a tick count into nanoseconds without overflowing for large counts.
+//
+
+UINT64 vnConvertCounterTicks( UINT64 uiTicks )
+{
+    UINT64 uiSeconds = uiTicks / g_uiCounterFrequency;
+    UINT64 uiRemnant = uiTicks % g_uiCounterFrequency;
+
+    return uiSeconds * 1000000000ULL + ( uiRemnant * 1000000000ULL ) / g_uiCounterFrequency;
+}
+
+VN_STATUS vnQueryCounterSnapshot( OUT CVCounterSnapshot * pSnapshot )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pSnapshot )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    vnZeroMemory( pSnapshot, sizeof( CVCounterSnapshot ) );
+
+    CVThreadCounters * pCounters = (CVThreadCounters *) vnAtomicLoadPointer( (VOID * volatile *) &g_pCounterList );
+
+    for ( ; pCounters; pCounters = pCounters->m_pNext )
+    {
+        for ( UINT32 i = 0; i < VN_COUNTER_STAGE_COUNT; i++ )
+        {
+            pSnapshot->m_pStages[ i ].m_uiCalls       += vnAtomicLoad64( &pCounters->m_pCalls[ i ] );
+            pSnapshot->m_pStages[ i ].m_uiNanoseconds += vnAtomicLoad64( &pCounters->m_pTicks[ i ] );
+            pSnapshot->m_pStages[ i ].m_uiBytes       += vnAtomicLoad64( &pCounters->m_pBytes[ i ] );
+        }
+
+        pSnapshot->m_uiAllocations    += vnAtomicLoad64( &pCounters->m_uiAllocations );
+        pSnapshot->m_uiAllocatedBytes += vnAtomicLoad64( &pCounters->m_uiAllocatedBytes );
+    }
+
+    //
+    // Ticks are summed before conversion so that no precision is lost per thread.
+    //
+
+    for ( UINT32 i = 0; i < VN_COUNTER_STAGE_COUNT; i++ )
+    {
+        pSnapshot->m_pStages[ i ].m_uiNanoseconds = vnConvertCounterTicks( pSnapshot->m_pStages[ i ].m_uiNanoseconds );
+    }
+
+    return VN_SUCCESS;
+}
+
+CONST CHAR * vnQueryCounterStageName( UINT32 uiStage )
+{
+    if ( uiStage >= VN_COUNTER_STAGE_COUNT )
+    {
+        return NULL;
+    }
+
+    return g_szCounterStageNames[ uiStage ];
+}
@@ -0,0 +1,269 @@
+
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnCounters.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+
+#ifndef __VN_COUNTERS_H__
+#define __VN_COUNTERS_H__
+
+#include "vnBase.h"
+#include "vnAtomic.h"
+
+//
+// Performance counters
+//
+//   Each thread accumulates its own counters for the stages of our pipeline, which are only
+//   aggregated when a snapshot is requested. Counters are compiled in when VN_ENABLE_COUNTERS
+//   is non-zero, but remain idle until vnEnableCounters is called. An idle stage costs a single
+//   function call and branch.
+//
+
+#define VN_ENABLE_COUNTERS                          (1)
+
+#define VN_COUNTER_STAGE_DESATURATE                 (0)
+#define VN_COUNTER_STAGE_RESIZE                     (1)
+#define VN_COUNTER_STAGE_TRANSFORM                  (2)
+#define VN_COUNTER_STAGE_BLOCK_AVERAGE              (3)
+#define VN_COUNTER_STAGE_PUBLISH                    (4)
+#define VN_COUNTER_STAGE_COUNT                      (5)
+
+//
+// CVStageCounters
+//
+//   The totals of a single stage. Stage times are exclusive: a stage that runs within another
+//   (e.g. the desaturation of each row of a combined desaturate and resize) is subtracted from
+//   the time of the enclosing stage. Stages that are performed a row at a time (by streamed 
+//   hashes, and the desaturation within a resize) record a call per row. Bytes are the sum 
+//   of those read and written.
+//
+
+struct CVStageCounters
+{
+    UINT64                      m_uiCalls;
+    UINT64                      m_uiNanoseconds;
+    UINT64                      m_uiBytes;
+};
+
+//
+// CVCounterSnapshot
+//
+//   The totals of every thread. Counters only ever increase (the counters of exited threads 
+//   are retained), so consumers may difference successive snapshots to derive rates.
+//
+
+struct CVCounterSnapshot
+{
+    CVStageCounters             m_pStages[ VN_COUNTER_STAGE_COUNT ];
+    UINT64                      m_uiAllocations;            // requests made of image allocators
+    UINT64                      m_uiAllocatedBytes;
+};
+
+//
+// CVThreadCounters
+//
+//   The counters of a single thread. Only the owning thread writes them. Once that thread
+//   exits its counters are retired, and may be adopted (totals intact) by a new thread.
+//
+
+struct CVThreadCounters
+{
+    volatile UINT64             m_pCalls[ VN_COUNTER_STAGE_COUNT ];
+    volatile UINT64             m_pTicks[ VN_COUNTER_STAGE_COUNT ];
+    volatile UINT64             m_pBytes[ VN_COUNTER_STAGE_COUNT ];
+    volatile UINT64             m_uiAllocations;
+    volatile UINT64             m_uiAllocatedBytes;
+    UINT64                      m_uiNestedTicks;            // total time of every completed stage
+    volatile UINT32             m_uiRetired;                // non-zero once the owning thread exits
+    CVThreadCounters *          m_pNext;
+};
+
+//
+// vnEnableCounters
+//
+//   Starts (or stops) the accumulation of counters by all threads. Counters are disabled by
+//   default. Stages that are already underway when counters are disabled are still recorded.
+//
+
+VOID vnEnableCounters( BOOL bEnable );
+
+//
+// vnQueryCounterSnapshot
+//
+//   Sums the counters of every thread into pSnapshot. This may be called at any time, from any
+//   thread, and does not interrupt threads that are recording counters.
+//
+
+VN_STATUS vnQueryCounterSnapshot( OUT CVCounterSnapshot * pSnapshot );
+
+//
+// vnQueryCounterStageName
+//
+//   Returns a printable name for uiStage, or NULL if it is not a valid stage.
+//
+
+CONST CHAR * vnQueryCounterStageName( UINT32 uiStage );
+
+//
+// vnQueryThreadCounters
+//
+//   Returns the counters of the calling thread, or NULL if counters are disabled.
+//
+
+CVThreadCounters * vnQueryThreadCounters();
+
+//
+// vnQueryCounterTicks
+//
+//   Returns the current value of the high resolution timer used by our counters.
+//
+
+UINT64 vnQueryCounterTicks();
+
+//
+// vnConvertCounterTicks
+//
+//   Converts a number of timer ticks into nanoseconds.
+//
+
+UINT64 vnConvertCounterTicks( UINT64 uiTicks );
+
+//
+// vnAddCounter
+//
+//   Adds uiValue to a counter of the calling thread. Only the owner writes a counter, so the 
+//   sum need not be atomic, but the store must be so that snapshots never observe a torn value.
+//
+
+inline VOID vnAddCounter( volatile UINT64 * pCounter, UINT64 uiValue )
+{
+    vnAtomicStore64( pCounter, *pCounter + uiValue );
+}
+
+//
+// vnCountAllocation
+//
+//   Records an allocation of uiSize bytes by the calling thread.
+//
+
+inline VOID vnCountAllocation( SIZE_T uiSize )
+{
+#if VN_ENABLE_COUNTERS
+
+    CVThreadCounters * pCounters = vnQueryThreadCounters();
+
+    if ( pCounters )
+    {
+        vnAddCounter( &pCounters->m_uiAllocations, 1 );
+        vnAddCounter( &pCounters->m_uiAllocatedBytes, uiSize );
+    }
+
+#endif
+}
+
+//
+// CVStageTimer
+//
+//   Records a single call of a stage across its lifetime. Place a timer at the top of the
+//   scope that performs the stage.
+//
+
+class VN_NONVIRTUAL CVStageTimer
+{
+#if VN_ENABLE_COUNTERS
+
+    CVThreadCounters *          m_pCounters;
+    UINT32                      m_uiStage;
+    UINT64                      m_uiBytes;
+    UINT64                      m_uiStartTicks;
+    UINT64                      m_uiStartNestedTicks;
+
+#endif
+
+private:
+
+    CVStageTimer( CONST CVStageTimer & rvalue );
+    CVStageTimer &              operator = ( CONST CVStageTimer & rvalue );
+
+public:
+
+    CVStageTimer( UINT32 uiStage, UINT64 uiBytes );
+    ~CVStageTimer();
+};
+
+#if VN_ENABLE_COUNTERS
+
+inline CVStageTimer::CVStageTimer( UINT32 uiStage, UINT64 uiBytes )
+{
+    m_pCounters = vnQueryThreadCounters();
+
+    if ( m_pCounters )
+    {
+        m_uiStage            = uiStage;
+        m_uiBytes            = uiBytes;
+        m_uiStartNestedTicks = m_pCounters->m_uiNestedTicks;
+        m_uiStartTicks       = vnQueryCounterTicks();
+    }
+}
+
+inline CVStageTimer::~CVStageTimer()
+{
+    if ( !m_pCounters )
+    {
+        return;
+    }
+
+    //
+    // Any stages that completed within our lifetime have already recorded their time, so
+    // we record only the remainder. Our enclosing stage then sees our entire lifetime as
+    // nested time.
+    //
+
+    UINT64 uiTicks       = vnQueryCounterTicks() - m_uiStartTicks;
+    UINT64 uiNestedTicks = m_pCounters->m_uiNestedTicks - m_uiStartNestedTicks;
+
+    vnAddCounter( &m_pCounters->m_pCalls[ m_uiStage ], 1 );
+    vnAddCounter( &m_pCounters->m_pTicks[ m_uiStage ], ( uiTicks > uiNestedTicks ? uiTicks - uiNestedTicks : 0 ) );
+    vnAddCounter( &m_pCounters->m_pBytes[ m_uiStage ], m_uiBytes );
+
+    m_pCounters->m_uiNestedTicks = m_uiStartNestedTicks + uiTicks;
+}
+
+#else
+
+inline CVStageTimer::CVStageTimer( UINT32 uiStage, UINT64 uiBytes ) {}
+inline CVStageTimer::~CVStageTimer() {}
+
+#endif
+
+#endif // __VN_COUNTERS_H__
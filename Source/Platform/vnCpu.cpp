@@ -0,0 +1,167 @@
+
+#include "vnCpu.h"
+#include <intrin.h>
+#include <stdlib.h>
+
+//
+// Feature bits reported by cpuid (leaf 1 in ecx and edx, leaf 7 in ebx), and the state
+// components that the operating system must save (in xcr0) for us to use each register file.
+//
+
+#define VN_CPU_EDX_SSE2                             ( 1 << 26 )
+#define VN_CPU_ECX_SSSE3                            ( 1 << 9 )
+#define VN_CPU_ECX_SSE42                            ( 1 << 20 )
+#define VN_CPU_ECX_POPCNT                           ( 1 << 23 )
+#define VN_CPU_ECX_OSXSAVE                          ( 1 << 27 )
+#define VN_CPU_ECX_AVX                              ( 1 << 28 )
+#define VN_CPU_EBX_AVX2                             ( 1 << 5 )
+#define VN_CPU_EBX_AVX512F                          ( 1 << 16 )
+#define VN_CPU_EBX_AVX512BW                         ( 1 << 30 )
+
+#define VN_CPU_XCR0_YMM                             ( 0x06 )        // xmm and ymm state
+#define VN_CPU_XCR0_ZMM                             ( 0xE6 )        // plus opmask and zmm state
+
+#define VN_CPU_LEVEL_COUNT                          ( VN_CPU_LEVEL_AVX512 + 1 )
+#define VN_CPU_LEVEL_UNKNOWN                        ( VN_MAX_UINT32 )
+
+static CONST CHAR * g_szCpuLevelNames[ VN_CPU_LEVEL_COUNT ] = { "scalar", "sse2", "ssse3", "sse42", "avx2", "avx512" };
+
+//
+// Every thread that races through the first call detects the same level, so the cached
+// value needs no further synchronization.
+//
+
+static volatile UINT32 g_uiCpuLevel = VN_CPU_LEVEL_UNKNOWN;
+
+//
+// vnDetectCpuLevel
+//
+//   Returns the highest level that both the processor and the operating system support.
+//
+
+UINT32 vnDetectCpuLevel()
+{
+    INT32 iInfo[ 4 ] = { 0 };
+
+    __cpuid( iInfo, 0 );
+
+    UINT32 uiMaxLeaf = iInfo[ 0 ];
+
+    if ( uiMaxLeaf < 1 )
+    {
+        return VN_CPU_LEVEL_SCALAR;
+    }
+
+    __cpuid( iInfo, 1 );
+
+    UINT32 uiFeatures = iInfo[ 2 ];
+
+    if ( !( iInfo[ 3 ] & VN_CPU_EDX_SSE2 ) )
+    {
+        return VN_CPU_LEVEL_SCALAR;
+    }
+
+    if ( !( uiFeatures & VN_CPU_ECX_SSSE3 ) )
+    {
+        return VN_CPU_LEVEL_SSE2;
+    }
+
+    if ( !( uiFeatures & VN_CPU_ECX_SSE42 ) || !( uiFeatures & VN_CPU_ECX_POPCNT ) )
+    {
+        return VN_CPU_LEVEL_SSSE3;
+    }
+
+    //
+    // The ymm (and zmm) registers are only usable if the operating system saves them across
+    // context switches, which we verify through xgetbv.
+    //
+
+    if ( !( uiFeatures & VN_CPU_ECX_OSXSAVE ) || !( uiFeatures & VN_CPU_ECX_AVX ) || uiMaxLeaf < 7 )
+    {
+        return VN_CPU_LEVEL_SSE42;
+    }
+
+    UINT64 uiStateMask = _xgetbv( 0 );
+
+    if ( VN_CPU_XCR0_YMM != ( uiStateMask & VN_CPU_XCR0_YMM ) )
+    {
+        return VN_CPU_LEVEL_SSE42;
+    }
+
+    __cpuidex( iInfo, 7, 0 );
+
+    if ( !( iInfo[ 1 ] & VN_CPU_EBX_AVX2 ) )
+    {
+        return VN_CPU_LEVEL_SSE42;
+    }
+
+    if ( !( iInfo[ 1 ] & VN_CPU_EBX_AVX512F ) || !( iInfo[ 1 ] & VN_CPU_EBX_AVX512BW ) || VN_CPU_XCR0_ZMM != ( uiStateMask & VN_CPU_XCR0_ZMM ) )
+    {
+        return VN_CPU_LEVEL_AVX2;
+    }
+
+    return VN_CPU_LEVEL_AVX512;
+}
+
+//
+// vnParseCpuLevel
+//
+//   Converts a level name or number into a level. Returns VN_CPU_LEVEL_UNKNOWN if szLevel
+//   does not name a valid level.
+//
+
+UINT32 vnParseCpuLevel( CONST CHAR * szLevel )
+{
+    for ( UINT32 i = 0; i < VN_CPU_LEVEL_COUNT; i++ )
+    {
+        if ( 0 == _stricmp( szLevel, g_szCpuLevelNames[ i ] ) )
+        {
+            return i;
+        }
+    }
+
+    CHAR * szEnd    = NULL;
+    UINT32 uiLevel  = strtoul( szLevel, &szEnd, 10 );
+
+    if ( szEnd == szLevel || *szEnd || uiLevel >= VN_CPU_LEVEL_COUNT )
+    {
+        return VN_CPU_LEVEL_UNKNOWN;
+    }
+
+    return uiLevel;
+}
+
+UINT32 vnQueryCpuLevel()
+{
+    if ( VN_CPU_LEVEL_UNKNOWN != g_uiCpuLevel )
+    {
+        return g_uiCpuLevel;
+    }
+
+    UINT32 uiLevel          = vnDetectCpuLevel();
+    CONST CHAR * szOverride = getenv( VN_CPU_LEVEL_VARIABLE );
+
+    if ( szOverride )
+    {
+        UINT32 uiOverride = vnParseCpuLevel( szOverride );
+
+        if ( VN_CPU_LEVEL_UNKNOWN != uiOverride )
+        {
+            uiLevel = VN_MIN2( uiLevel, uiOverride );
+        }
+    }
+
+    g_uiCpuLevel = uiLevel;
+
+    return uiLevel;
+}
+
+CONST CHAR * vnQueryCpuLevelName( UINT32 uiLevel )
+{
+    if ( uiLevel >= VN_CPU_LEVEL_COUNT )
+    {
+        return NULL;
+    }
+
+    return g_szCpuLevelNames[ uiLevel ];
+}
@@ -0,0 +1,87 @@
+
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnCpu.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+//
+
+#ifndef __VN_CPU_H__
+#define __VN_CPU_H__
+
+#include "vnBase.h"
+
+//
+// Instruction set levels
+//
+//   Each level implies every level below it. Kernels that are compiled for multiple levels 
+//   bind the best implementation that does not exceed the level of the host processor.
+//
+
+#define VN_CPU_LEVEL_SCALAR                         (0)
+#define VN_CPU_LEVEL_SSE2                           (1)
+#define VN_CPU_LEVEL_SSSE3                          (2)
+#define VN_CPU_LEVEL_SSE42                          (3)             // SSE4.2 and POPCNT
+#define VN_CPU_LEVEL_AVX2                           (4)
+#define VN_CPU_LEVEL_AVX512                         (5)             // AVX-512 F and BW
+
+//
+// No kernels are compiled for VN_CPU_LEVEL_AVX512 yet, so processors at this level bind the 
+// AVX2 kernels. The level is still reported so that callers can see what the host supports.
+//
+
+//
+// Setting this environment variable to a level name (e.g. "sse2") or number forces all
+// kernels down to that level, which allows every path to be exercised on a single machine.
+// Levels above those supported by the host are ignored.
+//
+
+#define VN_CPU_LEVEL_VARIABLE                       "VN_CPU_LEVEL"
+
+//
+// vnQueryCpuLevel
+//
+//   Returns the level that kernels should target. The processor is examined (and the 
+//   environment consulted) upon the first call, and the result is cached thereafter.
+//
+
+UINT32 vnQueryCpuLevel();
+
+//
+// vnQueryCpuLevelName
+//
+//   Returns a printable name for uiLevel, or NULL if it is not a valid level.
+//
+
+CONST CHAR * vnQueryCpuLevelName( UINT32 uiLevel );
+
+#endif // __VN_CPU_H__
@@ -0,0 +1,163 @@
+
+#include "vnMappedFile.h"
+
+CVMappedFile::CVMappedFile()
+{
+    m_hFile         = INVALID_HANDLE_VALUE;
+    m_hMapping      = NULL;
+    m_uiFileSize    = 0;
+    m_uiGranularity = 0;
+    m_pView         = NULL;
+}
+
+CVMappedFile::~CVMappedFile()
+{
+    if ( VN_FAILED( Close() ) )
+    {
+        vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+}
+
+VN_STATUS CVMappedFile::Open( CONST CHAR * szFilename )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !szFilename )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( VN_FAILED( Close() ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    SYSTEM_INFO pSystemInfo;
+    LARGE_INTEGER pFileSize;
+
+    GetSystemInfo( &pSystemInfo );
+
+    m_uiGranularity = pSystemInfo.dwAllocationGranularity;
+
+    //
+    // Readers typically walk the file from front to back, so we hint the cache manager
+    // accordingly. This allows it to read ahead and to discard pages that we have passed.
+    //
+
+    m_hFile = CreateFileA( szFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+
+    if ( INVALID_HANDLE_VALUE == m_hFile )
+    {
+        return vnPostError( VN_ERROR_IO_FAILURE );
+    }
+
+    if ( !GetFileSizeEx( m_hFile, &pFileSize ) || 0 == pFileSize.QuadPart )
+    {
+        Close();
+
+        return vnPostError( VN_ERROR_IO_FAILURE );
+    }
+
+    m_uiFileSize = pFileSize.QuadPart;
+    m_hMapping   = CreateFileMappingA( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+
+    if ( !m_hMapping )
+    {
+        Close();
+
+        return vnPostError( VN_ERROR_IO_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS CVMappedFile::Close()
+{
+    if ( VN_FAILED( Unmap() ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    if ( m_hMapping )
+    {
+        CloseHandle( m_hMapping );
+        m_hMapping = NULL;
+    }
+
+    if ( INVALID_HANDLE_VALUE != m_hFile )
+    {
+        CloseHandle( m_hFile );
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+
+    m_uiFileSize = 0;
+
+    return VN_SUCCESS;
+}
+
+UINT64 CVMappedFile::QuerySize() CONST
+{
+    return m_uiFileSize;
+}
+
+VN_STATUS CVMappedFile::Map( UINT64 uiOffset, UINT64 uiSize, OUT UINT8 ** ppData )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( 0 == uiSize || !ppData )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( !m_hMapping )
+        {
+            return vnPostError( VN_ERROR_NOT_READY );
+        }
+    }
+
+    if ( uiOffset > m_uiFileSize || uiSize > m_uiFileSize - uiOffset )
+    {
+        return vnPostError( VN_ERROR_INVALID_INDEX );
+    }
+
+    if ( VN_FAILED( Unmap() ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    //
+    // Views must begin on an allocation granularity boundary, so we map from the
+    // preceding boundary and skip the leading bytes.
+    //
+
+    UINT64 uiViewOffset = uiOffset - ( uiOffset % m_uiGranularity );
+    UINT64 uiViewSize   = uiSize + ( uiOffset - uiViewOffset );
+
+    if ( uiViewSize != (SIZE_T) uiViewSize )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    m_pView = MapViewOfFile( m_hMapping, FILE_MAP_READ, (DWORD) ( uiViewOffset >> 32 ), (DWORD) uiViewOffset, (SIZE_T) uiViewSize );
+
+    if ( !m_pView )
+    {
+        return vnPostError( VN_ERROR_IO_FAILURE );
+    }
+
+    (*ppData) = (UINT8 *) m_pView + ( uiOffset - uiViewOffset );
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS CVMappedFile::Unmap()
+{
+    if ( m_pView )
+    {
+        UnmapViewOfFile( m_pView );
+        m_pView = NULL;
+    }
+
+    return VN_SUCCESS;
+}
@@ -0,0 +1,85 @@
+
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnMappedFile.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+//
+
+#ifndef __VN_MAPPED_FILE_H__
+#define __VN_MAPPED_FILE_H__
+
+#include "vnBase.h"
+
+//
+// CVMappedFile
+//
+//   Provides read only access to windows of a (potentially very large) file through
+//   the virtual memory system. Only one window is mapped at a time, so the resident
+//   memory of a reader is bounded by the size of the windows it requests rather than
+//   the size of the file.
+//
+
+class VN_NONVIRTUAL CVMappedFile
+{
+    HANDLE                      m_hFile;
+    HANDLE                      m_hMapping;
+    UINT64                      m_uiFileSize;
+    UINT32                      m_uiGranularity;        // required alignment of window offsets
+    VOID *                      m_pView;
+
+private:
+
+    CVMappedFile( CONST CVMappedFile & rvalue );
+    CVMappedFile &              operator = ( CONST CVMappedFile & rvalue );
+
+public:
+
+    CVMappedFile();
+    ~CVMappedFile();
+
+    VN_STATUS                   Open( CONST CHAR * szFilename );
+    VN_STATUS                   Close();
+
+    UINT64                      QuerySize() CONST;
+
+    //
+    // Maps uiSize bytes of the file, beginning at uiOffset, and returns their address
+    // in ppData. Offsets need not be aligned. Any previously mapped window is released
+    // and the returned data remains valid until the next call to Map, Unmap or Close.
+    //
+
+    VN_STATUS                   Map( UINT64 uiOffset, UINT64 uiSize, OUT UINT8 ** ppData );
+    VN_STATUS                   Unmap();
+};
+
+#endif // __VN_MAPPED_FILE_H__
@@ -61,6 +61,35 @@
         #define VN_FAMILY_X64                                   // building with an x64 ISA
     #endif
 
+    //
+    // Instruction set extensions that the compiler may emit. SSE2 is
+    // part of the x64 baseline, SSSE3 is implied by /arch:AVX (or 
+    // higher), and AVX2 requires /arch:AVX2.
+    //
+
+    #if defined ( VN_FAMILY_X64 ) || ( defined ( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+        #define VN_SIMD_SSE2                                    // building with SSE2 support
+    #endif
+
+    #if defined ( __AVX__ ) || defined ( __SSSE3__ )
+        #define VN_SIMD_SSSE3                                   // building with SSSE3 support
+    #endif
+
+    #if defined ( __AVX2__ )
+        #define VN_SIMD_AVX2                                    // building with AVX2 support
+    #endif
+
+    //
+    // The compiler accepts intrinsics for any instruction set, regardless
+    // of /arch, so x86 and x64 builds compile the kernels of every level 
+    // and bind the best of them at runtime (see vnCpu.h). Intrinsics that
+    // operate on 64 bit general purpose registers remain x64 only.
+    //
+
+    #if defined ( VN_FAMILY_X64 ) || defined ( VN_FAMILY_X86 )
+        #define VN_SIMD_DISPATCH                                // building kernels for runtime selection
+    #endif
+
     //
     // Some processor families support multiple different 
     // runtimes, so we define appropriately here.
@@ -107,6 +136,16 @@
 
 #endif
 
+//
+// Platform specific storage classes
+//
+
+#if defined ( VN_PLATFORM_WINDOWS ) || defined ( VN_PLATFORM_XBOX360 )
+
+    #define VN_THREAD_LOCAL                 __declspec( thread )    // one instance per thread (POD types only)
+
+#endif
+
 //
 // Platform specific intrinsic types
 //
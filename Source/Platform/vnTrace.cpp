@@ -0,0 +1,320 @@
+
+#include "vnTrace.h"
+#include "vnAtomic.h"
+
+//
+// Every thread that records events registers its ring in our list upon first use. Rings
+// are never removed, and are reused by subsequent traces. A fiber local storage callback
+// retires the ring of each exiting thread, and new threads adopt retired rings (once they
+// have been drained) before creating their own. Our list, and the work of each flush, is 
+// thus bounded by the greatest number of threads that have recorded events at once.
+//
+
+static volatile BOOL g_bTraceActive = FALSE;
+static CVTraceRing * volatile g_pTraceRingList = NULL;
+static VN_THREAD_LOCAL CVTraceRing * g_pThreadTraceRing = NULL;
+
+//
+// vnRetireThreadTraceRing
+//
+//   Invoked as each registered thread exits. The thread records no further events.
+//
+
+VOID WINAPI vnRetireThreadTraceRing( VOID * pData )
+{
+    vnAtomicStore32( &( (CVTraceRing *) pData )->m_uiRetired, 1 );
+}
+
+static DWORD g_uiTraceFlsIndex = FlsAlloc( vnRetireThreadTraceRing );
+
+//
+// The state of the active trace is guarded by our lock, which serializes begin, flush and 
+// end. Threads that record events never acquire it.
+//
+
+static SRWLOCK g_pTraceLock             = SRWLOCK_INIT;
+static FILE * g_pTraceFile              = NULL;
+static BOOL g_bTraceFileEmpty           = TRUE;
+static UINT64 g_uiTraceBaseTicks        = 0;
+static UINT32 g_uiTraceBaseDropCount    = 0;
+
+//
+// vnRegisterThreadTraceRing
+//
+//   Adopts a retired ring for the calling thread, or creates a new ring and publishes it to 
+//   our list.
+//
+
+CVTraceRing * vnRegisterThreadTraceRing()
+{
+    CVTraceRing * pRing = (CVTraceRing *) vnAtomicLoadPointer( (VOID * volatile *) &g_pTraceRingList );
+
+    for ( ; pRing; pRing = pRing->m_pNext )
+    {
+        if ( 1 != vnAtomicCompareExchange32( &pRing->m_uiRetired, 0, 1 ) )
+        {
+            continue;
+        }
+
+        //
+        // Events that remain within a ring are attributed to its current thread, so we only
+        // adopt rings that have been drained, and return any others to be flushed.
+        //
+
+        if ( vnAtomicLoad32( &pRing->m_uiReadIndex ) == pRing->m_uiWriteIndex )
+        {
+            break;
+        }
+
+        vnAtomicStore32( &pRing->m_uiRetired, 1 );
+    }
+
+    if ( !pRing )
+    {
+        pRing = new CVTraceRing;
+
+        vnZeroMemory( pRing, sizeof( CVTraceRing ) );
+
+        VOID * pHead = NULL;
+
+        do
+        {
+            pHead          = vnAtomicLoadPointer( (VOID * volatile *) &g_pTraceRingList );
+            pRing->m_pNext = (CVTraceRing *) pHead;
+        }
+        while ( pHead != vnAtomicCompareExchangePointer( (VOID * volatile *) &g_pTraceRingList, pRing, pHead ) );
+    }
+
+    pRing->m_uiThreadId = GetCurrentThreadId();
+
+    //
+    // Without an index our ring is simply never retired.
+    //
+
+    if ( FLS_OUT_OF_INDEXES != g_uiTraceFlsIndex )
+    {
+        FlsSetValue( g_uiTraceFlsIndex, pRing );
+    }
+
+    g_pThreadTraceRing = pRing;
+
+    return pRing;
+}
+
+CVTraceRing * vnQueryThreadTraceRing()
+{
+    if ( !g_bTraceActive )
+    {
+        return NULL;
+    }
+
+    return ( g_pThreadTraceRing ? g_pThreadTraceRing : vnRegisterThreadTraceRing() );
+}
+
+VOID vnRecordTraceEvent( CVTraceRing * pRing, CONST CHAR * szName, UINT64 uiBeginTicks, UINT64 uiEndTicks )
+{
+    UINT32 uiWriteIndex = pRing->m_uiWriteIndex;
+
+    if ( uiWriteIndex - vnAtomicLoad32( &pRing->m_uiReadIndex ) >= VN_TRACE_RING_SIZE )
+    {
+        pRing->m_uiDropCount++;
+
+        return;
+    }
+
+    CVTraceEvent * pEvent = &pRing->m_pEvents[ uiWriteIndex & ( VN_TRACE_RING_SIZE - 1 ) ];
+
+    pEvent->m_szName       = szName;
+    pEvent->m_uiBeginTicks = uiBeginTicks;
+    pEvent->m_uiEndTicks   = uiEndTicks;
+
+    //
+    // Advancing our write index publishes the event to the flushing thread.
+    //
+
+    vnAtomicStore32( &pRing->m_uiWriteIndex, uiWriteIndex + 1 );
+}
+
+//
+// vnQueryTotalDropCount
+//
+//   Returns the number of events dropped by all threads since they began recording.
+//
+
+UINT32 vnQueryTotalDropCount()
+{
+    UINT32 uiDropCount  = 0;
+    CVTraceRing * pRing = (CVTraceRing *) vnAtomicLoadPointer( (VOID * volatile *) &g_pTraceRingList );
+
+    for ( ; pRing; pRing = pRing->m_pNext )
+    {
+        uiDropCount += pRing->m_uiDropCount;
+    }
+
+    return uiDropCount;
+}
+
+//
+// vnWriteTraceEvents
+//
+//   Drains every ring into our trace file, or simply discards their contents if no trace is
+//   open. Our lock must be held by the caller.
+//
+
+VOID vnWriteTraceEvents()
+{
+    CVTraceRing * pRing = (CVTraceRing *) vnAtomicLoadPointer( (VOID * volatile *) &g_pTraceRingList );
+    UINT32 uiProcessId  = GetCurrentProcessId();
+
+    for ( ; pRing; pRing = pRing->m_pNext )
+    {
+        UINT32 uiReadIndex  = pRing->m_uiReadIndex;
+        UINT32 uiWriteIndex = vnAtomicLoad32( &pRing->m_uiWriteIndex );
+
+        for ( ; g_pTraceFile && uiReadIndex != uiWriteIndex; uiReadIndex++ )
+        {
+            CVTraceEvent * pEvent = &pRing->m_pEvents[ uiReadIndex & ( VN_TRACE_RING_SIZE - 1 ) ];
+
+            //
+            // Scopes that began before our trace may complete within it, so we skip them.
+            //
+
+            if ( pEvent->m_uiBeginTicks < g_uiTraceBaseTicks )
+            {
+                continue;
+            }
+
+            fprintf( g_pTraceFile, "%s{\"name\":\"", g_bTraceFileEmpty ? "" : ",\n" );
+
+            for ( CONST CHAR * szName = pEvent->m_szName; *szName; szName++ )
+            {
+                if ( '"' == *szName || '\\' == *szName )
+                {
+                    fputc( '\\', g_pTraceFile );
+                }
+
+                fputc( *szName, g_pTraceFile );
+            }
+
+            fprintf( g_pTraceFile, "\",\"cat\":\"insight\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}",
+                     vnConvertCounterTicks( pEvent->m_uiBeginTicks - g_uiTraceBaseTicks ) / 1000.0,
+                     vnConvertCounterTicks( pEvent->m_uiEndTicks - pEvent->m_uiBeginTicks ) / 1000.0,
+                     uiProcessId, pRing->m_uiThreadId );
+
+            g_bTraceFileEmpty = FALSE;
+        }
+
+        //
+        // Advancing our read index returns the space of these events to the owning thread.
+        //
+
+        vnAtomicStore32( &pRing->m_uiReadIndex, uiWriteIndex );
+    }
+}
+
+VN_STATUS vnBeginTrace( CONST CHAR * szFilename )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !szFilename )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    AcquireSRWLockExclusive( &g_pTraceLock );
+
+    if ( g_pTraceFile )
+    {
+        ReleaseSRWLockExclusive( &g_pTraceLock );
+
+        return vnPostError( VN_ERROR_NOT_READY );
+    }
+
+    //
+    // Discard any events that were recorded after the previous trace ended.
+    //
+
+    vnWriteTraceEvents();
+
+    g_pTraceFile = fopen( szFilename, "wb" );
+
+    if ( !g_pTraceFile )
+    {
+        ReleaseSRWLockExclusive( &g_pTraceLock );
+
+        return vnPostError( VN_ERROR_IO_FAILURE );
+    }
+
+    //
+    // We use the array form of the trace format, which remains loadable even if the trace is
+    // never completed (e.g. if the process exits early).
+    //
+
+    fputs( "[\n", g_pTraceFile );
+
+    g_bTraceFileEmpty       = TRUE;
+    g_uiTraceBaseTicks      = vnQueryCounterTicks();
+    g_uiTraceBaseDropCount  = vnQueryTotalDropCount();
+    g_bTraceActive          = TRUE;
+
+    ReleaseSRWLockExclusive( &g_pTraceLock );
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnFlushTrace()
+{
+    AcquireSRWLockExclusive( &g_pTraceLock );
+
+    if ( !g_pTraceFile )
+    {
+        ReleaseSRWLockExclusive( &g_pTraceLock );
+
+        return vnPostError( VN_ERROR_NOT_READY );
+    }
+
+    vnWriteTraceEvents();
+
+    fflush( g_pTraceFile );
+
+    ReleaseSRWLockExclusive( &g_pTraceLock );
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS vnEndTrace()
+{
+    AcquireSRWLockExclusive( &g_pTraceLock );
+
+    if ( !g_pTraceFile )
+    {
+        ReleaseSRWLockExclusive( &g_pTraceLock );
+
+        return vnPostError( VN_ERROR_NOT_READY );
+    }
+
+    g_bTraceActive = FALSE;
+
+    vnWriteTraceEvents();
+
+    fputs( "\n]\n", g_pTraceFile );
+
+    BOOL bFailed = ( 0 != ferror( g_pTraceFile ) );
+
+    if ( 0 != fclose( g_pTraceFile ) )
+    {
+        bFailed = TRUE;
+    }
+
+    g_pTraceFile = NULL;
+
+    ReleaseSRWLockExclusive( &g_pTraceLock );
+
+    return ( bFailed ? vnPostError( VN_ERROR_IO_FAILURE ) : VN_SUCCESS );
+}
+
+UINT32 vnQueryTraceDropCount()
+{
+    return vnQueryTotalDropCount() - g_uiTraceBaseDropCount;
+}
@@ -0,0 +1,195 @@
+
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnTrace.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+
+#ifndef __VN_TRACE_H__
+#define __VN_TRACE_H__
+
+#include "vnBase.h"
+#include "vnCounters.h"
+
+//
+// Tracing
+//
+//   While a trace is active, each traced scope records a single event holding its begin and
+//   end times into a ring owned by the calling thread. Rings are written without locks, and
+//   are drained to a file in the Chrome trace event format (which may be loaded within
+//   chrome://tracing or Perfetto) whenever the trace is flushed. Tracing is compiled in when 
+//   VN_ENABLE_TRACING is non-zero, and otherwise costs a single function call and branch per
+//   scope while no trace is active.
+//
+//   A thread that fills its ring drops its subsequent events until the ring is next flushed,
+//   so long running traces should be flushed periodically.
+//
+
+#define VN_ENABLE_TRACING                           (1)
+#define VN_TRACE_RING_SIZE                          (16384)         // events per thread, a power of two
+
+struct CVTraceEvent
+{
+    CONST CHAR *                m_szName;
+    UINT64                      m_uiBeginTicks;
+    UINT64                      m_uiEndTicks;
+};
+
+//
+// CVTraceRing
+//
+//   The events of a single thread. Only the owning thread advances the write index, and only
+//   a flush advances the read index. Once that thread exits its ring is retired, and may be
+//   adopted by a new thread after its remaining events have been flushed.
+//
+
+struct CVTraceRing
+{
+    CVTraceEvent                m_pEvents[ VN_TRACE_RING_SIZE ];
+    volatile UINT32             m_uiWriteIndex;
+    volatile UINT32             m_uiReadIndex;
+    volatile UINT32             m_uiDropCount;
+    volatile UINT32             m_uiRetired;                // non-zero once the owning thread exits
+    UINT32                      m_uiThreadId;
+    CVTraceRing *               m_pNext;
+};
+
+//
+// vnBeginTrace
+//
+//   Creates szFilename and begins recording events from all threads. Only one trace may be 
+//   active at a time.
+//
+
+VN_STATUS vnBeginTrace( CONST CHAR * szFilename );
+
+//
+// vnFlushTrace
+//
+//   Appends every event recorded since the previous flush to the active trace file. This may
+//   be called from any thread while others continue to record.
+//
+
+VN_STATUS vnFlushTrace();
+
+//
+// vnEndTrace
+//
+//   Stops recording, flushes all remaining events, and completes the trace file. 
+//
+
+VN_STATUS vnEndTrace();
+
+//
+// vnQueryTraceDropCount
+//
+//   Returns the number of events that were dropped by the active (or most recent) trace 
+//   because a ring was full.
+//
+
+UINT32 vnQueryTraceDropCount();
+
+//
+// vnQueryThreadTraceRing
+//
+//   Returns the ring of the calling thread, or NULL if no trace is active.
+//
+
+CVTraceRing * vnQueryThreadTraceRing();
+
+//
+// vnRecordTraceEvent
+//
+//   Appends an event to pRing, which must belong to the calling thread.
+//
+
+VOID vnRecordTraceEvent( CVTraceRing * pRing, CONST CHAR * szName, UINT64 uiBeginTicks, UINT64 uiEndTicks );
+
+//
+// CVTraceScope
+//
+//   Records an event that spans the lifetime of the scope. szName must remain valid for the
+//   duration of the trace (e.g. a string literal, or __VN_FUNCTION__).
+//
+
+class VN_NONVIRTUAL CVTraceScope
+{
+#if VN_ENABLE_TRACING
+
+    CVTraceRing *               m_pRing;
+    CONST CHAR *                m_szName;
+    UINT64                      m_uiBeginTicks;
+
+#endif
+
+private:
+
+    CVTraceScope( CONST CVTraceScope & rvalue );
+    CVTraceScope &              operator = ( CONST CVTraceScope & rvalue );
+
+public:
+
+    CVTraceScope( CONST CHAR * szName );
+    ~CVTraceScope();
+};
+
+#if VN_ENABLE_TRACING
+
+inline CVTraceScope::CVTraceScope( CONST CHAR * szName )
+{
+    m_pRing = vnQueryThreadTraceRing();
+
+    if ( m_pRing )
+    {
+        m_szName       = szName;
+        m_uiBeginTicks = vnQueryCounterTicks();
+    }
+}
+
+inline CVTraceScope::~CVTraceScope()
+{
+    if ( m_pRing )
+    {
+        vnRecordTraceEvent( m_pRing, m_szName, m_uiBeginTicks, vnQueryCounterTicks() );
+    }
+}
+
+#else
+
+inline CVTraceScope::CVTraceScope( CONST CHAR * szName ) {}
+inline CVTraceScope::~CVTraceScope() {}
+
+#endif
+
+#define VN_TRACE_FUNCTION()                         CVTraceScope pTraceScope( __VN_FUNCTION__ )
+
+#endif // __VN_TRACE_H__
@@ -0,0 +1,41 @@
+
+#include "vnTest.h"
+#include <string.h>
+
+//
+// Benchmark table
+//
+//   Benchmarks run in order. Pass the name of a benchmark to run only that one, and set 
+//   VN_CPU_LEVEL to time the kernels of a lower level.
+//
+
+struct VN_BENCHMARK_ENTRY
+{
+    CONST CHAR *            szName;
+    VN_BENCHMARK_FUNCTION   pfnBenchmark;
+};
+
+static CONST VN_BENCHMARK_ENTRY g_pBenchmarks[] = 
+{
+    { "TransformColumns",       vnBenchmarkTransformColumns },
+    { "ResizePyramid",          vnBenchmarkResizePyramid },
+};
+
+int main( int argc, char ** argv )
+{
+    printf( "Insight benchmarks (%s kernels)\n", vnQueryCpuLevelName( vnQueryCpuLevel() ) );
+
+    for ( UINT32 i = 0; i < VN_TEST_COUNT_OF( g_pBenchmarks ); i++ )
+    {
+        if ( argc > 1 && 0 != strcmp( argv[ 1 ], g_pBenchmarks[ i ].szName ) )
+        {
+            continue;
+        }
+
+        printf( "\n%s\n\n", g_pBenchmarks[ i ].szName );
+
+        g_pBenchmarks[ i ].pfnBenchmark();
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+
+#include "vnTest.h"
+
+#define VN_BENCHMARK_RESIZE_TARGET_SIZE             (64)
+
+//
+// vnTimeResize
+//
+//   Returns the mean time, in milliseconds, of a resize of pSource to the target size with 
+//   uiFilter. The first resize grows the output and workspace, so it is excluded from the timing.
+//
+
+FLOAT64 vnTimeResize( CONST CVImage & pSource, VN_IMAGE_RESIZE_FILTER uiFilter, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace )
+{
+    UINT32 uiIterations = 0;
+    FLOAT64 fSeconds    = 0;
+
+    if ( VN_FAILED( vnResizeImage( pSource, VN_BENCHMARK_RESIZE_TARGET_SIZE, VN_BENCHMARK_RESIZE_TARGET_SIZE, uiFilter, pOutput, pWorkspace ) ) )
+    {
+        return 0;
+    }
+
+    UINT64 uiStartTicks = vnQueryCounterTicks();
+
+    do
+    {
+        vnResizeImage( pSource, VN_BENCHMARK_RESIZE_TARGET_SIZE, VN_BENCHMARK_RESIZE_TARGET_SIZE, uiFilter, pOutput, pWorkspace );
+
+        uiIterations++;
+        fSeconds = vnQueryTestSeconds( uiStartTicks );
+
+    } while ( uiIterations < VN_BENCHMARK_MIN_ITERATIONS || fSeconds < VN_BENCHMARK_MIN_SECONDS );
+
+    return ( fSeconds * 1000.0 ) / uiIterations;
+}
+
+//
+// vnBenchmarkResizePyramid
+//
+//   Times the pyramid filter against the direct filters (coverage, fixed point and area) for
+//   4:3 gray sources of roughly 1 to 100 megapixels, each resized to a 64x64 thumbnail.
+//
+
+VOID vnBenchmarkResizePyramid()
+{
+    CONST UINT32 uiSizes[][ 2 ] = { { 1152, 864 }, { 4000, 3000 }, { 8160, 6120 }, { 11548, 8660 } };
+    CONST VN_IMAGE_RESIZE_FILTER uiFilters[] = { VN_IMAGE_RESIZE_COVERAGE, VN_IMAGE_RESIZE_FIXED_POINT, VN_IMAGE_RESIZE_AREA, VN_IMAGE_RESIZE_PYRAMID };
+
+    CVImage * pOutput    = NULL;
+    CVImage * pWorkspace = NULL;
+
+    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, 1, 1, &pOutput ) ) ||
+         VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, 1, 1, &pWorkspace ) ) )
+    {
+        printf( "  failed to create the output images\n" );
+
+        vnDestroyImage( pOutput );
+
+        return;
+    }
+
+    printf( "  input     coverage (ms)  fixed (ms)  area (ms)  pyramid (ms)\n" );
+
+    for ( UINT32 i = 0; i < VN_TEST_COUNT_OF( uiSizes ); i++ )
+    {
+        CVImage * pSource = NULL;
+
+        if ( VN_FAILED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, uiSizes[ i ][ 0 ], uiSizes[ i ][ 1 ], VN_TEST_PATTERN_NOISE, &pSource ) ) )
+        {
+            printf( "  failed to create the test images\n" );
+
+            break;
+        }
+
+        FLOAT64 fTimes[ VN_TEST_COUNT_OF( uiFilters ) ];
+
+        for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( uiFilters ); k++ )
+        {
+            fTimes[ k ] = vnTimeResize( *pSource, uiFilters[ k ], pOutput, pWorkspace );
+        }
+
+        printf( "  %5.1f MP  %13.2f  %10.2f  %9.2f  %12.2f\n", ( (FLOAT64) uiSizes[ i ][ 0 ] * uiSizes[ i ][ 1 ] ) / 1000000.0,
+                fTimes[ 0 ], fTimes[ 1 ], fTimes[ 2 ], fTimes[ 3 ] );
+
+        vnDestroyImage( pSource );
+    }
+
+    vnDestroyImage( pWorkspace );
+    vnDestroyImage( pOutput );
+}
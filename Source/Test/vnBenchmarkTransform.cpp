@@ -0,0 +1,116 @@
+
+#include "vnTest.h"
+
+//
+// Benchmark switch (see vnImageTransform.cpp)
+//
+
+VOID vnEnableStridedTransformColumns( BOOL bEnable );
+
+//
+// vnTimeTransform
+//
+//   Returns the mean time, in microseconds, of a full transform of pPlane. The first transform
+//   of each size builds its plans, so it is excluded from the timing.
+//
+
+FLOAT64 vnTimeTransform( CONST CVImage & pPlane, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace )
+{
+    UINT32 uiIterations = 0;
+    FLOAT64 fSeconds    = 0;
+
+    if ( VN_FAILED( vnTransformImage( pPlane, VN_IMAGE_TRANSFORM_DEFAULT, pOutput, pWorkspace ) ) )
+    {
+        return 0;
+    }
+
+    UINT64 uiStartTicks = vnQueryCounterTicks();
+
+    do
+    {
+        vnTransformImage( pPlane, VN_IMAGE_TRANSFORM_DEFAULT, pOutput, pWorkspace );
+
+        uiIterations++;
+        fSeconds = vnQueryTestSeconds( uiStartTicks );
+
+    } while ( uiIterations < VN_BENCHMARK_MIN_ITERATIONS || fSeconds < VN_BENCHMARK_MIN_SECONDS );
+
+    return ( fSeconds * 1000000.0 ) / uiIterations;
+}
+
+//
+// vnTimeTransformColumns
+//
+//   Times full transforms of pPlane with our default column pass, and with the strided 
+//   reference column pass, storing each mean time (in microseconds) in pfTimes.
+//
+
+VOID vnTimeTransformColumns( CONST CVImage & pPlane, INOUT CVImage * pOutput, INOUT CVImage * pWorkspace, OUT FLOAT64 * pfTimes )
+{
+    pfTimes[ 0 ] = vnTimeTransform( pPlane, pOutput, pWorkspace );
+
+    vnEnableStridedTransformColumns( TRUE );
+
+    pfTimes[ 1 ] = vnTimeTransform( pPlane, pOutput, pWorkspace );
+
+    vnEnableStridedTransformColumns( FALSE );
+}
+
+//
+// vnBenchmarkTransformColumns
+//
+//   Times full plane transforms for thumb sizes 8 through 256, with both the default column
+//   pass (vector column groups or the tiled transpose, depending upon the host) and the strided
+//   reference column pass. The power-of-two planes are square with an edge of 4 x thumb, as 
+//   when hashing. The odd-width planes are one pixel wider, so their rows take the direct form.
+//
+
+VOID vnBenchmarkTransformColumns()
+{
+    CVImage * pOutput    = NULL;
+    CVImage * pWorkspace = NULL;
+
+    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, 1, 1, &pOutput ) ) ||
+         VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, 1, 1, &pWorkspace ) ) )
+    {
+        printf( "  failed to create the output images\n" );
+
+        vnDestroyImage( pOutput );
+
+        return;
+    }
+
+    printf( "  thumb       pow2 plane (us)         odd-width plane (us)\n" );
+    printf( "            default      strided      default      strided\n" );
+
+    for ( UINT32 uiThumbSize = 8; uiThumbSize <= 256; uiThumbSize <<= 1 )
+    {
+        UINT32 uiEdge       = uiThumbSize << 2;
+        CVImage * pPow2     = NULL;
+        CVImage * pOddWidth = NULL;
+
+        if ( VN_FAILED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, uiEdge, uiEdge, VN_TEST_PATTERN_NOISE, &pPow2 ) ) ||
+             VN_FAILED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, uiEdge + 1, uiEdge, VN_TEST_PATTERN_NOISE, &pOddWidth ) ) )
+        {
+            printf( "  failed to create the test images\n" );
+
+            vnDestroyImage( pPow2 );
+
+            break;
+        }
+
+        FLOAT64 fPow2Times[ 2 ];
+        FLOAT64 fOddWidthTimes[ 2 ];
+
+        vnTimeTransformColumns( *pPow2, pOutput, pWorkspace, fPow2Times );
+        vnTimeTransformColumns( *pOddWidth, pOutput, pWorkspace, fOddWidthTimes );
+
+        printf( "  %5i  %10.1f  %11.1f  %11.1f  %11.1f\n", uiThumbSize, fPow2Times[ 0 ], fPow2Times[ 1 ], fOddWidthTimes[ 0 ], fOddWidthTimes[ 1 ] );
+
+        vnDestroyImage( pOddWidth );
+        vnDestroyImage( pPow2 );
+    }
+
+    vnDestroyImage( pWorkspace );
+    vnDestroyImage( pOutput );
+}
@@ -0,0 +1,133 @@
+
+#include "vnTest.h"
+
+//
+// Hash entry points (see vnInsight.cpp)
+//
+
+UINT64 vnHashImage64( CONST CVImage & pInput );
+
+UINT32 vnQueryTestRandom( INOUT UINT32 * puiState )
+{
+    (*puiState) = (*puiState) * 1664525 + 1013904223;
+
+    return (*puiState);
+}
+
+//
+// vnQueryTestPatternValue
+//
+//   Returns the value of channel uiChannel of pixel (i, j) of a (uiWidth x uiHeight) pattern.
+//
+
+UINT8 vnQueryTestPatternValue( UINT32 uiPattern, UINT32 i, UINT32 j, UINT32 uiChannel, UINT32 uiWidth, UINT32 uiHeight, INOUT UINT32 * puiState )
+{
+    switch ( uiPattern )
+    {
+        case VN_TEST_PATTERN_GRADIENT:
+        {
+            return ( ( 255 * i ) / uiWidth + ( 255 * j ) / uiHeight ) / 2 + uiChannel * 29;
+        }
+
+        case VN_TEST_PATTERN_CHECKER:
+        {
+            return ( ( ( i / 13 ) + ( j / 11 ) + uiChannel ) & 1 ) ? 230 : 20;
+        }
+
+        case VN_TEST_PATTERN_RINGS:
+        {
+            INT64 iX = (INT64) i - uiWidth / 2;
+            INT64 iY = (INT64) j - uiHeight / 2;
+
+            return (UINT8) ( ( iX * iX + iY * iY ) >> 6 ) + uiChannel * 53;
+        }
+
+        default:
+        {
+            return vnQueryTestRandom( puiState ) >> 24;
+        }
+    }
+}
+
+VN_STATUS vnCreateTestImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiPattern, OUT CVImage ** ppImage )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( uiPattern >= VN_TEST_PATTERN_COUNT || !ppImage )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    if ( VN_FAILED( vnCreateImage( format, uiWidth, uiHeight, ppImage ) ) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    UINT32 uiState     = 0x1234567 + uiPattern;
+    UINT32 uiPixelSize = (*ppImage)->QueryBitsPerPixel() >> 3;
+
+    for ( UINT32 j = 0; j < uiHeight; j++ )
+    {
+        UINT8 * pLine = (*ppImage)->QueryData() + (*ppImage)->BlockOffset( 0, j );
+
+        for ( UINT32 i = 0; i < uiWidth; i++ )
+        {
+            for ( UINT32 c = 0; c < uiPixelSize; c++ )
+            {
+                pLine[ i * uiPixelSize + c ] = vnQueryTestPatternValue( uiPattern, i, j, c, uiWidth, uiHeight, &uiState );
+            }
+        }
+    }
+
+    //
+    // The chroma planes of planar formats follow the Y plane, and receive noise so that any 
+    // operation that (incorrectly) reads them is caught.
+    //
+
+    UINT8 * pChroma       = (*ppImage)->QueryData() + (UINT64) (*ppImage)->RowPitch() * uiHeight;
+    UINT64 uiChromaSize   = VN_IMAGE_CHROMA_SIZE( format, uiWidth, uiHeight );
+
+    for ( UINT64 k = 0; k < uiChromaSize; k++ )
+    {
+        pChroma[ k ] = vnQueryTestRandom( &uiState ) >> 24;
+    }
+
+    return VN_SUCCESS;
+}
+
+UINT64 vnUpdateTestChecksum( UINT64 uiChecksum, UINT32 uiValue )
+{
+    for ( UINT32 i = 0; i < 4; i++ )
+    {
+        uiChecksum = ( uiChecksum ^ ( ( uiValue >> ( i << 3 ) ) & 0xFF ) ) * 0x100000001b3ULL;
+    }
+
+    return uiChecksum;
+}
+
+FLOAT64 vnQueryTestSeconds( UINT64 uiStartTicks )
+{
+    return vnConvertCounterTicks( vnQueryCounterTicks() - uiStartTicks ) / 1000000000.0;
+}
+
+BOOL vnTestHashesMatch( CONST CVImage & pFirst, CONST CVImage & pSecond )
+{
+    CONST UINT32 uiConfigs[][ 2 ] = { { 8, 8 }, { VN_INSIGHT_DEFAULT_THUMB_SIZE, VN_INSIGHT_DEFAULT_HASH_SIZE } };
+
+    VN_TEST_CHECK( vnHashImage64( pFirst ) == vnHashImage64( pSecond ) );
+
+    for ( UINT32 c = 0; c < VN_TEST_COUNT_OF( uiConfigs ); c++ )
+    {
+        CVBitStream pFirstStream;
+        CVBitStream pSecondStream;
+
+        VN_TEST_CHECK( ( uiConfigs[ c ][ 1 ] << 3 ) == pFirstStream.ResizeCapacity( uiConfigs[ c ][ 1 ] << 3 ) );
+        VN_TEST_CHECK( ( uiConfigs[ c ][ 1 ] << 3 ) == pSecondStream.ResizeCapacity( uiConfigs[ c ][ 1 ] << 3 ) );
+        VN_TEST_CHECK( VN_SUCCEEDED( vnHashImage( pFirst, uiConfigs[ c ][ 0 ], uiConfigs[ c ][ 1 ], &pFirstStream ) ) );
+        VN_TEST_CHECK( VN_SUCCEEDED( vnHashImage( pSecond, uiConfigs[ c ][ 0 ], uiConfigs[ c ][ 1 ], &pSecondStream ) ) );
+        VN_TEST_CHECK( pFirstStream == pSecondStream );
+    }
+
+    return TRUE;
+}
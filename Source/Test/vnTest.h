@@ -0,0 +1,174 @@
+
+//
+// Copyright (c) 2002-2014 Joe Bertolami. All Right Reserved.
+//
+// vnTest.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   This module is part of the Vision Basecode and has been compacted and reduced
+//   for inclusion within Insight.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+//
+
+#ifndef __VN_TEST_H__
+#define __VN_TEST_H__
+
+#include "../vnInsight.h"
+#include <stdio.h>
+
+//
+// Tests
+//
+//   Each test is a function that returns TRUE when it passes. A failed check prints its
+//   location and expression, and fails the test immediately. Tests and benchmarks share the 
+//   deterministic test images below, so that their results are comparable across runs.
+//
+
+#define VN_TEST_CHECK( x )                                                                  \
+    do                                                                                      \
+    {                                                                                       \
+        if ( !( x ) )                                                                       \
+        {                                                                                   \
+            printf( "    %s(%i): check failed: %s\n", __FILE__, __LINE__, #x );            \
+            return FALSE;                                                                   \
+        }                                                                                   \
+    } while ( 0 )
+
+#define VN_TEST_COUNT_OF( x )       ( sizeof( x ) / sizeof( (x)[0] ) )
+
+typedef BOOL ( *VN_TEST_FUNCTION )();
+
+//
+// Test images
+//
+//   VN_TEST_PATTERN_GRADIENT:   smooth diagonal ramps.
+//   VN_TEST_PATTERN_CHECKER:    a checkerboard of hard edges.
+//   VN_TEST_PATTERN_RINGS:      concentric rings whose frequency increases with the radius.
+//   VN_TEST_PATTERN_NOISE:      uniform pseudo-random noise.
+//
+
+#define VN_TEST_PATTERN_GRADIENT                    (0)
+#define VN_TEST_PATTERN_CHECKER                     (1)
+#define VN_TEST_PATTERN_RINGS                       (2)
+#define VN_TEST_PATTERN_NOISE                       (3)
+#define VN_TEST_PATTERN_COUNT                       (4)
+
+//
+// vnCreateTestImage
+//
+//   Creates a (uiWidth x uiHeight) image of an 8 bit format and fills it with uiPattern. Each 
+//   channel of a pixel holds a different, but equally deterministic, value. The chroma planes
+//   of planar formats are filled with noise.
+//
+
+VN_STATUS vnCreateTestImage( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiPattern, OUT CVImage ** ppImage );
+
+//
+// vnQueryTestRandom
+//
+//   Advances a linear congruential generator and returns its next 32 bit value. Tests seed 
+//   their own state so that their inputs do not depend upon the order in which they run.
+//
+
+UINT32 vnQueryTestRandom( INOUT UINT32 * puiState );
+
+//
+// vnUpdateTestChecksum
+//
+//   Folds a 32 bit value into a 64 bit FNV-1a checksum, a byte at a time from the least
+//   significant byte, and returns the result. Start a new checksum with 
+//   VN_TEST_CHECKSUM_BASIS. Checksums do not depend upon the byte order of the host.
+//
+
+#define VN_TEST_CHECKSUM_BASIS                      (0xcbf29ce484222325ULL)
+
+UINT64 vnUpdateTestChecksum( UINT64 uiChecksum, UINT32 uiValue );
+
+//
+// vnTestHashesMatch
+//
+//   Hashes two images through vnHashImage64 and through vnHashImage at both the 8 byte and
+//   the default sizes, and returns TRUE when every pair of hashes is identical.
+//
+
+BOOL vnTestHashesMatch( CONST CVImage & pFirst, CONST CVImage & pSecond );
+
+//
+// vnQueryTestSeconds
+//
+//   Returns the time elapsed since uiStartTicks (see vnQueryCounterTicks), in seconds.
+//
+
+FLOAT64 vnQueryTestSeconds( UINT64 uiStartTicks );
+
+//
+// Test functions
+//
+
+BOOL vnTestFastTransformHashes();
+
+BOOL vnTestFixedResizeBound();
+
+BOOL vnTestSpecializedHashers();
+
+BOOL vnTestFixedPointBasis();
+
+BOOL vnTestGoldenHashes();
+
+BOOL vnTestDesaturateLines();
+
+BOOL vnTestLumaHashes();
+
+BOOL vnTestViewHashes();
+
+BOOL vnTestStreamedHashes();
+
+BOOL vnTestFileHashes();
+
+BOOL vnTestTransformBatch();
+
+BOOL vnTestCompactCoefficients();
+
+//
+// Benchmarks
+//
+//   Each benchmark prints a table of timings. Every measurement repeats for at least 
+//   VN_BENCHMARK_MIN_ITERATIONS iterations and VN_BENCHMARK_MIN_SECONDS seconds, and reports
+//   the mean time of an iteration. Benchmarks are only meaningful in release builds.
+//
+
+#define VN_BENCHMARK_MIN_ITERATIONS                 (3)
+#define VN_BENCHMARK_MIN_SECONDS                    (0.25)
+
+typedef VOID ( *VN_BENCHMARK_FUNCTION )();
+
+VOID vnBenchmarkTransformColumns();
+
+VOID vnBenchmarkResizePyramid();
+
+#endif // __VN_TEST_H__
@@ -0,0 +1,134 @@
+
+#include "vnTest.h"
+
+#define VN_TEST_DESATURATE_MAX_LENGTH               (99)
+#define VN_TEST_DESATURATE_MAX_OFFSET               (31)
+#define VN_TEST_DESATURATE_GUARD                    (0xA5)
+
+//
+// vnTestDesaturateLines
+//
+//   The vector desaturation kernels process whole blocks of pixels and finish each line with a
+//   scalar tail, so every line length up to several blocks of the widest kernel is checked, at
+//   every source and destination alignment. Each output must match vnDesaturatePixel exactly,
+//   and the bytes that follow the line must be left untouched. Run the test under each
+//   VN_CPU_LEVEL to cover every kernel.
+//
+
+BOOL vnTestDesaturateLines()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_B8G8R8, VN_IMAGE_FORMAT_R8G8B8A8, VN_IMAGE_FORMAT_B8G8R8A8 };
+
+    UINT8 pbyInput[ VN_TEST_DESATURATE_MAX_LENGTH * 4 + VN_TEST_DESATURATE_MAX_OFFSET + 1 ];
+    UINT8 pbyOutput[ VN_TEST_DESATURATE_MAX_LENGTH + VN_TEST_DESATURATE_MAX_OFFSET + 16 ];
+    UINT32 uiState = 0x2468ace;
+
+    for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( pbyInput ); k++ )
+    {
+        pbyInput[ k ] = vnQueryTestRandom( &uiState ) >> 24;
+    }
+
+    for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( formats ); f++ )
+    {
+        UINT32 uiPixelSize = VN_IMAGE_CHANNEL_COUNT( formats[ f ] );
+
+        for ( UINT32 uiLength = 1; uiLength <= VN_TEST_DESATURATE_MAX_LENGTH; uiLength++ )
+        {
+            for ( UINT32 uiOffset = 0; uiOffset <= VN_TEST_DESATURATE_MAX_OFFSET; uiOffset++ )
+            {
+                //
+                // Destination offsets walk in the opposite direction, so that the source and
+                // destination alignments vary independently of one another.
+                //
+
+                UINT8 * pSource      = pbyInput + uiOffset;
+                UINT8 * pDestination = pbyOutput + ( VN_TEST_DESATURATE_MAX_OFFSET - uiOffset );
+
+                memset( pbyOutput, VN_TEST_DESATURATE_GUARD, sizeof( pbyOutput ) );
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnDesaturateLine( formats[ f ], pSource, uiLength, pDestination ) ) );
+
+                for ( UINT32 i = 0; i < uiLength; i++ )
+                {
+                    if ( pDestination[ i ] != vnDesaturatePixel( formats[ f ], pSource + i * uiPixelSize ) )
+                    {
+                        printf( "    format 0x%08x, length %i, offset %i, pixel %i\n", formats[ f ], uiLength, uiOffset, i );
+
+                        return FALSE;
+                    }
+                }
+
+                for ( UINT8 * pGuard = pDestination + uiLength; pGuard < pbyOutput + sizeof( pbyOutput ); pGuard++ )
+                {
+                    VN_TEST_CHECK( VN_TEST_DESATURATE_GUARD == *pGuard );
+                }
+
+                for ( UINT8 * pGuard = pbyOutput; pGuard < pDestination; pGuard++ )
+                {
+                    VN_TEST_CHECK( VN_TEST_DESATURATE_GUARD == *pGuard );
+                }
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestLumaHashes
+//
+//   Every luma format hashes through its gray values alone. A planar YUV image must hash
+//   exactly as an R8 image that holds a copy of its Y plane, regardless of its chroma (which
+//   vnCreateTestImage fills with noise), and a color image must hash exactly as the R8 image
+//   produced by vnDesaturateImage.
+//
+
+BOOL vnTestLumaHashes()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_I420, VN_IMAGE_FORMAT_NV12, VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_B8G8R8,
+                                        VN_IMAGE_FORMAT_R8G8B8A8, VN_IMAGE_FORMAT_B8G8R8A8 };
+    CONST UINT32 uiSizes[][ 2 ]     = { { 32, 32 }, { 33, 47 }, { 300, 200 }, { 641, 479 } };
+
+    for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( formats ); f++ )
+    {
+        for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+        {
+            for ( UINT32 uiPattern = 0; uiPattern < VN_TEST_PATTERN_COUNT; uiPattern++ )
+            {
+                CVImage * pImage = NULL;
+                CVImage * pGray  = NULL;
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiPattern, &pImage ) ) );
+
+                if ( VN_IS_IMAGE_PLANAR_420( formats[ f ] ) )
+                {
+                    VN_TEST_CHECK( VN_SUCCEEDED( vnCreateImage( VN_IMAGE_FORMAT_R8, uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], &pGray ) ) );
+
+                    for ( UINT32 j = 0; j < uiSizes[ s ][ 1 ]; j++ )
+                    {
+                        memcpy( pGray->QueryData() + pGray->BlockOffset( 0, j ), pImage->QueryData() + pImage->BlockOffset( 0, j ), uiSizes[ s ][ 0 ] );
+                    }
+                }
+                else
+                {
+                    VN_TEST_CHECK( VN_SUCCEEDED( vnDesaturateImage( *pImage, &pGray ) ) );
+                    VN_TEST_CHECK( VN_IMAGE_FORMAT_R8 == pGray->QueryFormat() );
+                }
+
+                BOOL bMatched = vnTestHashesMatch( *pImage, *pGray );
+
+                vnDestroyImage( pGray );
+                vnDestroyImage( pImage );
+
+                if ( !bMatched )
+                {
+                    printf( "    format 0x%08x, %ix%i, pattern %i\n", formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiPattern );
+
+                    return FALSE;
+                }
+            }
+        }
+    }
+
+    return TRUE;
+}
@@ -0,0 +1,162 @@
+
+#include "vnTest.h"
+
+//
+// Hash entry points (see vnInsight.cpp)
+//
+
+UINT64 vnHashImage64( CONST CVImage & pInput );
+
+//
+// vnTestHasherMatches
+//
+//   Hashes pInput with a specialized hasher, through both of its outputs, and with vnHashImage
+//   at the same sizes. All three must produce the same bits.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+BOOL vnTestHasherMatches( CONST CVImage & pInput )
+{
+    typedef CVInsightHasher< THUMB_SIZE, HASH_SIZE > CVHasher;
+
+    UINT8 pbyHash[ HASH_SIZE ];
+    UINT8 pbyExpected[ HASH_SIZE ];
+    UINT32 uiByteCount = HASH_SIZE;
+    CVBitStream pHasherStream;
+    CVBitStream pExpectedStream;
+
+    VN_TEST_CHECK( ( HASH_SIZE << 3 ) == pHasherStream.ResizeCapacity( HASH_SIZE << 3 ) );
+    VN_TEST_CHECK( ( HASH_SIZE << 3 ) == pExpectedStream.ResizeCapacity( HASH_SIZE << 3 ) );
+
+    VN_TEST_CHECK( VN_SUCCEEDED( CVHasher::Hash( pInput, pbyHash ) ) );
+    VN_TEST_CHECK( VN_SUCCEEDED( CVHasher::Hash( pInput, &pHasherStream ) ) );
+    VN_TEST_CHECK( VN_SUCCEEDED( vnHashImage( pInput, THUMB_SIZE, HASH_SIZE, &pExpectedStream ) ) );
+    VN_TEST_CHECK( pHasherStream == pExpectedStream );
+
+    VN_TEST_CHECK( VN_SUCCEEDED( pExpectedStream.ReadBytes( pbyExpected, &uiByteCount ) ) );
+    VN_TEST_CHECK( HASH_SIZE == uiByteCount );
+    VN_TEST_CHECK( 0 == memcmp( pbyHash, pbyExpected, HASH_SIZE ) );
+
+    return TRUE;
+}
+
+//
+// vnTestSpecializedHashers
+//
+//   The specialized hashers fuse desaturation, resizing and the fixed point transform into a
+//   single streaming pass, and must reproduce vnHashImage exactly. We check the configurations
+//   of vnHashImage64 and vnCompareImages against every pattern of each luma format family, at
+//   sizes that include the minimum, odd dimensions and both downscales and upscales. Version 1
+//   builds hash with the floating point transform, which the hashers do not reproduce, so they
+//   skip this test.
+//
+
+BOOL vnTestSpecializedHashers()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_R8, VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_B8G8R8A8, VN_IMAGE_FORMAT_NV12 };
+    CONST UINT32 uiSizes[][ 2 ]     = { { 32, 32 }, { 33, 47 }, { 64, 64 }, { 97, 61 }, { 300, 200 }, { 641, 479 } };
+
+    if ( vnQueryHashVersion() < 2 )
+    {
+        return TRUE;
+    }
+
+    for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( formats ); f++ )
+    {
+        for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+        {
+            for ( UINT32 uiPattern = 0; uiPattern < VN_TEST_PATTERN_COUNT; uiPattern++ )
+            {
+                CVImage * pImage = NULL;
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiPattern, &pImage ) ) );
+
+                if ( !vnTestHasherMatches< 8, 8 >( *pImage ) || !vnTestHasherMatches< 16, 32 >( *pImage ) )
+                {
+                    printf( "    format 0x%08x, %ix%i, pattern %i\n", formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiPattern );
+
+                    vnDestroyImage( pImage );
+
+                    return FALSE;
+                }
+
+                vnDestroyImage( pImage );
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestGoldenHashes
+//
+//   Pins the version 2 hashes of a fixed set of images, for both vnHashImage64 and the default
+//   configuration of vnHashImage. Version 2 hashes are produced entirely with integer arithmetic
+//   and a reproducible basis (see vnTestFixedPointBasis), so they must hold on every host,
+//   compiler, optimization level and instruction set. A failure here is a change to the hash
+//   format, and requires a new hash version (see VN_INSIGHT_HASH_VERSION). Version 1 builds 
+//   skip this test, since their hashes may legitimately vary across hosts.
+//
+
+BOOL vnTestGoldenHashes()
+{
+    struct VN_TEST_GOLDEN_HASH
+    {
+        VN_IMAGE_FORMAT format;
+        UINT32 uiWidth;
+        UINT32 uiHeight;
+        UINT32 uiPattern;
+        UINT64 uiHash64;
+        UINT64 uiChecksum;          // checksum of the default hash
+    };
+
+    CONST VN_TEST_GOLDEN_HASH pHashes[] = 
+    {
+        { VN_IMAGE_FORMAT_R8,     300, 200, VN_TEST_PATTERN_GRADIENT, 0xfffffffffefffef5ULL, 0xec2d008d5812e44cULL },
+        { VN_IMAGE_FORMAT_R8,     300, 200, VN_TEST_PATTERN_CHECKER,  0xaaabaaabaaabaaffULL, 0x78e6e951ea37f244ULL },
+        { VN_IMAGE_FORMAT_R8,     300, 200, VN_TEST_PATTERN_RINGS,    0x0051005100510005ULL, 0xf6b4cf96158bde73ULL },
+        { VN_IMAGE_FORMAT_R8,     300, 200, VN_TEST_PATTERN_NOISE,    0x2fe86bec2d4c938fULL, 0x421100371d4c01ecULL },
+        { VN_IMAGE_FORMAT_R8G8B8, 641, 479, VN_TEST_PATTERN_GRADIENT, 0xbf7ffdfaf5ead4e9ULL, 0xcaa87c16fcb4dbd0ULL },
+        { VN_IMAGE_FORMAT_R8G8B8, 641, 479, VN_TEST_PATTERN_CHECKER,  0xffbffffefffffff7ULL, 0xfe61321ae54d35d5ULL },
+        { VN_IMAGE_FORMAT_R8G8B8, 641, 479, VN_TEST_PATTERN_RINGS,    0xffbbffeeffbbffefULL, 0x9532af12c26bd680ULL },
+        { VN_IMAGE_FORMAT_R8G8B8, 641, 479, VN_TEST_PATTERN_NOISE,    0x373f13d4b5fb9bffULL, 0xae0091035fad2877ULL },
+    };
+
+    VN_TEST_CHECK( VN_INSIGHT_HASH_VERSION == vnQueryHashVersion() );
+
+    if ( vnQueryHashVersion() < 2 )
+    {
+        return TRUE;
+    }
+
+    for ( UINT32 h = 0; h < VN_TEST_COUNT_OF( pHashes ); h++ )
+    {
+        CVImage * pImage  = NULL;
+        UINT64 uiChecksum = VN_TEST_CHECKSUM_BASIS;
+        CVBitStream pStream;
+
+        VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( pHashes[ h ].format, pHashes[ h ].uiWidth, pHashes[ h ].uiHeight, pHashes[ h ].uiPattern, &pImage ) ) );
+        VN_TEST_CHECK( ( VN_INSIGHT_DEFAULT_HASH_SIZE << 3 ) == pStream.ResizeCapacity( VN_INSIGHT_DEFAULT_HASH_SIZE << 3 ) );
+        VN_TEST_CHECK( VN_SUCCEEDED( vnHashImage( *pImage, VN_INSIGHT_DEFAULT_THUMB_SIZE, VN_INSIGHT_DEFAULT_HASH_SIZE, &pStream ) ) );
+
+        for ( UINT32 k = 0; k < VN_INSIGHT_DEFAULT_HASH_SIZE; k++ )
+        {
+            uiChecksum = vnUpdateTestChecksum( uiChecksum, pStream.QueryData()[ k ] );
+        }
+
+        UINT64 uiHash64 = vnHashImage64( *pImage );
+
+        vnDestroyImage( pImage );
+
+        if ( uiHash64 != pHashes[ h ].uiHash64 || uiChecksum != pHashes[ h ].uiChecksum )
+        {
+            printf( "    image %i hashes to 0x%016llx with checksum 0x%016llx\n", h, (unsigned long long) uiHash64, (unsigned long long) uiChecksum );
+        }
+
+        VN_TEST_CHECK( uiHash64 == pHashes[ h ].uiHash64 );
+        VN_TEST_CHECK( uiChecksum == pHashes[ h ].uiChecksum );
+    }
+
+    return TRUE;
+}
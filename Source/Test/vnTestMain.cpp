@@ -0,0 +1,51 @@
+
+#include "vnTest.h"
+
+//
+// Test table
+//
+//   Tests run in order, and each runs regardless of the result of those before it. Set 
+//   VN_CPU_LEVEL to repeat a run against the kernels of a lower level.
+//
+
+struct VN_TEST_ENTRY
+{
+    CONST CHAR *        szName;
+    VN_TEST_FUNCTION    pfnTest;
+};
+
+static CONST VN_TEST_ENTRY g_pTests[] = 
+{
+    { "FastTransformHashes",    vnTestFastTransformHashes },
+    { "FixedResizeBound",       vnTestFixedResizeBound },
+    { "SpecializedHashers",     vnTestSpecializedHashers },
+    { "FixedPointBasis",        vnTestFixedPointBasis },
+    { "GoldenHashes",           vnTestGoldenHashes },
+    { "DesaturateLines",        vnTestDesaturateLines },
+    { "LumaHashes",             vnTestLumaHashes },
+    { "ViewHashes",             vnTestViewHashes },
+    { "StreamedHashes",         vnTestStreamedHashes },
+    { "FileHashes",             vnTestFileHashes },
+    { "TransformBatch",         vnTestTransformBatch },
+    { "CompactCoefficients",    vnTestCompactCoefficients },
+};
+
+int main()
+{
+    UINT32 uiFailures = 0;
+
+    printf( "Insight tests (%s kernels)\n", vnQueryCpuLevelName( vnQueryCpuLevel() ) );
+
+    for ( UINT32 i = 0; i < VN_TEST_COUNT_OF( g_pTests ); i++ )
+    {
+        BOOL bPassed = g_pTests[ i ].pfnTest();
+
+        printf( "  %-32s %s\n", g_pTests[ i ].szName, bPassed ? "passed" : "FAILED" );
+
+        uiFailures += ( bPassed ? 0 : 1 );
+    }
+
+    printf( "%i of %i tests passed\n", (INT32) ( VN_TEST_COUNT_OF( g_pTests ) - uiFailures ), (INT32) VN_TEST_COUNT_OF( g_pTests ) );
+
+    return uiFailures;
+}
@@ -0,0 +1,335 @@
+
+#include "vnTest.h"
+#include <math.h>
+
+//
+// Resize stages (see vnImageResize.cpp)
+//
+
+FLOAT32 vnQueryResizeRatio( UINT32 uiSrcLength, UINT32 uiDestLength );
+
+#define VN_TEST_RESIZE_CASE_COUNT                   (400)
+#define VN_TEST_RESIZE_MAX_SOURCE_SIZE              (600)
+#define VN_TEST_RESIZE_MAX_DEST_SIZE                (200)
+#define VN_TEST_RESIZE_EXACT_TOLERANCE              (1)
+#define VN_TEST_RESIZE_EXACT_MEAN_TOLERANCE         (0.5)
+
+//
+// vnBuildTestResizeWeights
+//
+//   Builds the normalized tent weights of the resize kernel in double precision, as a dense 
+//   (uiDestLength x uiSrcLength) table, along with the first and last source sample of each
+//   output. Outputs with no weight replicate the nearest source sample, as the fixed point 
+//   filter does.
+//
+
+VOID vnBuildTestResizeWeights( UINT32 uiSrcLength, UINT32 uiDestLength, FLOAT64 * pfWeight, UINT32 * puiFirst, UINT32 * puiLast )
+{
+    FLOAT32 fRatio = vnQueryResizeRatio( uiSrcLength, uiDestLength );
+    INT32 iRadius  = fRatio + 1.0f;
+
+    vnZeroMemory( pfWeight, (SIZE_T) uiSrcLength * uiDestLength * sizeof( FLOAT64 ) );
+
+    for ( UINT32 i = 0; i < uiDestLength; i++ )
+    {
+        FLOAT32 fCenter  = i * fRatio;
+        FLOAT64 fTotal   = 0;
+        FLOAT64 * pfLine = pfWeight + i * uiSrcLength;
+
+        puiFirst[ i ] = VN_MIN2( (UINT32) fCenter, uiSrcLength - 1 );
+        puiLast[ i ]  = puiFirst[ i ];
+
+        for ( INT32 j = -iRadius + 1; 0 != fRatio && j <= iRadius; j++ )
+        {
+            INT32 iIndex = fCenter + j;
+
+            if ( iIndex < 0 || iIndex > (INT32) uiSrcLength - 1 )
+            {
+                continue;
+            }
+
+            FLOAT64 fWeight = 1.0 - VN_MIN2( fRatio, fabs( fCenter - iIndex ) ) / fRatio;
+
+            pfLine[ iIndex ] += fWeight;
+            fTotal           += fWeight;
+            puiFirst[ i ]     = VN_MIN2( puiFirst[ i ], (UINT32) iIndex );
+            puiLast[ i ]      = VN_MAX2( puiLast[ i ], (UINT32) iIndex );
+        }
+
+        if ( 0 == fTotal )
+        {
+            pfLine[ puiFirst[ i ] ] = 1.0;
+            fTotal                  = 1.0;
+        }
+
+        for ( UINT32 k = puiFirst[ i ]; k <= puiLast[ i ]; k++ )
+        {
+            pfLine[ k ] /= fTotal;
+        }
+    }
+}
+
+//
+// vnQueryTestCoverageLoss
+//
+//   The coverage filter truncates its running sum after each tap that carries weight, and 
+//   truncates again once it divides by the total weight, so each of its outputs falls short of
+//   the exact kernel by less than one level per tap (relative to the total weight) plus one. 
+//   Returns this bound for each of uiDestLength outputs along one axis.
+//
+
+VOID vnQueryTestCoverageLoss( UINT32 uiSrcLength, UINT32 uiDestLength, FLOAT64 * pfLoss )
+{
+    FLOAT32 fRatio = vnQueryResizeRatio( uiSrcLength, uiDestLength );
+    INT32 iRadius  = fRatio + 1.0f;
+
+    for ( UINT32 i = 0; i < uiDestLength; i++ )
+    {
+        FLOAT32 fCenter    = i * fRatio;
+        FLOAT64 fTotal     = 0;
+        UINT32 uiTapCount  = 0;
+
+        for ( INT32 j = -iRadius + 1; j <= iRadius; j++ )
+        {
+            INT32 iIndex = fCenter + j;
+
+            if ( iIndex < 0 || iIndex > (INT32) uiSrcLength - 1 )
+            {
+                continue;
+            }
+
+            FLOAT64 fWeight = 1.0 - VN_MIN2( fRatio, fabs( fCenter - iIndex ) ) / fRatio;
+
+            fTotal     += fWeight;
+            uiTapCount += ( fWeight > 0 );
+        }
+
+        pfLoss[ i ] = uiTapCount / fTotal + 1.0;
+    }
+}
+
+//
+// vnResizeTestReference
+//
+//   Resizes the first channel of pSource in double precision, and rounds the result to the 
+//   nearest level of an R8 image.
+//
+
+VN_STATUS vnResizeTestReference( CONST CVImage & pSource, UINT32 uiDestWidth, UINT32 uiDestHeight, CVImage ** pOutImage )
+{
+    UINT32 uiSrcWidth  = pSource.QueryWidth();
+    UINT32 uiSrcHeight = pSource.QueryHeight();
+
+    if ( VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, uiDestWidth, uiDestHeight, pOutImage ) ) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    FLOAT64 * pfHorizWeight = new FLOAT64[ uiDestWidth * uiSrcWidth ];
+    FLOAT64 * pfVertWeight  = new FLOAT64[ uiDestHeight * uiSrcHeight ];
+    FLOAT64 * pfRows        = new FLOAT64[ uiSrcHeight * uiDestWidth ];
+    UINT32 * puiHorizFirst  = new UINT32[ uiDestWidth ];
+    UINT32 * puiHorizLast   = new UINT32[ uiDestWidth ];
+    UINT32 * puiVertFirst   = new UINT32[ uiDestHeight ];
+    UINT32 * puiVertLast    = new UINT32[ uiDestHeight ];
+
+    vnBuildTestResizeWeights( uiSrcWidth, uiDestWidth, pfHorizWeight, puiHorizFirst, puiHorizLast );
+    vnBuildTestResizeWeights( uiSrcHeight, uiDestHeight, pfVertWeight, puiVertFirst, puiVertLast );
+
+    for ( UINT32 y = 0; y < uiSrcHeight; y++ )
+    {
+        for ( UINT32 i = 0; i < uiDestWidth; i++ )
+        {
+            FLOAT64 fSum = 0;
+
+            for ( UINT32 x = puiHorizFirst[ i ]; x <= puiHorizLast[ i ]; x++ )
+            {
+                fSum += pfHorizWeight[ i * uiSrcWidth + x ] * pSource.QueryData()[ pSource.BlockOffset( x, y ) ];
+            }
+
+            pfRows[ y * uiDestWidth + i ] = fSum;
+        }
+    }
+
+    for ( UINT32 j = 0; j < uiDestHeight; j++ )
+    {
+        for ( UINT32 i = 0; i < uiDestWidth; i++ )
+        {
+            FLOAT64 fSum = 0;
+
+            for ( UINT32 y = puiVertFirst[ j ]; y <= puiVertLast[ j ]; y++ )
+            {
+                fSum += pfVertWeight[ j * uiSrcHeight + y ] * pfRows[ y * uiDestWidth + i ];
+            }
+
+            ( *pOutImage )->QueryData()[ ( *pOutImage )->BlockOffset( i, j ) ] = (UINT8) floor( fSum + 0.5 );
+        }
+    }
+
+    delete [] puiVertLast;
+    delete [] puiVertFirst;
+    delete [] puiHorizLast;
+    delete [] puiHorizFirst;
+    delete [] pfRows;
+    delete [] pfVertWeight;
+    delete [] pfHorizWeight;
+
+    return VN_SUCCESS;
+}
+
+//
+// vnCompareTestChannels
+//
+//   Compares the first channel of two images of the same size, and returns both the largest 
+//   and the mean absolute difference between them.
+//
+
+VOID vnCompareTestChannels( CONST CVImage & pFirst, CONST CVImage & pSecond, OUT INT32 * piMaxDelta, OUT FLOAT64 * pfMeanDelta )
+{
+    UINT64 uiTotalDelta = 0;
+
+    *piMaxDelta = 0;
+
+    for ( UINT32 j = 0; j < pFirst.QueryHeight(); j++ )
+    {
+        for ( UINT32 i = 0; i < pFirst.QueryWidth(); i++ )
+        {
+            INT32 iDelta = (INT32) pFirst.QueryData()[ pFirst.BlockOffset( i, j ) ] - 
+                           (INT32) pSecond.QueryData()[ pSecond.BlockOffset( i, j ) ];
+
+            iDelta        = VN_MAX2( iDelta, -iDelta );
+            *piMaxDelta   = VN_MAX2( *piMaxDelta, iDelta );
+            uiTotalDelta += iDelta;
+        }
+    }
+
+    *pfMeanDelta = (FLOAT64) uiTotalDelta / ( (FLOAT64) pFirst.QueryWidth() * pFirst.QueryHeight() );
+}
+
+//
+// vnTestCoverageBound
+//
+//   Returns TRUE if the first channel of each coverage output falls short of the fixed point
+//   output by no more than the truncation bounds of its row and column (see 
+//   vnQueryTestCoverageLoss). The fixed point output is within VN_TEST_RESIZE_EXACT_TOLERANCE 
+//   levels of the rounded exact kernel, and so within half a level more of the exact kernel
+//   itself, on either side.
+//
+
+BOOL vnTestCoverageBound( CONST CVImage & pCoverage, CONST CVImage & pFixed, CONST FLOAT64 * pfHorizLoss, CONST FLOAT64 * pfVertLoss )
+{
+    FLOAT64 fSlack = VN_TEST_RESIZE_EXACT_TOLERANCE + 0.5;
+
+    for ( UINT32 j = 0; j < pFixed.QueryHeight(); j++ )
+    {
+        for ( UINT32 i = 0; i < pFixed.QueryWidth(); i++ )
+        {
+            INT32 iDelta = (INT32) pFixed.QueryData()[ pFixed.BlockOffset( i, j ) ] - 
+                           (INT32) pCoverage.QueryData()[ pCoverage.BlockOffset( i, j ) ];
+
+            if ( iDelta < -fSlack || iDelta > pfHorizLoss[ i ] + pfVertLoss[ j ] + fSlack )
+            {
+                printf( "    output %i, %i differs by %i\n", i, j, iDelta );
+
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestFixedResizeBound
+//
+//   Resizes random one, three and four channel images with both the fixed point and the 
+//   coverage filters, and bounds the first channel of each result:
+//
+//   o The fixed point result is within VN_TEST_RESIZE_EXACT_TOLERANCE levels of the same kernel 
+//     evaluated in double precision, with a mean absolute error of at most 
+//     VN_TEST_RESIZE_EXACT_MEAN_TOLERANCE, at every ratio. Upscales of 0.5 or less along an
+//     axis can give an output no kernel weight at all, in which case the fixed point filter
+//     (and the reference) replicate the nearest source sample.
+//
+//   o When neither axis is upscaled, the coverage result falls short of the exact kernel by no
+//     more than its truncation bound (see vnTestCoverageBound). The coverage filter normalizes
+//     by the total weight, which is small on upscales and may be zero at ratios of 0.5 or 
+//     less, so it is not compared there.
+//
+
+BOOL vnTestFixedResizeBound()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_R8, VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_R8G8B8A8, VN_IMAGE_FORMAT_B8G8R8A8 };
+
+    UINT32 uiState          = 0x5eed012;
+    UINT32 uiUpscaleCount   = 0;
+    UINT32 uiDownscaleCount = 0;
+
+    for ( UINT32 k = 0; k < VN_TEST_RESIZE_CASE_COUNT; k++ )
+    {
+        VN_IMAGE_FORMAT format  = formats[ ( vnQueryTestRandom( &uiState ) >> 16 ) % VN_TEST_COUNT_OF( formats ) ];
+        UINT32 uiPattern        = ( vnQueryTestRandom( &uiState ) >> 16 ) % VN_TEST_PATTERN_COUNT;
+        UINT32 uiSrcWidth       = 2 + ( vnQueryTestRandom( &uiState ) >> 16 ) % ( VN_TEST_RESIZE_MAX_SOURCE_SIZE - 1 );
+        UINT32 uiSrcHeight      = 2 + ( vnQueryTestRandom( &uiState ) >> 16 ) % ( VN_TEST_RESIZE_MAX_SOURCE_SIZE - 1 );
+        UINT32 uiDestWidth      = 1 + ( vnQueryTestRandom( &uiState ) >> 16 ) % VN_TEST_RESIZE_MAX_DEST_SIZE;
+        UINT32 uiDestHeight     = 1 + ( vnQueryTestRandom( &uiState ) >> 16 ) % VN_TEST_RESIZE_MAX_DEST_SIZE;
+        FLOAT32 fMinRatio       = VN_MIN2( vnQueryResizeRatio( uiSrcWidth, uiDestWidth ), vnQueryResizeRatio( uiSrcHeight, uiDestHeight ) );
+
+        CVImage * pSource    = NULL;
+        CVImage * pReference = NULL;
+        CVImage * pFixed     = NULL;
+        INT32 iMaxDelta      = 0;
+        FLOAT64 fMeanDelta   = 0;
+
+        VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( format, uiSrcWidth, uiSrcHeight, uiPattern, &pSource ) ) );
+        VN_TEST_CHECK( VN_SUCCEEDED( vnResizeTestReference( *pSource, uiDestWidth, uiDestHeight, &pReference ) ) );
+        VN_TEST_CHECK( VN_SUCCEEDED( vnResizeImage( *pSource, uiDestWidth, uiDestHeight, VN_IMAGE_RESIZE_FIXED_POINT, &pFixed ) ) );
+        VN_TEST_CHECK( format == pFixed->QueryFormat() );
+
+        vnCompareTestChannels( *pReference, *pFixed, &iMaxDelta, &fMeanDelta );
+
+        VN_TEST_CHECK( iMaxDelta <= VN_TEST_RESIZE_EXACT_TOLERANCE );
+        VN_TEST_CHECK( fMeanDelta <= VN_TEST_RESIZE_EXACT_MEAN_TOLERANCE );
+
+        if ( fMinRatio >= 1.0f )
+        {
+            CVImage * pCoverage = NULL;
+
+            VN_TEST_CHECK( VN_SUCCEEDED( vnResizeImage( *pSource, uiDestWidth, uiDestHeight, VN_IMAGE_RESIZE_COVERAGE, &pCoverage ) ) );
+            VN_TEST_CHECK( format == pCoverage->QueryFormat() );
+
+            FLOAT64 * pfHorizLoss = new FLOAT64[ uiDestWidth ];
+            FLOAT64 * pfVertLoss  = new FLOAT64[ uiDestHeight ];
+
+            vnQueryTestCoverageLoss( uiSrcWidth, uiDestWidth, pfHorizLoss );
+            vnQueryTestCoverageLoss( uiSrcHeight, uiDestHeight, pfVertLoss );
+
+            BOOL bBounded = vnTestCoverageBound( *pCoverage, *pFixed, pfHorizLoss, pfVertLoss );
+
+            delete [] pfVertLoss;
+            delete [] pfHorizLoss;
+            vnDestroyImage( pCoverage );
+
+            VN_TEST_CHECK( bBounded );
+
+            uiDownscaleCount++;
+        }
+        else if ( fMinRatio <= 0.5f )
+        {
+            uiUpscaleCount++;
+        }
+
+        vnDestroyImage( pFixed );
+        vnDestroyImage( pReference );
+        vnDestroyImage( pSource );
+    }
+
+    //
+    // Guard against a generator change that silently excludes either range of ratios.
+    //
+
+    VN_TEST_CHECK( uiDownscaleCount >= ( VN_TEST_RESIZE_CASE_COUNT >> 2 ) );
+    VN_TEST_CHECK( uiUpscaleCount >= ( VN_TEST_RESIZE_CASE_COUNT >> 4 ) );
+
+    return TRUE;
+}
@@ -0,0 +1,203 @@
+
+#include "vnTest.h"
+
+//
+// File hashes
+//
+//   File hash tests write their images to VN_TEST_FILE_NAME, within the working directory.
+//   File hashes map 64 MB strips of rows (see vnInsight.cpp), so rows that are 
+//   VN_TEST_FILE_STRIP_PITCH bytes apart place 255 rows within each strip.
+//
+
+#define VN_TEST_FILE_NAME                           "vnTestFileHashes.raw"
+#define VN_TEST_FILE_STRIP_PITCH                    ( 256 * 1024 + 13 )
+
+//
+// vnTestStreamMatches
+//
+//   Returns TRUE if pStream holds the same hash as vnHashImage produces for pImage.
+//
+
+BOOL vnTestStreamMatches( CONST CVImage & pImage, UINT32 uiThumbSize, UINT32 uiHashSize, CONST CVBitStream & pStream )
+{
+    CVBitStream pExpectedStream;
+
+    VN_TEST_CHECK( ( uiHashSize << 3 ) == pExpectedStream.ResizeCapacity( uiHashSize << 3 ) );
+    VN_TEST_CHECK( VN_SUCCEEDED( vnHashImage( pImage, uiThumbSize, uiHashSize, &pExpectedStream ) ) );
+    VN_TEST_CHECK( pStream == pExpectedStream );
+
+    return TRUE;
+}
+
+//
+// vnTestStreamedHashes
+//
+//   Pushes the rows of each image through a single context, one at a time, and checks that
+//   the streamed hash is identical to that of vnHashImage. Reusing the context across formats
+//   and sizes also checks that no state survives from one streamed hash to the next.
+//
+
+BOOL vnTestStreamedHashes()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_R8, VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_B8G8R8A8, VN_IMAGE_FORMAT_NV12 };
+    CONST UINT32 uiSizes[][ 2 ]     = { { 32, 32 }, { 33, 47 }, { 300, 200 }, { 641, 479 } };
+    CONST UINT32 uiConfigs[][ 2 ]   = { { 8, 8 }, { VN_INSIGHT_DEFAULT_THUMB_SIZE, VN_INSIGHT_DEFAULT_HASH_SIZE } };
+
+    CVInsightContext pContext;
+
+    for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( formats ); f++ )
+    {
+        for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+        {
+            for ( UINT32 uiPattern = 0; uiPattern < VN_TEST_PATTERN_COUNT; uiPattern++ )
+            {
+                CVImage * pImage = NULL;
+                BOOL bMatched    = TRUE;
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiPattern, &pImage ) ) );
+
+                for ( UINT32 c = 0; c < VN_TEST_COUNT_OF( uiConfigs ) && bMatched; c++ )
+                {
+                    CVBitStream pStream;
+
+                    VN_TEST_CHECK( ( uiConfigs[ c ][ 1 ] << 3 ) == pStream.ResizeCapacity( uiConfigs[ c ][ 1 ] << 3 ) );
+                    VN_TEST_CHECK( VN_SUCCEEDED( pContext.BeginHash( formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiConfigs[ c ][ 0 ], uiConfigs[ c ][ 1 ], &pStream ) ) );
+
+                    for ( UINT32 j = 0; j < uiSizes[ s ][ 1 ]; j++ )
+                    {
+                        VN_TEST_CHECK( VN_SUCCEEDED( pContext.PushRow( pImage->QueryData() + pImage->BlockOffset( 0, j ) ) ) );
+                    }
+
+                    bMatched = vnTestStreamMatches( *pImage, uiConfigs[ c ][ 0 ], uiConfigs[ c ][ 1 ], pStream );
+                }
+
+                vnDestroyImage( pImage );
+
+                if ( !bMatched )
+                {
+                    printf( "    format 0x%08x, %ix%i, pattern %i\n", formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiPattern );
+
+                    return FALSE;
+                }
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestWriteImageFile
+//
+//   Writes the rows (or Y plane rows) of pImage to szFilename, starting uiOffset bytes into the
+//   file and uiRowPitch bytes apart. The gaps between rows are left unwritten, and the file ends
+//   with the final row.
+//
+
+BOOL vnTestWriteImageFile( CONST CHAR * szFilename, CONST CVImage & pImage, UINT32 uiOffset, UINT32 uiRowPitch )
+{
+    UINT32 uiRowSize = ( pImage.QueryWidth() * pImage.QueryBitsPerPixel() ) >> 3;
+    FILE * pFile     = fopen( szFilename, "wb" );
+    BOOL bWritten    = ( NULL != pFile );
+
+    for ( UINT32 j = 0; j < pImage.QueryHeight() && bWritten; j++ )
+    {
+        bWritten = ( 0 == fseek( pFile, uiOffset + j * uiRowPitch, SEEK_SET ) ) && 
+                   ( uiRowSize == fwrite( pImage.QueryData() + pImage.BlockOffset( 0, j ), 1, uiRowSize, pFile ) );
+    }
+
+    if ( pFile )
+    {
+        bWritten = ( 0 == fclose( pFile ) ) && bWritten;
+    }
+
+    return bWritten;
+}
+
+//
+// vnTestFileHashMatches
+//
+//   Writes pImage to a file with the specified layout, and returns TRUE if vnHashImageFile
+//   produces the same hash as vnHashImage for both the 8 byte and the default hash sizes. A
+//   layout that claims one more byte of offset than the file holds must be rejected.
+//
+
+BOOL vnTestFileHashMatches( CONST CVImage & pImage, UINT32 uiOffset, UINT32 uiRowPitch )
+{
+    CONST UINT32 uiConfigs[][ 2 ] = { { 8, 8 }, { VN_INSIGHT_DEFAULT_THUMB_SIZE, VN_INSIGHT_DEFAULT_HASH_SIZE } };
+    UINT32 uiFilePitch            = ( uiRowPitch ? uiRowPitch : ( pImage.QueryWidth() * pImage.QueryBitsPerPixel() ) >> 3 );
+    BOOL bMatched                 = vnTestWriteImageFile( VN_TEST_FILE_NAME, pImage, uiOffset, uiFilePitch );
+
+    for ( UINT32 c = 0; c < VN_TEST_COUNT_OF( uiConfigs ) && bMatched; c++ )
+    {
+        CVBitStream pStream;
+
+        bMatched = ( ( uiConfigs[ c ][ 1 ] << 3 ) == pStream.ResizeCapacity( uiConfigs[ c ][ 1 ] << 3 ) ) &&
+                   VN_SUCCEEDED( vnHashImageFile( VN_TEST_FILE_NAME, uiOffset, pImage.QueryFormat(), pImage.QueryWidth(), pImage.QueryHeight(), 
+                                                  uiRowPitch, uiConfigs[ c ][ 0 ], uiConfigs[ c ][ 1 ], &pStream ) ) &&
+                   vnTestStreamMatches( pImage, uiConfigs[ c ][ 0 ], uiConfigs[ c ][ 1 ], pStream );
+    }
+
+    if ( bMatched )
+    {
+        CVBitStream pStream;
+
+        bMatched = ( 64 == pStream.ResizeCapacity( 64 ) ) &&
+                   VN_FAILED( vnHashImageFile( VN_TEST_FILE_NAME, uiOffset + 1, pImage.QueryFormat(), pImage.QueryWidth(), pImage.QueryHeight(),
+                                               uiRowPitch, 8, 8, &pStream ) );
+    }
+
+    remove( VN_TEST_FILE_NAME );
+
+    return bMatched;
+}
+
+//
+// vnTestFileHashes
+//
+//   Hashes images that are stored within files, at an unaligned offset and with both packed
+//   and padded rows, and checks that each file hash is identical to that of vnHashImage. The
+//   final image uses a pitch wide enough that its rows span two strip mappings, the second of
+//   which is only partially filled.
+//
+
+BOOL vnTestFileHashes()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_R8, VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_B8G8R8A8, VN_IMAGE_FORMAT_NV12 };
+    CONST UINT32 uiSizes[][ 2 ]     = { { 32, 32 }, { 33, 47 }, { 641, 479 } };
+    CONST UINT32 uiOffset           = 17;
+
+    for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( formats ); f++ )
+    {
+        for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+        {
+            CVImage * pImage = NULL;
+
+            VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], VN_TEST_PATTERN_NOISE, &pImage ) ) );
+
+            UINT32 uiPaddedPitch = ( ( pImage->QueryWidth() * pImage->QueryBitsPerPixel() ) >> 3 ) + 5;
+            BOOL bMatched        = vnTestFileHashMatches( *pImage, uiOffset, 0 ) && vnTestFileHashMatches( *pImage, uiOffset, uiPaddedPitch );
+
+            vnDestroyImage( pImage );
+
+            if ( !bMatched )
+            {
+                printf( "    format 0x%08x, %ix%i\n", formats[ f ], uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ] );
+
+                return FALSE;
+            }
+        }
+    }
+
+    CVImage * pImage = NULL;
+
+    VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, 64, 300, VN_TEST_PATTERN_RINGS, &pImage ) ) );
+
+    BOOL bMatched = vnTestFileHashMatches( *pImage, uiOffset, VN_TEST_FILE_STRIP_PITCH );
+
+    vnDestroyImage( pImage );
+
+    VN_TEST_CHECK( bMatched );
+
+    return TRUE;
+}
@@ -0,0 +1,401 @@
+
+#include "vnTest.h"
+#include <math.h>
+
+//
+// Hash stages (see vnInsight.cpp)
+//
+
+INT32 vnComputeBlockAverage( CONST CVImage & pInput );
+VN_STATUS vnPublishHashValue( CONST CVImage & pInput, UINT32 uiTransformSize, INT32 iAverage, UINT32 uiHashSize, CVBitStream * pOutStream );
+
+INT32 vnQueryTestCoefficient( CONST CVImage & pInput, UINT32 i, UINT32 j )
+{
+    UINT8 * pbyCoefficient = pInput.QueryData() + pInput.BlockOffset( i, j );
+
+    if ( VN_IMAGE_FORMAT_R16S == pInput.QueryFormat() )
+    {
+        return *( reinterpret_cast<INT16 *>( pbyCoefficient ) );
+    }
+
+    return *( reinterpret_cast<INT32 *>( pbyCoefficient ) );
+}
+
+//
+// vnTestHashBlock
+//
+//   Publishes the hash of a (uiThumbSize x uiThumbSize) coefficient block, exactly as 
+//   CVInsightContext::Publish does.
+//
+
+BOOL vnTestHashBlock( CONST CVImage & pBlock, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    pOutStream->ResizeCapacity( uiHashSize << 3 );
+
+    INT32 iAverage = vnComputeBlockAverage( pBlock );
+
+    return VN_SUCCEEDED( vnPublishHashValue( pBlock, uiThumbSize << 2, iAverage, uiHashSize, pOutStream ) );
+}
+
+//
+// Fast path sizes (see vnImageTransform.cpp). Power of two lines of at least
+// VN_TEST_TRANSFORM_MIN_FAST_SIZE samples use the fast factorization, except that hosts which
+// run the vector kernels evaluate lines of up to VN_TEST_TRANSFORM_MAX_VECTOR_DIRECT_SIZE 
+// samples directly.
+//
+
+#define VN_TEST_TRANSFORM_MIN_FAST_SIZE             (8)
+#define VN_TEST_TRANSFORM_MAX_VECTOR_DIRECT_SIZE    (64)
+
+//
+// vnTestFastTransformHashes
+//
+//   vnTransformImage evaluates full power of two lines with the fast factorized DCT-II, while
+//   vnTransformImageLowFrequency always evaluates pruned lines directly from the basis. Both 
+//   must agree to within one unit in every low frequency coefficient, and must publish identical
+//   hashes for our fixed image set. We only check thumbnails whose full transform takes the fast
+//   path, i.e. those of more than 64 pixels per edge at the vector levels (or of any size at 
+//   VN_CPU_LEVEL=scalar). Fixed point transforms always use the direct basis, so they are not
+//   covered here.
+//
+
+BOOL vnTestFastTransformHashes()
+{
+    CONST UINT32 uiThumbSizes[] = { 4, 8, 16, 32, 64 };
+    CONST VN_IMAGE_TRANSFORM_FLAGS uiFlags[] = { VN_IMAGE_TRANSFORM_DEFAULT, VN_IMAGE_TRANSFORM_DEFAULT | VN_IMAGE_TRANSFORM_COMPACT };
+    UINT32 uiFastCount = 0;
+
+    for ( UINT32 uiPattern = 0; uiPattern < VN_TEST_PATTERN_COUNT; uiPattern++ )
+    {
+        CVImage * pSource = NULL;
+
+        VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, 300, 200, uiPattern, &pSource ) ) );
+
+        for ( UINT32 t = 0; t < VN_TEST_COUNT_OF( uiThumbSizes ); t++ )
+        {
+            UINT32 uiEdge = uiThumbSizes[ t ] << 2;
+
+            if ( uiEdge < VN_TEST_TRANSFORM_MIN_FAST_SIZE || 
+               ( VN_CPU_LEVEL_SCALAR != vnQueryCpuLevel() && uiEdge <= VN_TEST_TRANSFORM_MAX_VECTOR_DIRECT_SIZE ) )
+            {
+                continue;
+            }
+
+            for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( uiFlags ); f++ )
+            {
+                UINT32 uiThumbSize  = uiThumbSizes[ t ];
+                UINT32 uiHashSize   = ( uiThumbSize * uiThumbSize ) >> 2;
+                CVImage * pThumb    = NULL;
+                CVImage * pFull     = NULL;
+                CVImage * pLow      = NULL;
+                CVImage * pBlock    = NULL;
+                CVBitStream pFastHash;
+                CVBitStream pDirectHash;
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnResizeImage( *pSource, uiEdge, uiEdge, &pThumb ) ) );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImage( *pThumb, uiFlags[ f ], &pFull ) ) );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageLowFrequency( *pThumb, uiThumbSize, uiFlags[ f ], &pLow ) ) );
+                VN_TEST_CHECK( pFull->QueryFormat() == pLow->QueryFormat() );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnCreateImage( pLow->QueryFormat(), uiThumbSize, uiThumbSize, &pBlock ) ) );
+
+                //
+                // Crop the low frequency block out of the full transform, and bound the 
+                // difference of each coefficient.
+                //
+
+                UINT32 uiBlockPitch = ( uiThumbSize * pLow->QueryBitsPerPixel() ) >> 3;
+
+                for ( UINT32 j = 0; j < uiThumbSize; j++ )
+                {
+                    memcpy( pBlock->QueryData() + pBlock->BlockOffset( 0, j ), pFull->QueryData() + pFull->BlockOffset( 0, j ), uiBlockPitch );
+
+                    for ( UINT32 i = 0; i < uiThumbSize; i++ )
+                    {
+                        INT32 iDelta = vnQueryTestCoefficient( *pBlock, i, j ) - vnQueryTestCoefficient( *pLow, i, j );
+
+                        VN_TEST_CHECK( iDelta >= -1 && iDelta <= 1 );
+                    }
+                }
+
+                VN_TEST_CHECK( vnTestHashBlock( *pBlock, uiThumbSize, uiHashSize, &pFastHash ) );
+                VN_TEST_CHECK( vnTestHashBlock( *pLow, uiThumbSize, uiHashSize, &pDirectHash ) );
+                VN_TEST_CHECK( pFastHash == pDirectHash );
+
+                vnDestroyImage( pBlock );
+                vnDestroyImage( pLow );
+                vnDestroyImage( pFull );
+                vnDestroyImage( pThumb );
+
+                uiFastCount++;
+            }
+        }
+
+        vnDestroyImage( pSource );
+    }
+
+    //
+    // Every level must exercise the fast path at some size.
+    //
+
+    VN_TEST_CHECK( uiFastCount > 0 );
+
+    return TRUE;
+}
+
+//
+// vnTestFixedPointBasis
+//
+//   Pins the fixed point basis, which determines every version 2 hash. The basis is generated 
+//   without the platform math library, so its checksums must hold on every host, compiler and
+//   optimization level. Each value must also lie within one unit of the basis computed with 
+//   the platform cosine (and the same scale). A change to either check is a change to the hash
+//   format, and requires a new hash version (see VN_INSIGHT_HASH_VERSION).
+//
+
+BOOL vnTestFixedPointBasis()
+{
+    struct VN_TEST_BASIS_CHECKSUM
+    {
+        UINT32 uiCount;
+        UINT64 uiChecksum;
+    };
+
+    CONST VN_TEST_BASIS_CHECKSUM pChecksums[] = 
+    {
+        { 1,    0x6c63b9b413953813ULL }, { 2,    0x88bde020be70a14aULL }, { 3,    0x94ab08b366c898e7ULL }, 
+        { 7,    0x8e9d5067ce472f8dULL }, { 8,    0x009edfb309605961ULL }, { 16,   0x1fb9f39b9d013891ULL }, 
+        { 31,   0x86cd51d2b70c8459ULL }, { 32,   0x6a1581c30d4fc605ULL }, { 64,   0x0a8778653639d769ULL }, 
+        { 100,  0x548beec67d95d965ULL }, { 128,  0x3a5a8be6c81394f9ULL }, { 256,  0xa8753d5d4ef81885ULL }, 
+        { 1024, 0xb0c361d7d2bf8505ULL },
+    };
+
+    for ( UINT32 c = 0; c < VN_TEST_COUNT_OF( pChecksums ); c++ )
+    {
+        UINT32 uiCount        = pChecksums[ c ].uiCount;
+        UINT64 uiChecksum     = VN_TEST_CHECKSUM_BASIS;
+        CONST INT32 * piBasis = NULL;
+
+        VN_TEST_CHECK( VN_SUCCEEDED( vnQueryTransformBasis( uiCount, &piBasis ) ) );
+
+        for ( UINT32 i = 0; i < uiCount; i++ )
+        {
+            FLOAT64 fScale = ( 0 == i ? vnSqrt( 1.0f / uiCount ) : vnSqrt( 2.0f / uiCount ) ) * (FLOAT64) ( 1 << VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT );
+
+            for ( UINT32 k = 0; k < uiCount; k++ )
+            {
+                FLOAT64 fExpected = fScale * cos( ( 2 * k + 1 ) * i * 3.14159265358979323846 / ( 2.0 * uiCount ) );
+
+                VN_TEST_CHECK( fabs( piBasis[ i * uiCount + k ] - fExpected ) <= 1.0 );
+
+                uiChecksum = vnUpdateTestChecksum( uiChecksum, (UINT32) piBasis[ i * uiCount + k ] );
+            }
+        }
+
+        if ( uiChecksum != pChecksums[ c ].uiChecksum )
+        {
+            printf( "    basis of %i samples has checksum 0x%016llx\n", uiCount, (unsigned long long) uiChecksum );
+        }
+
+        VN_TEST_CHECK( uiChecksum == pChecksums[ c ].uiChecksum );
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestCoefficientsMatch
+//
+//   Returns TRUE if two coefficient images share their dimensions, and each pair of their 
+//   coefficients differs by at most iTolerance. Either image may use the compact format.
+//
+
+BOOL vnTestCoefficientsMatch( CONST CVImage & pFirst, CONST CVImage & pSecond, INT32 iTolerance )
+{
+    VN_TEST_CHECK( pFirst.QueryWidth() == pSecond.QueryWidth() && pFirst.QueryHeight() == pSecond.QueryHeight() );
+
+    for ( UINT32 j = 0; j < pFirst.QueryHeight(); j++ )
+    {
+        for ( UINT32 i = 0; i < pFirst.QueryWidth(); i++ )
+        {
+            INT32 iDelta = vnQueryTestCoefficient( pFirst, i, j ) - vnQueryTestCoefficient( pSecond, i, j );
+
+            VN_TEST_CHECK( iDelta >= -iTolerance && iDelta <= iTolerance );
+        }
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestTransformBatch
+//
+//   vnTransformImageBatch must reproduce vnTransformImageLowFrequency for every image in a 
+//   batch, exactly for fixed point transforms and to within one unit for float transforms 
+//   (whose matrix products sum in a different order). The sizes cover both matrix kernels and
+//   the per image fallbacks: 300x200 fixed point sums exceed 32 bits, and float lines of more 
+//   than 64 samples (or of any power of two size at VN_CPU_LEVEL=scalar) favor the fast 
+//   factorization. Batches of 13 distinct images span several chunks at the larger sizes.
+//
+
+BOOL vnTestTransformBatch()
+{
+    CONST UINT32 uiSizes[][ 2 ]               = { { 32, 32 }, { 33, 47 }, { 97, 61 }, { 300, 200 } };
+    CONST UINT32 uiBlockSizes[]               = { 8, 16 };
+    CONST VN_IMAGE_TRANSFORM_FLAGS uiFlags[]  = { VN_IMAGE_TRANSFORM_FIXED_POINT, VN_IMAGE_TRANSFORM_DEFAULT };
+    CONST INT32 iTolerances[]                 = { 0, 1 };
+
+    CVImage * ppImages[ 13 ]  = { NULL };
+    CVImage * ppOutputs[ 13 ] = { NULL };
+
+    for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+    {
+        //
+        // Offset the values of each image so that no two images in a batch are alike.
+        //
+
+        for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+        {
+            VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], k % VN_TEST_PATTERN_COUNT, ppImages + k ) ) );
+
+            for ( UINT32 j = 0; j < uiSizes[ s ][ 1 ]; j++ )
+            {
+                UINT8 * pLine = ppImages[ k ]->QueryData() + ppImages[ k ]->BlockOffset( 0, j );
+
+                for ( UINT32 i = 0; i < uiSizes[ s ][ 0 ]; i++ )
+                {
+                    pLine[ i ] += k * 7;
+                }
+            }
+        }
+
+        for ( UINT32 b = 0; b < VN_TEST_COUNT_OF( uiBlockSizes ); b++ )
+        {
+            for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( uiFlags ); f++ )
+            {
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageBatch( ppImages, VN_TEST_COUNT_OF( ppImages ), uiBlockSizes[ b ], uiFlags[ f ], ppOutputs ) ) );
+
+                for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+                {
+                    CVImage * pSingle = NULL;
+
+                    VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageLowFrequency( *ppImages[ k ], uiBlockSizes[ b ], uiFlags[ f ], &pSingle ) ) );
+
+                    BOOL bMatched = ( pSingle->QueryFormat() == ppOutputs[ k ]->QueryFormat() ) && 
+                                    vnTestCoefficientsMatch( *ppOutputs[ k ], *pSingle, iTolerances[ f ] );
+
+                    vnDestroyImage( pSingle );
+
+                    if ( !bMatched )
+                    {
+                        printf( "    %ix%i, block %i, flags 0x%x, image %i\n", uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], uiBlockSizes[ b ], uiFlags[ f ], k );
+
+                        return FALSE;
+                    }
+                }
+
+                for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppOutputs ); k++ )
+                {
+                    vnDestroyImage( ppOutputs[ k ] );
+                }
+            }
+        }
+
+        for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+        {
+            vnDestroyImage( ppImages[ k ] );
+        }
+    }
+
+    return TRUE;
+}
+
+//
+// vnTestCompactCoefficients
+//
+//   Compact transforms store their coefficients in R16S images whenever every coefficient is 
+//   certain to fit, and must otherwise produce exactly the coefficients of the R32S transform. 
+//   We check full, low frequency and batched transforms of both precisions, including the paths
+//   that do not use a matrix product: fixed point sums that exceed 32 bits (300x200, whose compact
+//   transforms must fall back to R32S), and float batches of full power of two lines that favor 
+//   the fast factorization (128x128, at every level).
+//
+
+BOOL vnTestCompactCoefficients()
+{
+    CONST UINT32 uiSizes[][ 2 ]               = { { 32, 32 }, { 33, 47 }, { 97, 61 }, { 128, 128 }, { 300, 200 } };
+    CONST UINT32 uiBlockSizes[]               = { 16, 512 };
+    CONST VN_IMAGE_TRANSFORM_FLAGS uiFlags[]  = { VN_IMAGE_TRANSFORM_DEFAULT, VN_IMAGE_TRANSFORM_FIXED_POINT };
+    UINT32 uiCompactCount                     = 0;
+
+    CVImage * ppImages[ 4 ]          = { NULL };
+    CVImage * ppOutputs[ 4 ]         = { NULL };
+    CVImage * ppCompactOutputs[ 4 ]  = { NULL };
+
+    for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+    {
+        for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+        {
+            VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( VN_IMAGE_FORMAT_R8, uiSizes[ s ][ 0 ], uiSizes[ s ][ 1 ], k, ppImages + k ) ) );
+        }
+
+        for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( uiFlags ); f++ )
+        {
+            VN_IMAGE_TRANSFORM_FLAGS uiCompactFlags = uiFlags[ f ] | VN_IMAGE_TRANSFORM_COMPACT;
+
+            for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+            {
+                CVImage * pFull    = NULL;
+                CVImage * pCompact = NULL;
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImage( *ppImages[ k ], uiFlags[ f ], &pFull ) ) );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImage( *ppImages[ k ], uiCompactFlags, &pCompact ) ) );
+                VN_TEST_CHECK( VN_IMAGE_FORMAT_R32S == pFull->QueryFormat() );
+                VN_TEST_CHECK( vnTestCoefficientsMatch( *pCompact, *pFull, 0 ) );
+
+                uiCompactCount += ( VN_IMAGE_FORMAT_R16S == pCompact->QueryFormat() ? 1 : 0 );
+
+                vnDestroyImage( pCompact );
+                vnDestroyImage( pFull );
+            }
+
+            for ( UINT32 b = 0; b < VN_TEST_COUNT_OF( uiBlockSizes ); b++ )
+            {
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageBatch( ppImages, VN_TEST_COUNT_OF( ppImages ), uiBlockSizes[ b ], uiFlags[ f ], ppOutputs ) ) );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageBatch( ppImages, VN_TEST_COUNT_OF( ppImages ), uiBlockSizes[ b ], uiCompactFlags, ppCompactOutputs ) ) );
+
+                for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+                {
+                    CVImage * pLow        = NULL;
+                    CVImage * pCompactLow = NULL;
+
+                    VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageLowFrequency( *ppImages[ k ], uiBlockSizes[ b ], uiFlags[ f ], &pLow ) ) );
+                    VN_TEST_CHECK( VN_SUCCEEDED( vnTransformImageLowFrequency( *ppImages[ k ], uiBlockSizes[ b ], uiCompactFlags, &pCompactLow ) ) );
+                    VN_TEST_CHECK( VN_IMAGE_FORMAT_R32S == pLow->QueryFormat() && VN_IMAGE_FORMAT_R32S == ppOutputs[ k ]->QueryFormat() );
+                    VN_TEST_CHECK( pCompactLow->QueryFormat() == ppCompactOutputs[ k ]->QueryFormat() );
+                    VN_TEST_CHECK( vnTestCoefficientsMatch( *pCompactLow, *pLow, 0 ) );
+                    VN_TEST_CHECK( vnTestCoefficientsMatch( *ppCompactOutputs[ k ], *ppOutputs[ k ], 0 ) );
+
+                    uiCompactCount += ( VN_IMAGE_FORMAT_R16S == pCompactLow->QueryFormat() ? 1 : 0 );
+
+                    vnDestroyImage( pCompactLow );
+                    vnDestroyImage( pLow );
+                    vnDestroyImage( ppCompactOutputs[ k ] );
+                    vnDestroyImage( ppOutputs[ k ] );
+                }
+            }
+        }
+
+        for ( UINT32 k = 0; k < VN_TEST_COUNT_OF( ppImages ); k++ )
+        {
+            vnDestroyImage( ppImages[ k ] );
+        }
+    }
+
+    //
+    // Most of the sizes above fit the compact format, so it must have been exercised.
+    //
+
+    VN_TEST_CHECK( uiCompactCount > 0 );
+
+    return TRUE;
+}
@@ -0,0 +1,71 @@
+
+#include "vnTest.h"
+
+//
+// vnTestViewHashes
+//
+//   A view describes pixels that live within memory owned by someone else, usually with a row
+//   pitch that is wider than its rows. Each view below is taken from the interior of a larger
+//   image, so that its rows are padded by the pixels of its parent, and must hash exactly as a
+//   tightly packed copy of the same pixels. Views of planar formats only describe the Y plane,
+//   which is all that a hash reads.
+//
+
+BOOL vnTestViewHashes()
+{
+    CONST VN_IMAGE_FORMAT formats[] = { VN_IMAGE_FORMAT_R8, VN_IMAGE_FORMAT_R8G8B8, VN_IMAGE_FORMAT_B8G8R8A8, VN_IMAGE_FORMAT_NV12 };
+    CONST UINT32 uiSizes[][ 2 ]     = { { 32, 32 }, { 33, 47 }, { 300, 200 }, { 641, 479 } };
+    CONST UINT32 uiBorderX          = 13;
+    CONST UINT32 uiBorderY          = 9;
+
+    for ( UINT32 f = 0; f < VN_TEST_COUNT_OF( formats ); f++ )
+    {
+        for ( UINT32 s = 0; s < VN_TEST_COUNT_OF( uiSizes ); s++ )
+        {
+            for ( UINT32 uiPattern = 0; uiPattern < VN_TEST_PATTERN_COUNT; uiPattern++ )
+            {
+                UINT32 uiWidth    = uiSizes[ s ][ 0 ];
+                UINT32 uiHeight   = uiSizes[ s ][ 1 ];
+                CVImage * pParent = NULL;
+                CVImage * pView   = NULL;
+                CVImage * pCopy   = NULL;
+
+                VN_TEST_CHECK( VN_SUCCEEDED( vnCreateTestImage( formats[ f ], uiWidth + 2 * uiBorderX, uiHeight + 2 * uiBorderY, uiPattern, &pParent ) ) );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnWrapImage( *pParent, uiBorderX, uiBorderY, uiWidth, uiHeight, &pView ) ) );
+                VN_TEST_CHECK( pView->RowPitch() > ( ( uiWidth * pView->QueryBitsPerPixel() ) >> 3 ) );
+                VN_TEST_CHECK( VN_SUCCEEDED( vnCreateImage( formats[ f ], uiWidth, uiHeight, &pCopy ) ) );
+
+                for ( UINT32 j = 0; j < uiHeight; j++ )
+                {
+                    memcpy( pCopy->QueryData() + pCopy->BlockOffset( 0, j ), pView->QueryData() + pView->BlockOffset( 0, j ), ( uiWidth * pView->QueryBitsPerPixel() ) >> 3 );
+                }
+
+                BOOL bMatched = vnTestHashesMatch( *pView, *pCopy );
+
+                vnDestroyImage( pCopy );
+                vnDestroyImage( pView );
+                vnDestroyImage( pParent );
+
+                if ( !bMatched )
+                {
+                    printf( "    format 0x%08x, %ix%i, pattern %i\n", formats[ f ], uiWidth, uiHeight, uiPattern );
+
+                    return FALSE;
+                }
+            }
+        }
+    }
+
+    //
+    // Packed rows whose byte width exceeds a 32 bit pitch are rejected before any memory is
+    // touched, and the failed view is released rather than returned.
+    //
+
+    UINT8 pbyPixel[ 4 ] = { 0 };
+    CVImage * pView     = NULL;
+
+    VN_TEST_CHECK( VN_FAILED( vnWrapImage( VN_IMAGE_FORMAT_R8G8B8A8, 0x40000000, 1, pbyPixel, 0, &pView ) ) );
+    VN_TEST_CHECK( NULL == pView );
+
+    return TRUE;
+}
@@ -1,34 +1,69 @@
 
 #include "vnInsight.h"
+#include "Platform/vnMappedFile.h"
+
+#if defined ( VN_SIMD_AVX2 ) || defined ( VN_SIMD_DISPATCH )
+    #define VN_INSIGHT_USE_AVX2
+    #include <immintrin.h>
+#endif
+
+#if defined ( VN_INSIGHT_USE_AVX2 )
+    #define VN_INSIGHT_USE_POPCNT
+#endif
+
+#define VN_INSIGHT_MAX_THUMB_SIZE                   (2900)
 
 //
-// Our hash size determines the degree of quantization of the data.
-// Larger hash sizes enable less quantization and a greater per-pixel 
-// precision.
+// File hashes map their source a strip of rows at a time. This bounds the resident 
+// memory of a file hash regardless of the size of the image within it.
 //
 
-#define VN_INSIGHT_DEFAULT_HASH_SIZE                (32)
+#define VN_INSIGHT_FILE_STRIP_SIZE                  ( 64 * MB )
 
 //
-// The thumbnail size is less important than the hash size, but can
-// provide greater accuracy for very large images. This value should
-// rarely be larger than 8 due to the likelihood of overflowing our
-// 16 bit signed storage during the transformation step.
+// Version 2 hashes use the fixed point transform, which produces identical coefficients
+// on every platform and compiler (see VN_INSIGHT_HASH_VERSION).
 //
 
-#define VN_INSIGHT_DEFAULT_THUMB_SIZE               (16)
+#if VN_INSIGHT_HASH_VERSION < 1 || VN_INSIGHT_HASH_VERSION > 2
+#error "Unsupported hash version. Set VN_INSIGHT_HASH_VERSION to 1 or 2."
+#endif
 
-#define VN_INSIGHT_MAX_THUMB_SIZE                   (2900)
+#define VN_INSIGHT_USE_FIXED_POINT_TRANSFORM        ( VN_INSIGHT_HASH_VERSION >= 2 )
+
+#if VN_INSIGHT_USE_FIXED_POINT_TRANSFORM
+#define VN_INSIGHT_TRANSFORM_FLAGS                  ( VN_IMAGE_TRANSFORM_FIXED_POINT | VN_IMAGE_TRANSFORM_COMPACT )
+#else
+#define VN_INSIGHT_TRANSFORM_FLAGS                  ( VN_IMAGE_TRANSFORM_DEFAULT | VN_IMAGE_TRANSFORM_COMPACT )
+#endif
 
 #if ( ( ( VN_INSIGHT_DEFAULT_HASH_SIZE << 3 ) / ( VN_INSIGHT_DEFAULT_THUMB_SIZE * VN_INSIGHT_DEFAULT_THUMB_SIZE ) ) > 32 )
 #error "Default hash size is too large. Decrease the hash size or increase the thumb size to remedy."
 #endif
 
+//
+// vnQueryCoefficient
+//
+//   Reads coefficient (i,j) from either an R32S or a compact R16S transform image.
+//
+
+inline INT32 vnQueryCoefficient( CONST CVImage & pInput, UINT32 i, UINT32 j )
+{
+    UINT8 * pbyCoefficient = pInput.QueryData() + pInput.BlockOffset( i, j );
+
+    if ( VN_IMAGE_FORMAT_R16S == pInput.QueryFormat() )
+    {
+        return *( reinterpret_cast<INT16 *>( pbyCoefficient ) );
+    }
+
+    return *( reinterpret_cast<INT32 *>( pbyCoefficient ) );
+}
+
 INT32 vnComputeBlockAverage( CONST CVImage & pInput )
 {
     if ( VN_PARAM_CHECK )
     {
-        if ( !VN_IS_IMAGE_VALID( pInput ) || VN_IMAGE_FORMAT_R32S != pInput.QueryFormat() )
+        if ( !VN_IS_IMAGE_VALID( pInput ) || ( VN_IMAGE_FORMAT_R32S != pInput.QueryFormat() && VN_IMAGE_FORMAT_R16S != pInput.QueryFormat() ) )
         {
             vnPostError( VN_ERROR_INVALIDARG );
 
@@ -36,13 +71,16 @@ INT32 vnComputeBlockAverage( CONST CVImage & pInput )
         }
     }
 
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_BLOCK_AVERAGE, VN_IMAGE_PIXEL_BYTES( pInput ) );
+
     //
-    // Traverse the upper left 1/16th block and compute an average, ignoring
-    // the DC coefficient.
+    // Traverse the low frequency block (the upper left 1/16th of our transform)
+    // and compute an average, ignoring the DC coefficient.
     //
 
     INT64 iAverage      = 0;
-    UINT32 uiBlockWidth = pInput.QueryWidth() >> 2;
+    UINT32 uiBlockWidth = pInput.QueryWidth();
 
     for ( UINT32 j = 0; j < uiBlockWidth; j++ )
     {
@@ -50,29 +88,34 @@ INT32 vnComputeBlockAverage( CONST CVImage & pInput )
         {
             if ( 0 == i && 0 == j ) continue;
 
-            iAverage += *( reinterpret_cast<INT32 *>( pInput.QueryData() + pInput.BlockOffset( i, j ) ) );
+            iAverage += vnQueryCoefficient( pInput, i, j );
         }
     }
 
     return ( iAverage / ( ( uiBlockWidth * uiBlockWidth ) - 1 ) );
 }
 
-VN_STATUS vnPublishHashValue( CONST CVImage & pInput, INT32 iAverage, UINT32 uiHashSize, CVBitStream * pOutStream )
+VN_STATUS vnPublishHashValue( CONST CVImage & pInput, UINT32 uiTransformSize, INT32 iAverage, UINT32 uiHashSize, CVBitStream * pOutStream )
 {
     if ( !pOutStream || pOutStream->IsFull() || 0 == pOutStream->QueryCapacity() || !VN_IS_IMAGE_VALID( pInput ) )
     {
         return vnPostError( VN_ERROR_INVALIDARG );
     }
 
+    VN_TRACE_FUNCTION();
+    CVStageTimer pTimer( VN_COUNTER_STAGE_PUBLISH, VN_IMAGE_PIXEL_BYTES( pInput ) + uiHashSize );
+
     //
-    // Traverse the upper left 1/16th block and write out a quantized series
-    // of bits. We do this carefully considering the range of our DCT values,
-    // so that we quantize around the tighest range possible.
+    // Traverse the low frequency block (the upper left 1/16th of our transform)
+    // and write out a quantized series of bits. We do this carefully considering 
+    // the range of our DCT values, so that we quantize around the tighest range 
+    // possible. Note that the range depends upon the size of the full transform
+    // (uiTransformSize x uiTransformSize), rather than that of the block.
     //
 
-    UINT32 uiBlockWidth       = pInput.QueryWidth() >> 2;
+    UINT32 uiBlockWidth       = pInput.QueryWidth();
     UINT32 uiHashBitsPerPixel = ( uiHashSize << 3 ) / ( uiBlockWidth * uiBlockWidth );
-    UINT32 uiMaxDCTValue      = 255 * pInput.QueryWidth() * pInput.QueryHeight();
+    UINT32 uiMaxDCTValue      = 255 * uiTransformSize * uiTransformSize;
     UINT32 uiTwiceDCTMax      = uiMaxDCTValue << 1;
     UINT32 uiQdiv             = uiTwiceDCTMax >> ( uiHashBitsPerPixel - 1 );
     
@@ -142,7 +185,7 @@ VN_STATUS vnPublishHashValue( CONST CVImage & pInput, INT32 iAverage, UINT32 uiH
     {
         for ( UINT32 i = 0; i < uiBlockWidth; i++ )
         {
-            INT32 iValue = *( reinterpret_cast<INT32 *>( pInput.QueryData() + pInput.BlockOffset( i, j ) ) );
+            INT32 iValue = vnQueryCoefficient( pInput, i, j );
 
                   iValue = iValue - iAverage;          
                   iValue = iValue + uiTwiceDCTMax;          
@@ -160,44 +203,147 @@ VN_STATUS vnPublishHashValue( CONST CVImage & pInput, INT32 iAverage, UINT32 uiH
     return VN_SUCCESS;
 }
 
-VN_STATUS vnHashImage( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+CVInsightContext::CVInsightContext()
 {
-    if ( VN_PARAM_CHECK )
+    m_pSmallImage     = NULL;
+    m_pTransformImage = NULL;
+    m_pWorkspaceImage = NULL;
+    m_pOutStream      = NULL;
+    m_uiThumbSize     = 0;
+    m_uiHashSize      = 0;
+    m_uiRemainingRows = 0;
+    m_uiRowSize       = 0;
+}
+
+CVInsightContext::~CVInsightContext()
+{
+    vnDestroyImage( m_pSmallImage );
+    vnDestroyImage( m_pTransformImage );
+    vnDestroyImage( m_pWorkspaceImage );
+}
+
+VN_STATUS CVInsightContext::Prepare()
+{
+    //
+    // Our images are created on first use as minimal placeholders, and are then reshaped 
+    // (and grown only as necessary) by each stage of the pipeline. Every stage overwrites
+    // the images that it uses, so there is no need to clear their memory.
+    //
+
+    CVImage ** ppImages[] = { &m_pSmallImage, &m_pTransformImage, &m_pWorkspaceImage };
+
+    for ( UINT32 i = 0; i < sizeof( ppImages ) / sizeof( ppImages[ 0 ] ); i++ )
+    {
+        if ( !(*ppImages[ i ]) && VN_FAILED( vnCreateImage( VN_IMAGE_FORMAT_R8, 1, 1, VN_IMAGE_CREATE_ALIGNED | VN_IMAGE_CREATE_UNINITIALIZED, ppImages[ i ] ) ) )
+        {
+            return vnPostError( VN_ERROR_OUTOFMEMORY );
+        }
+    }
+
+    return VN_SUCCESS;
+}
+
+//
+// vnCheckHashArguments
+//
+//   Validates the arguments of a hash of a ( uiWidth x uiHeight ) image of the specified format.
+//
+
+VN_STATUS vnCheckHashArguments( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    //
+    // We arbitrarily limit the thumb and hash sizes to 64K and 2G respectively.
+    //
+
+    if ( uiThumbSize > VN_INSIGHT_MAX_THUMB_SIZE || uiHashSize > 2*GB )
+    {
+        return vnPostError( VN_ERROR_INVALIDARG );
+    }
+
+    if ( !pOutStream || pOutStream->IsFull() || 0 == pOutStream->QueryCapacity() )
+    {
+        return vnPostError( VN_ERROR_INVALIDARG );
+    }
+
+    if ( !VN_IS_IMAGE_LUMA_FORMAT( format ) )
+    {
+        VN_MSG("Insight currently only supports 8 bit RGB, BGR, RGBA, BGRA, gray, I420 and NV12 images.");
+
+        return vnPostError( VN_ERROR_INVALIDARG );
+    }
+
+    if ( uiWidth < 32 || uiHeight < 32 )
     {
         //
-        // We arbitrarily limit the thumb and hash sizes to 64K and 2G respectively.
+        // For now we only support images >= 32x32 pixels
         //
 
-        if ( uiThumbSize > VN_INSIGHT_MAX_THUMB_SIZE || uiHashSize > 2*GB )
-        {
-            return vnPostError( VN_ERROR_INVALIDARG );
-        }
+        return vnPostError( VN_ERROR_INVALIDARG );
+    }
 
-        if ( !pOutStream || pOutStream->IsFull() || 0 == pOutStream->QueryCapacity() || !VN_IS_IMAGE_VALID( pInput ) )
-        {
-            return vnPostError( VN_ERROR_INVALIDARG );
-        }
+    return VN_SUCCESS;
+}
 
-        if ( VN_IMAGE_FORMAT_R8G8B8 != pInput.QueryFormat() )
-        {
-            VN_MSG("Insight currently only supports R8G8B8 images.");
+VN_STATUS CVInsightContext::Publish( UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    VN_TRACE_FUNCTION();
+
+    //
+    // Our small image holds the (uiTargetWidth x uiTargetWidth) gray thumbnail. Transform it
+    // into frequency space, converting to 16 bpp where the range of our coefficients permits 
+    // (and 32 bpp otherwise). We only ever read the upper left (uiThumbSize x uiThumbSize) 
+    // coefficients, so we skip computing the rest of the plane.
+    //
 
+     INT32 iAverageValue  = 0;
+    UINT32 uiTargetWidth  = uiThumbSize << 2;
+
+    if ( VN_FAILED( vnTransformImageLowFrequency( *m_pSmallImage, uiThumbSize, VN_INSIGHT_TRANSFORM_FLAGS, m_pTransformImage, m_pWorkspaceImage ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    //
+    // Compute the average of our (uiThumbSize x uiThumbSize) coefficient block, 
+    // ignoring the DC coefficient.
+    //
+
+    iAverageValue = vnComputeBlockAverage( *m_pTransformImage );        
+
+    //
+    // Traverse our upper-left block and write out an output bits depending upon the 
+    // results of our quantization function.
+    //
+
+    if ( VN_FAILED( vnPublishHashValue( *m_pTransformImage, uiTargetWidth, iAverageValue, uiHashSize, pOutStream ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return VN_SUCCESS;
+}
+
+VN_STATUS CVInsightContext::Hash( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !VN_IS_IMAGE_VALID( pInput ) )
+        {
             return vnPostError( VN_ERROR_INVALIDARG );
         }
 
-        if ( pInput.QueryWidth() < 32 || pInput.QueryHeight() < 32 )
+        if ( VN_FAILED( vnCheckHashArguments( pInput.QueryFormat(), pInput.QueryWidth(), pInput.QueryHeight(), uiThumbSize, uiHashSize, pOutStream ) ) )
         {
-            //
-            // For now we only support images >= 32x32 pixels
-            //
-
             return vnPostError( VN_ERROR_INVALIDARG );
         }
     }
 
-    CVImage * pGrayImage      = NULL;
-    CVImage * pSmallImage     = NULL;
-    CVImage * pTransformImage = NULL;
+    VN_TRACE_FUNCTION();
+
+    if ( VN_FAILED( Prepare() ) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
 
     //
     // Maintain our default values.
@@ -210,67 +356,234 @@ VN_STATUS vnHashImage( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHash
     // Our hash size represents the number of bits we wish to use for our output hash. 
     //
 
-     INT32 iAverageValue  = 0;
     UINT32 uiTargetWidth  = uiThumbSize << 2;
 
     //
-    // First we convert our image to grayscale.
+    // Convert our image to grayscale and reduce it down to (uiTargetWidth x uiTargetWidth) in
+    // a single pass, so that we never hold a full resolution gray copy. We always use the 
+    // coverage filter so that hashes remain comparable across image sizes (and with earlier
+    // releases). Each stage reshapes one of our recycled images, which only allocates when 
+    // the stage requires more memory than ever before.
     //
 
-    if ( VN_FAILED( vnDesaturateImage( pInput, &pGrayImage ) ) )
+    if ( VN_FAILED( vnDesaturateResizeImage( pInput, uiTargetWidth, uiTargetWidth, m_pSmallImage, m_pWorkspaceImage ) ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
+    return Publish( uiThumbSize, uiHashSize, pOutStream );
+}
+
+VN_STATUS CVInsightContext::BeginHash( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( VN_FAILED( vnCheckHashArguments( format, uiWidth, uiHeight, uiThumbSize, uiHashSize, pOutStream ) ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    m_pOutStream = NULL;
+
+    if ( VN_FAILED( Prepare() ) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    if ( 0 == uiHashSize )  uiHashSize  = VN_INSIGHT_DEFAULT_HASH_SIZE;
+    if ( 0 == uiThumbSize ) uiThumbSize = VN_INSIGHT_DEFAULT_THUMB_SIZE;
+
+    UINT32 uiTargetWidth  = uiThumbSize << 2;
+
     //
-    // Reduce our image down to (uiTargetWidth x uiTargetWidth)
+    // Each row is desaturated and filtered as it arrives, exactly as in Hash, so only the
+    // thumbnail and a small ring of filtered rows are retained. Gray and Y plane rows are 
+    // filtered directly.
     //
 
-    if ( VN_FAILED( vnResizeImage( *pGrayImage, uiTargetWidth, uiTargetWidth, &pSmallImage ) ) )
+    if ( VN_FAILED( vnReshapeImage( VN_IMAGE_FORMAT_R8, uiTargetWidth, uiTargetWidth, m_pSmallImage ) ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
-    //
-    // Transform into frequency space, converting to 16 bpp.
-    //
+    if ( VN_FAILED( m_pResizeStream.Begin( format, uiWidth, uiHeight, !VN_IS_IMAGE_LUMA_PLANE( format ), m_pSmallImage, m_pWorkspaceImage ) ) )
+    {
+        return vnPostError( VN_ERROR_OUTOFMEMORY );
+    }
+
+    m_pOutStream      = pOutStream;
+    m_uiThumbSize     = uiThumbSize;
+    m_uiHashSize      = uiHashSize;
+    m_uiRemainingRows = uiHeight;
+    m_uiRowSize       = ( (UINT64) uiWidth * VN_IMAGE_PIXEL_RATE( format ) ) >> 3;
+
+    return VN_SUCCESS;
+}
 
-    if ( VN_FAILED( vnTransformImage( *pSmallImage, &pTransformImage ) ) )
+VN_STATUS CVInsightContext::PushRow( IN UINT8 * pSrcLine )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pSrcLine )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( !m_pOutStream )
+        {
+            return vnPostError( VN_ERROR_NOT_READY );
+        }
+    }
+
+    CVStageTimer pTimer( VN_COUNTER_STAGE_RESIZE, m_uiRowSize );
+
+    if ( VN_FAILED( m_pResizeStream.PushRow( pSrcLine ) ) )
     {
         return vnPostError( VN_ERROR_EXECUTION_FAILURE );
     }
 
+    if ( --m_uiRemainingRows )
+    {
+        return VN_SUCCESS;
+    }
+
     //
-    // Compute the average of the upper left (uiLeftQuadSize x uiLeftQuadSize) region
-    // of our transformed image, ignoring the DC coefficient.
+    // The final row has arrived, so our thumbnail is complete.
     //
 
-    iAverageValue = vnComputeBlockAverage( *pTransformImage );        
+    CVBitStream * pOutStream = m_pOutStream;
+
+    m_pOutStream = NULL;
+
+    return Publish( m_uiThumbSize, m_uiHashSize, pOutStream );
+}
+
+VN_STATUS CVInsightContext::HashFile( CONST CHAR * szFilename, UINT64 uiOffset, VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiRowPitch, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !szFilename )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    VN_TRACE_FUNCTION();
+
+    CVMappedFile pFile;
+
+    if ( VN_FAILED( pFile.Open( szFilename ) ) )
+    {
+        return vnPostError( VN_ERROR_IO_FAILURE );
+    }
+
+    if ( VN_FAILED( BeginHash( format, uiWidth, uiHeight, uiThumbSize, uiHashSize, pOutStream ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
 
     //
-    // Traverse our upper-left block and write out an output bits depending upon the 
-    // results of our quantization function.
+    // A zero pitch indicates tightly packed rows. The file must contain every row of our
+    // image (or of its Y plane), though the final row need not be padded.
     //
 
-    if ( VN_FAILED( vnPublishHashValue( *pTransformImage, iAverageValue, uiHashSize, pOutStream ) ) )
+    UINT64 uiRowSize = ( (UINT64) uiWidth * VN_IMAGE_PIXEL_RATE( format ) ) >> 3;
+
+    if ( 0 == uiRowPitch )
     {
-        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+        uiRowPitch = (UINT32) uiRowSize;
+    }
+
+    UINT64 uiImageSize = (UINT64) uiRowPitch * ( uiHeight - 1 ) + uiRowSize;
+
+    if ( uiRowPitch < uiRowSize || uiRowSize != (UINT32) uiRowSize || uiOffset > pFile.QuerySize() || uiImageSize > pFile.QuerySize() - uiOffset )
+    {
+        m_pOutStream = NULL;
+
+        return vnPostError( VN_ERROR_INVALID_RESOURCE );
     }
 
     //
-    // Cleanup
+    // Our resize consumes rows strictly from top to bottom, so we walk the file in strips
+    // of whole rows and release each strip before mapping the next. Each row of a strip is
+    // pushed through our streamed hash, which produces a hash identical to that of Hash.
     //
 
-    vnDestroyImage( pGrayImage );
-    vnDestroyImage( pSmallImage );
-    vnDestroyImage( pTransformImage );
+    UINT32 uiStripRows = VN_MAX2( 1, VN_INSIGHT_FILE_STRIP_SIZE / uiRowPitch );
+
+    for ( UINT32 j = 0; j < uiHeight; j += uiStripRows )
+    {
+        UINT8 * pStrip     = NULL;
+        UINT32  uiRowCount = VN_MIN2( uiStripRows, uiHeight - j );
+
+        if ( VN_FAILED( pFile.Map( uiOffset + (UINT64) uiRowPitch * j, (UINT64) uiRowPitch * ( uiRowCount - 1 ) + uiRowSize, &pStrip ) ) )
+        {
+            m_pOutStream = NULL;
+
+            return vnPostError( VN_ERROR_IO_FAILURE );
+        }
+
+        for ( UINT32 k = 0; k < uiRowCount; k++ )
+        {
+            if ( VN_FAILED( PushRow( pStrip + (UINT64) uiRowPitch * k ) ) )
+            {
+                m_pOutStream = NULL;
+
+                return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+            }
+        }
+    }
 
     return VN_SUCCESS;
 }
 
+VN_STATUS vnHashImage( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    CVInsightContext pContext;
+
+    return pContext.Hash( pInput, uiThumbSize, uiHashSize, pOutStream );
+}
+
+VN_STATUS vnHashImageFile( CONST CHAR * szFilename, UINT64 uiOffset, VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiRowPitch, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream )
+{
+    CVInsightContext pContext;
+
+    return pContext.HashFile( szFilename, uiOffset, format, uiWidth, uiHeight, uiRowPitch, uiThumbSize, uiHashSize, pOutStream );
+}
+
+UINT32 vnQueryHashVersion()
+{
+    return VN_INSIGHT_HASH_VERSION;
+}
+
 UINT64 vnHashImage64( CONST CVImage & pInput )
 {
     UINT64 result = 0;
+
+#if VN_INSIGHT_USE_FIXED_POINT_TRANSFORM
+
+    //
+    // Our 64 bit hash has a fixed configuration, so we use the specialized hasher, which avoids
+    // both the intermediate images and the bitstream.
+    //
+
+    UINT8 pbyHash[ 8 ];
+
+    if ( VN_FAILED( CVInsightHasher64::Hash( pInput, pbyHash ) ) )
+    {
+        vnPostError( VN_ERROR_EXECUTION_FAILURE );
+
+        return 0;
+    }
+
+    for ( UINT32 i = 0; i < 8; i++ )
+    {
+        result |= (UINT64) pbyHash[ i ] << ( i << 3 );
+    }
+
+#else
+
     UINT32 count  = 8;
     CVBitStream stream;
 
@@ -295,9 +608,150 @@ UINT64 vnHashImage64( CONST CVImage & pInput )
         return 0;
     }
 
+#endif
+
     return result;
 }
 
+//
+// vnCountDifferingBits
+//
+//   Returns the Hamming distance between the first uiBitCount bits of pA and pB. Bits
+//   are stored least significant first within each byte, as written by CVBitStream.
+//
+
+template < UINT32 LEVEL >
+UINT32 vnCountDifferingBits( CONST UINT8 * pA, CONST UINT8 * pB, UINT32 uiBitCount )
+{
+    UINT32 uiByteCount  = uiBitCount >> 3;
+    UINT32 uiDistance   = 0;
+    UINT32 i            = 0;
+
+#if defined ( VN_INSIGHT_USE_AVX2 )
+
+    if ( LEVEL >= VN_CPU_LEVEL_AVX2 )
+    {
+        //
+        // Count the bits of each nibble with a table lookup, then sum the byte counts
+        // into 64 bit lanes.
+        //
+
+        __m256i vLookup = _mm256_setr_epi8( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+        __m256i vMask   = _mm256_set1_epi8( 0x0F );
+        __m256i vTotal  = _mm256_setzero_si256();
+
+        for ( ; i + 32 <= uiByteCount; i += 32 )
+        {
+            __m256i vDiff   = _mm256_xor_si256( _mm256_loadu_si256( (CONST __m256i *) ( pA + i ) ), _mm256_loadu_si256( (CONST __m256i *) ( pB + i ) ) );
+            __m256i vLow    = _mm256_shuffle_epi8( vLookup, _mm256_and_si256( vDiff, vMask ) );
+            __m256i vHigh   = _mm256_shuffle_epi8( vLookup, _mm256_and_si256( _mm256_srli_epi16( vDiff, 4 ), vMask ) );
+
+            vTotal = _mm256_add_epi64( vTotal, _mm256_sad_epu8( _mm256_add_epi8( vLow, vHigh ), _mm256_setzero_si256() ) );
+        }
+
+        UINT64 uiLanes[ 4 ];
+
+        _mm256_storeu_si256( (__m256i *) uiLanes, vTotal );
+
+        uiDistance += (UINT32) ( uiLanes[ 0 ] + uiLanes[ 1 ] + uiLanes[ 2 ] + uiLanes[ 3 ] );
+    }
+
+#endif
+
+#if defined ( VN_INSIGHT_USE_POPCNT )
+
+    if ( LEVEL >= VN_CPU_LEVEL_SSE42 )
+    {
+        for ( ; i + 8 <= uiByteCount; i += 8 )
+        {
+            UINT64 uiDiff = *reinterpret_cast<CONST UINT64 *>( pA + i ) ^ *reinterpret_cast<CONST UINT64 *>( pB + i );
+
+#if defined ( VN_ARCH_64BIT )
+
+            uiDistance += (UINT32) _mm_popcnt_u64( uiDiff );
+
+#else
+
+            //
+            // 32 bit builds lack the 64 bit form, so we count each half separately.
+            //
+
+            uiDistance += (UINT32) _mm_popcnt_u32( (UINT32) uiDiff ) + (UINT32) _mm_popcnt_u32( (UINT32) ( uiDiff >> 32 ) );
+
+#endif
+        }
+    }
+
+#endif
+
+    for ( ; i < uiByteCount; i++ )
+    {
+        UINT8 uiDiff = pA[ i ] ^ pB[ i ];
+
+        while ( uiDiff )
+        {
+            uiDiff &= ( uiDiff - 1 );
+
+            uiDistance++;
+        }
+    }
+
+    //
+    // Mask off any bits of a trailing partial byte that lie beyond uiBitCount.
+    //
+
+    if ( uiBitCount & 0x7 )
+    {
+        UINT8 uiDiff = ( pA[ i ] ^ pB[ i ] ) & ( ( 1 << ( uiBitCount & 0x7 ) ) - 1 );
+
+        while ( uiDiff )
+        {
+            uiDiff &= ( uiDiff - 1 );
+
+            uiDistance++;
+        }
+    }
+
+    return uiDistance;
+}
+
+//
+// vnBindHammingKernel
+//
+//   Returns the Hamming distance kernel that best suits the host processor. Hosts that
+//   support AVX-512 use our AVX2 kernel.
+//
+
+typedef UINT32 ( *VN_HAMMING_KERNEL )( CONST UINT8 * pA, CONST UINT8 * pB, UINT32 uiBitCount );
+
+VN_HAMMING_KERNEL vnBindHammingKernel()
+{
+    UINT32 uiLevel = vnQueryCpuLevel();
+
+#if defined ( VN_INSIGHT_USE_AVX2 )
+
+    if ( uiLevel >= VN_CPU_LEVEL_AVX2 )
+    {
+        return vnCountDifferingBits< VN_CPU_LEVEL_AVX2 >;
+    }
+
+#endif
+
+#if defined ( VN_INSIGHT_USE_POPCNT )
+
+    if ( uiLevel >= VN_CPU_LEVEL_SSE42 )
+    {
+        return vnCountDifferingBits< VN_CPU_LEVEL_SSE42 >;
+    }
+
+#endif
+
+    return vnCountDifferingBits< VN_CPU_LEVEL_SCALAR >;
+}
+
+static VN_HAMMING_KERNEL g_pfnCountDifferingBits = vnBindHammingKernel();
+
 FLOAT32 vnCompareImages64( CONST CVImage & pA, CONST CVImage & pB )
 {
     UINT64 uiHashA = vnHashImage64( pA );
@@ -308,15 +762,7 @@ FLOAT32 vnCompareImages64( CONST CVImage & pA, CONST CVImage & pB )
     // the count as a representative of the degree of similarity.
     //
 
-    UINT32  uiMatchCount  = 0;
-    UINT64 uiCompareValue = uiHashA ^ uiHashB;
-
-    while ( uiCompareValue )
-    {
-        uiCompareValue &= ( uiCompareValue - 1 );
-
-        uiMatchCount++;
-    }
+    UINT32 uiMatchCount = g_pfnCountDifferingBits( reinterpret_cast<CONST UINT8 *>( &uiHashA ), reinterpret_cast<CONST UINT8 *>( &uiHashB ), 64 );
 
     uiMatchCount = ( VN_INSIGHT_DEFAULT_HASH_SIZE << 3 ) - uiMatchCount;
 
@@ -341,6 +787,17 @@ FLOAT32 vnCompareImages( CONST CVImage & pA, CONST CVImage & pB )
         return 0;
     }
 
+#if VN_INSIGHT_USE_FIXED_POINT_TRANSFORM
+
+    if ( VN_FAILED( CVInsightDefaultHasher::Hash( pA, &pAStream ) ) || VN_FAILED( CVInsightDefaultHasher::Hash( pB, &pBStream ) ) )
+    {
+        vnPostError( VN_ERROR_EXECUTION_FAILURE );
+
+        return 0;
+    }
+
+#else
+
     if ( VN_FAILED( vnHashImage( pA, 0, 0, &pAStream ) ) || VN_FAILED( vnHashImage( pB, 0, 0, &pBStream ) ) )
     {
         vnPostError( VN_ERROR_EXECUTION_FAILURE );
@@ -348,6 +805,8 @@ FLOAT32 vnCompareImages( CONST CVImage & pA, CONST CVImage & pB )
         return 0;
     }
 
+#endif
+
     if ( pAStream.QueryOccupancy() != pBStream.QueryOccupancy() )
     {
         //
@@ -362,24 +821,12 @@ FLOAT32 vnCompareImages( CONST CVImage & pA, CONST CVImage & pB )
 
     //
     // Compute the Hamming distance of our two hashes and return the count as a 
-    // representative of the degree of similarity.
+    // representative of the degree of similarity. Our streams have not been read,
+    // so their hashes begin at the first bit of their data.
     //
 
-    UINT32  uiMatchCount = 0;
-
-    while ( !pAStream.IsEmpty() && !pBStream.IsEmpty() )
-    {
-        //
-        // Read a bit, compare it, continue.
-        //
-
-        UINT8 uiA = 0, uiB = 0;
-
-        pAStream.ReadBit( &uiA );
-        pBStream.ReadBit( &uiB );
-
-        uiMatchCount += ( uiA == uiB );
-    }
+    UINT32 uiBitCount   = pAStream.QueryOccupancy();
+    UINT32 uiMatchCount = uiBitCount - g_pfnCountDifferingBits( pAStream.QueryData(), pBStream.QueryData(), uiBitCount );
 
     return ( uiMatchCount / ( (FLOAT32) ( VN_INSIGHT_DEFAULT_HASH_SIZE << 3 ) ) );
 }
\ No newline at end of file
@@ -56,6 +56,45 @@
 #include "Platform/vnBase.h"
 #include "Platform/vnBitStream.h"
 #include "Imagine/vnImagine.h"
+#include "vnInsightHasher.h"
+
+//
+// Our hash size determines the degree of quantization of the data.
+// Larger hash sizes enable less quantization and a greater per-pixel 
+// precision.
+//
+
+#define VN_INSIGHT_DEFAULT_HASH_SIZE                (32)
+
+//
+// The thumbnail size is less important than the hash size, but can
+// provide greater accuracy for very large images. This value should
+// rarely be larger than 8 due to the likelihood of overflowing our
+// 16 bit signed storage during the transformation step.
+//
+
+#define VN_INSIGHT_DEFAULT_THUMB_SIZE               (16)
+
+//
+// Hashes are frequently stored and compared across machines, so any change to the bits 
+// that Insight produces for an image is released as a new hash version. Hashes of 
+// different versions should not be compared with one another.
+//
+//   Version 1: hashes of the floating point transform. These may differ by a bit or two
+//              across platforms, compilers and instruction sets.
+//
+//   Version 2: hashes of the fixed point transform (VN_IMAGE_TRANSFORM_FIXED_POINT), which
+//              are identical everywhere. About one percent of the bits of each hash differ 
+//              from version 1. This is the default.
+//
+// Define VN_INSIGHT_HASH_VERSION as 1 when building Insight to keep producing version 1 
+// hashes, e.g. to match an existing store of them. vnQueryHashVersion reports the version
+// that a build produces.
+//
+
+#ifndef VN_INSIGHT_HASH_VERSION
+#define VN_INSIGHT_HASH_VERSION                     (2)
+#endif
 
 //
 // (!) Note: Insight measures the Hamming distance of two perceptual hashes in order 
@@ -77,7 +116,9 @@
 //
 // Parameters:
 //
-//   pInput:      the source image to hash.
+//   pInput:      the source image to hash, in any 8 bit RGB, BGR, RGBA, BGRA, gray, I420 
+//                or NV12 format. Planar YUV images are hashed from their Y plane alone.
+//                Views (see vnWrapImage) are hashed in place, without copies.
 //   uiThumbSize: the width of the symmetric workspace thumbnail image (see notes).
 //   uiHashSize:  the resultant hash size, in bytes, that is produced by this function.
 //   pOutStream:  the destination that will store the output hash.
@@ -98,6 +139,119 @@
 
 VN_STATUS vnHashImage( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream );
 
+//
+// vnQueryHashVersion
+//
+//   Returns the version of the hashes produced by this build (see VN_INSIGHT_HASH_VERSION).
+//   Callers that store hashes should store this alongside them.
+//
+
+UINT32 vnQueryHashVersion();
+
+//
+// CVInsightContext
+//
+//   A reusable hashing context. The context owns the thumbnail, coefficient and scratch 
+//   images of the hashing pipeline and recycles them across calls, growing them only when 
+//   an input requires more memory than any before it. Hashing many images through one
+//   context therefore avoids nearly all allocator traffic. vnHashImage is equivalent to a 
+//   single call through a temporary context.
+//
+//   Contexts may also hash images that are supplied one row at a time (e.g. by a decoder),
+//   so that the full image never needs to exist in memory. Streamed hashes are identical to
+//   those of Hash.
+//
+//   (!) Note: contexts are not thread safe. Use a separate context on each thread.
+//
+
+class VN_NONVIRTUAL CVInsightContext
+{
+    CVImage *                   m_pSmallImage;
+    CVImage *                   m_pTransformImage;
+    CVImage *                   m_pWorkspaceImage;      // shared scratch for the resize and transform
+
+    CVResizeStream              m_pResizeStream;
+    CVBitStream *               m_pOutStream;           // the destination of a streamed hash
+    UINT32                      m_uiThumbSize;
+    UINT32                      m_uiHashSize;
+    UINT32                      m_uiRemainingRows;
+    UINT32                      m_uiRowSize;            // bytes in each pushed row
+
+private:
+
+    VN_STATUS                   Prepare();
+
+    VN_STATUS                   Publish( UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream );
+
+    CVInsightContext( CONST CVInsightContext & rvalue );
+    CVInsightContext &          operator = ( CONST CVInsightContext & rvalue );
+
+public:
+
+    CVInsightContext();
+    ~CVInsightContext();
+
+    //
+    // Generates a perceptual hash of pInput (see vnHashImage).
+    //
+
+    VN_STATUS                   Hash( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream );
+
+    //
+    // Begins a streamed hash of a ( uiWidth x uiHeight ) image of the specified format. The 
+    // parameters match those of Hash, and pOutStream must remain valid until the final row 
+    // arrives. Any streamed hash that is already in progress is abandoned.
+    //
+
+    VN_STATUS                   BeginHash( VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream );
+
+    //
+    // Supplies the next row (from top to bottom) of a streamed hash. Rows hold uiWidth pixels 
+    // of the format passed to BeginHash (or the Y plane rows of planar formats), and are not 
+    // retained. The hash is written to pOutStream when the final row arrives.
+    //
+
+    VN_STATUS                   PushRow( IN UINT8 * pSrcLine );
+
+    //
+    // Generates a perceptual hash of a raw image that is stored within a file (see vnHashImageFile).
+    //
+
+    VN_STATUS                   HashFile( CONST CHAR * szFilename, UINT64 uiOffset, VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, 
+                                          UINT32 uiRowPitch, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream );
+};
+
+//
+// vnHashImageFile
+//
+//   Generates a perceptual hash of a raw (uncompressed) image that is stored within a file 
+//   and places it within pOutStream. The file is mapped into memory a strip of rows at a 
+//   time and each strip is reduced into the thumbnail before the next is mapped, so images 
+//   far larger than the available memory (or address space) may be hashed. The result is
+//   identical to that of vnHashImage for the same image.
+//
+// Parameters:
+//
+//   szFilename:  the name of the file that contains the image.
+//   uiOffset:    the offset, in bytes, of the first row of the image within the file.
+//   format:      the format of the image (see vnHashImage). Only the Y plane of planar 
+//                YUV images is read.
+//   uiWidth:     the width of the image, in pixels.
+//   uiHeight:    the height of the image, in pixels.
+//   uiRowPitch:  the distance, in bytes, between the starts of consecutive rows, or zero
+//                if the rows are tightly packed.
+//   uiThumbSize: the width of the symmetric workspace thumbnail image (see vnHashImage).
+//   uiHashSize:  the resultant hash size, in bytes, that is produced by this function.
+//   pOutStream:  the destination that will store the output hash.
+//
+// Returns:
+//
+//   A status code indicating success or failure of the operation.
+//
+
+VN_STATUS vnHashImageFile( CONST CHAR * szFilename, UINT64 uiOffset, VN_IMAGE_FORMAT format, UINT32 uiWidth, UINT32 uiHeight, 
+                           UINT32 uiRowPitch, UINT32 uiThumbSize, UINT32 uiHashSize, CVBitStream * pOutStream );
+
 //
 // vnCompareImages
 //
@@ -115,4 +269,15 @@ VN_STATUS vnHashImage( CONST CVImage & pInput, UINT32 uiThumbSize, UINT32 uiHash
 
 FLOAT32 vnCompareImages( CONST CVImage & pA, CONST CVImage & pB );
 
+//
+// Specialized Hashers
+//
+//   Hashers for the configurations used by vnCompareImages (the default) and vnHashImage64.
+//   These produce the same bits as vnHashImage for the same sizes (see vnInsightHasher.h),
+//   and are used in place of it by version 2 (and later) builds.
+//
+
+typedef CVInsightHasher< VN_INSIGHT_DEFAULT_THUMB_SIZE, VN_INSIGHT_DEFAULT_HASH_SIZE > CVInsightDefaultHasher;
+typedef CVInsightHasher< 8, 8 > CVInsightHasher64;
+
 #endif // __INSIGHT_H__
\ No newline at end of file
@@ -0,0 +1,456 @@
+//
+// Copyright (c) 2009-2014 Joe Bertolami. All Right Reserved.
+//
+// vnInsightHasher.h
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//   AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//   IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//   FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//   CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//   OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Description:
+//
+//   The Insight hasher template produces the same hashes as vnHashImage, but for a single
+//   (thumb size, hash size) configuration that is fixed at compile time. The configuration
+//   is validated when the template is instantiated, and every intermediate buffer has a size
+//   known to the compiler, so a hash requires no heap allocations and the inner loops over
+//   the thumbnail may be fully unrolled.
+//
+//   Rather than producing intermediate images, each source row is desaturated and filtered
+//   horizontally as it is read, and then scattered into the vertical sums of every thumbnail
+//   row that it contributes to. Thumbnail rows are transformed as soon as they are complete.
+//   The sampling arithmetic mirrors the coverage filter of vnResizeImage operation for 
+//   operation, and the transform shares the fixed point basis of TransformImage, so the 
+//   results are identical.
+//
+//  Additional Information:
+//
+//   For more information, visit http://www.bertolami.com.
+//
+
+#ifndef __INSIGHT_HASHER_H__
+#define __INSIGHT_HASHER_H__
+
+#include "Platform/vnBase.h"
+#include "Platform/vnBitStream.h"
+#include "Imagine/vnImagine.h"
+
+//
+// Our workspace lives on the stack and grows with the square of the thumb size, so we cap
+// the thumb size of specialized hashers (about 24 KB of stack at the maximum).
+//
+
+#define VN_INSIGHT_MAX_STATIC_THUMB_SIZE            (16)
+
+//
+// CVInsightHasher
+//
+//   Generates perceptual hashes of THUMB_SIZE x THUMB_SIZE coefficient blocks, HASH_SIZE bytes
+//   in length. The results match those of vnHashImage( pInput, THUMB_SIZE, HASH_SIZE, ... ) when
+//   Insight produces version 2 (fixed point) hashes, which is the default.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+class VN_NONVIRTUAL CVInsightHasher
+{
+public:
+
+    enum
+    {
+        TARGET_SIZE         = THUMB_SIZE << 2,
+        COEFFICIENT_COUNT   = THUMB_SIZE * THUMB_SIZE,
+        HASH_BITS_PER_PIXEL = ( COEFFICIENT_COUNT ? ( HASH_SIZE << 3 ) / COEFFICIENT_COUNT : 0 ),
+        HASH_BIT_COUNT      = HASH_BITS_PER_PIXEL * COEFFICIENT_COUNT,
+        MAX_DCT_VALUE       = 255 * TARGET_SIZE * TARGET_SIZE,
+        QUANTIZER           = ( HASH_BITS_PER_PIXEL ? ( MAX_DCT_VALUE << 1 ) >> ( HASH_BITS_PER_PIXEL - 1 ) : 0 ),
+    };
+
+    static_assert( THUMB_SIZE > 1, "The thumb size must be at least two." );
+    static_assert( THUMB_SIZE <= VN_INSIGHT_MAX_STATIC_THUMB_SIZE, "The thumb size is too large for a specialized hasher. Use vnHashImage instead." );
+    static_assert( HASH_BITS_PER_PIXEL > 0, "There aren't enough hash bits to cover the thumbnail. Increase the hash size or decrease the thumb size." );
+    static_assert( HASH_BITS_PER_PIXEL <= 32, "The hash size is too large for the thumbnail. Decrease the hash size or increase the thumb size." );
+    static_assert( QUANTIZER > 0, "The hash size would produce an unquantized hash. Decrease the hash size to remedy." );
+
+private:
+
+    static INT32 RoundCoefficient( INT64 iValue );
+    static INT32 QueryNextTap( FLOAT32 fPosition, INT32 iTap, INT32 iRadius, UINT32 uiLimit );
+    static VOID SampleRow( VN_IMAGE_FORMAT format, CONST UINT8 * pSrcLine, UINT32 uiSrcWidth, FLOAT32 fRatio, UINT8 * pOutput );
+    static VOID TransformRow( CONST UINT8 * pLine, CONST INT32 * piBasis, INT32 * pOutput );
+    static VOID TransformColumns( CONST INT32 ( *piRows )[ THUMB_SIZE ], CONST INT32 * piBasis, INT32 * pOutput );
+
+public:
+
+    //
+    // Hash
+    //
+    //   Writes HASH_SIZE bytes to pbyHash. Bits are packed from the least significant bit of
+    //   each byte, exactly as they would be written to a bitstream, and any unused trailing
+    //   bits are cleared.
+    //
+
+    static VN_STATUS Hash( CONST CVImage & pInput, OUT UINT8 * pbyHash );
+
+    //
+    // Hash
+    //
+    //   Appends HASH_BIT_COUNT bits to pOutStream (see vnHashImage).
+    //
+
+    static VN_STATUS Hash( CONST CVImage & pInput, CVBitStream * pOutStream );
+};
+
+//
+// RoundCoefficient
+//
+//   Removes the fractional bits of a fixed point sum, rounding half away from zero to match
+//   TransformImage.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+inline INT32 CVInsightHasher< THUMB_SIZE, HASH_SIZE >::RoundCoefficient( INT64 iValue )
+{
+    CONST INT64 iHalf = (INT64) 1 << ( VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT - 1 );
+
+    if ( iValue < 0 )
+    {
+        return -(INT32) ( ( -iValue + iHalf ) >> VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT );
+    }
+
+    return (INT32) ( ( iValue + iHalf ) >> VN_IMAGE_TRANSFORM_FIXED_POINT_SHIFT );
+}
+
+//
+// QueryNextTap
+//
+//   Returns the first tap, at or after iTap, of a coverage kernel centered at fPosition that
+//   lands within [0, uiLimit). Returns iRadius + 1 once the kernel has been exhausted.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+inline INT32 CVInsightHasher< THUMB_SIZE, HASH_SIZE >::QueryNextTap( FLOAT32 fPosition, INT32 iTap, INT32 iRadius, UINT32 uiLimit )
+{
+    for ( ; iTap <= iRadius; iTap++ )
+    {
+        INT32 iSample = fPosition + iTap;
+
+        if ( iSample > (INT32) uiLimit - 1 )
+        {
+            break;
+        }
+
+        if ( iSample >= 0 )
+        {
+            return iTap;
+        }
+    }
+
+    return iRadius + 1;
+}
+
+//
+// SampleRow
+//
+//   Desaturates and horizontally filters a single source row into TARGET_SIZE samples.
+//   This follows vnResizeRowHorizontal exactly, including its per tap truncation.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+VOID CVInsightHasher< THUMB_SIZE, HASH_SIZE >::SampleRow( VN_IMAGE_FORMAT format, CONST UINT8 * pSrcLine, UINT32 uiSrcWidth, FLOAT32 fRatio, UINT8 * pOutput )
+{
+    INT32 iRadius      = fRatio + 1.0f;
+    UINT32 uiPixelSize = VN_IMAGE_PIXEL_RATE( format ) >> 3;
+
+    for ( UINT32 i = 0; i < TARGET_SIZE; i++ )
+    {
+        FLOAT32 fX           = i * fRatio;
+        FLOAT32 fSampleCount = 0;
+        INT32 iResult        = 0;
+
+        for ( INT32 iTap = -iRadius + 1; iTap <= iRadius; iTap++ )
+        {
+            INT32 iX = fX + iTap;
+
+            if ( iX < 0 || iX > (INT32) uiSrcWidth - 1 )
+            {
+                continue;
+            }
+
+            FLOAT32 fDistance = VN_MIN2( fRatio, fabs( fX - iX ) );
+            FLOAT32 fWeight   = 1.0f - fDistance / fRatio;
+
+            iResult      += fWeight * vnDesaturatePixel( format, pSrcLine + iX * uiPixelSize );
+            fSampleCount += fWeight;
+        }
+
+        pOutput[ i ] = ( iResult / fSampleCount );
+    }
+}
+
+//
+// TransformRow
+//
+//   Computes the lowest THUMB_SIZE coefficients of a single thumbnail row.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+VOID CVInsightHasher< THUMB_SIZE, HASH_SIZE >::TransformRow( CONST UINT8 * pLine, CONST INT32 * piBasis, INT32 * pOutput )
+{
+    CVStageTimer pTimer( VN_COUNTER_STAGE_TRANSFORM, TARGET_SIZE + THUMB_SIZE * sizeof( INT32 ) );
+
+    for ( UINT32 i = 0; i < THUMB_SIZE; i++ )
+    {
+        CONST INT32 * piBasisRow = piBasis + i * TARGET_SIZE;
+        INT64 iTotal             = 0;
+
+        for ( UINT32 k = 0; k < TARGET_SIZE; k++ )
+        {
+            iTotal += pLine[ k ] * piBasisRow[ k ];
+        }
+
+        pOutput[ i ] = RoundCoefficient( iTotal );
+    }
+}
+
+//
+// TransformColumns
+//
+//   Computes the final THUMB_SIZE x THUMB_SIZE coefficient block, in row major order, from the
+//   row coefficients of every thumbnail row.
+//
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+VOID CVInsightHasher< THUMB_SIZE, HASH_SIZE >::TransformColumns( CONST INT32 ( *piRows )[ THUMB_SIZE ], CONST INT32 * piBasis, INT32 * pOutput )
+{
+    CVStageTimer pTimer( VN_COUNTER_STAGE_TRANSFORM, ( TARGET_SIZE + THUMB_SIZE ) * THUMB_SIZE * sizeof( INT32 ) );
+
+    for ( UINT32 j = 0; j < THUMB_SIZE; j++ )
+    {
+        CONST INT32 * piBasisRow = piBasis + j * TARGET_SIZE;
+        INT64 iTotal[ THUMB_SIZE ] = { 0 };
+
+        for ( UINT32 k = 0; k < TARGET_SIZE; k++ )
+        {
+            for ( UINT32 i = 0; i < THUMB_SIZE; i++ )
+            {
+                iTotal[ i ] += (INT64) piRows[ k ][ i ] * piBasisRow[ k ];
+            }
+        }
+
+        for ( UINT32 i = 0; i < THUMB_SIZE; i++ )
+        {
+            pOutput[ j * THUMB_SIZE + i ] = RoundCoefficient( iTotal[ i ] );
+        }
+    }
+}
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+VN_STATUS CVInsightHasher< THUMB_SIZE, HASH_SIZE >::Hash( CONST CVImage & pInput, OUT UINT8 * pbyHash )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pbyHash || !VN_IS_IMAGE_VALID( pInput ) || !VN_IS_IMAGE_LUMA_FORMAT( pInput.QueryFormat() ) )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+
+        if ( pInput.QueryWidth() < 32 || pInput.QueryHeight() < 32 )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    VN_TRACE_FUNCTION();
+
+    CONST INT32 * piBasis = NULL;
+
+    if ( VN_FAILED( vnQueryTransformBasis( TARGET_SIZE, &piBasis ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    //
+    // Our desaturate and resize are fused into a single pass, so both are recorded as a
+    // resize. The stages that follow record their own time.
+    //
+
+    CVStageTimer pTimer( VN_COUNTER_STAGE_RESIZE, VN_IMAGE_PIXEL_BYTES( pInput ) + TARGET_SIZE * TARGET_SIZE );
+
+    UINT32 uiSrcWidth  = pInput.QueryWidth();
+    UINT32 uiSrcHeight = pInput.QueryHeight();
+    FLOAT32 fHRatio    = static_cast<FLOAT32>( uiSrcWidth - 1 ) / ( TARGET_SIZE - 1 );
+    FLOAT32 fVRatio    = static_cast<FLOAT32>( uiSrcHeight - 1 ) / ( TARGET_SIZE - 1 );
+    INT32 iRadius      = fVRatio + 1.0f;
+
+    UINT8   uiSampleLine[ TARGET_SIZE ];                        // the filtered source row
+    UINT8   uiThumbLine[ TARGET_SIZE ];                         // a completed thumbnail row
+    INT32   iRowSum[ TARGET_SIZE ][ TARGET_SIZE ];              // vertical sums of each thumbnail row
+    FLOAT32 fRowWeight[ TARGET_SIZE ];                          // vertical weights of each thumbnail row
+    INT32   iRowTap[ TARGET_SIZE ];                             // next vertical tap of each thumbnail row
+    INT32   iRowCoefficients[ TARGET_SIZE ][ THUMB_SIZE ];
+    INT32   iCoefficients[ COEFFICIENT_COUNT ];
+    UINT32  uiFirstRow = 0;
+
+    for ( UINT32 j = 0; j < TARGET_SIZE; j++ )
+    {
+        fRowWeight[ j ] = 0;
+        iRowTap[ j ]    = QueryNextTap( j * fVRatio, -iRadius + 1, iRadius, uiSrcHeight );
+
+        for ( UINT32 i = 0; i < TARGET_SIZE; i++ )
+        {
+            iRowSum[ j ][ i ] = 0;
+        }
+    }
+
+    //
+    // Kernel windows advance monotonically with both the source and thumbnail rows, so each
+    // thumbnail row receives its taps in the same order that vnResizeRowVertical visits
+    // them, and rows complete in order.
+    //
+
+    for ( UINT32 y = 0; y < uiSrcHeight && uiFirstRow < TARGET_SIZE; y++ )
+    {
+        CONST UINT8 * pSrcLine = pInput.QueryData() + pInput.BlockOffset( 0, y );
+        BOOL bSampled          = FALSE;
+
+        for ( UINT32 j = uiFirstRow; j < TARGET_SIZE; j++ )
+        {
+            FLOAT32 fY = j * fVRatio;
+
+            if ( (INT32) ( fY + ( -iRadius + 1 ) ) > (INT32) y )
+            {
+                //
+                // This row (and every row below it) begins beneath the current source row.
+                //
+
+                break;
+            }
+
+            while ( iRowTap[ j ] <= iRadius && (INT32) ( fY + iRowTap[ j ] ) == (INT32) y )
+            {
+                INT32 iY          = fY + iRowTap[ j ];
+                FLOAT32 fDistance = VN_MIN2( fVRatio, fabs( fY - iY ) );
+                FLOAT32 fWeight   = 1.0f - fDistance / fVRatio;
+
+                if ( !bSampled )
+                {
+                    SampleRow( pInput.QueryFormat(), pSrcLine, uiSrcWidth, fHRatio, uiSampleLine );
+
+                    bSampled = TRUE;
+                }
+
+                for ( UINT32 i = 0; i < TARGET_SIZE; i++ )
+                {
+                    iRowSum[ j ][ i ] += fWeight * uiSampleLine[ i ];
+                }
+
+                fRowWeight[ j ] += fWeight;
+                iRowTap[ j ]     = QueryNextTap( fY, iRowTap[ j ] + 1, iRadius, uiSrcHeight );
+            }
+        }
+
+        //
+        // Normalize and transform any thumbnail rows that have received all of their taps.
+        //
+
+        for ( ; uiFirstRow < TARGET_SIZE && iRowTap[ uiFirstRow ] > iRadius; uiFirstRow++ )
+        {
+            for ( UINT32 i = 0; i < TARGET_SIZE; i++ )
+            {
+                uiThumbLine[ i ] = ( iRowSum[ uiFirstRow ][ i ] / fRowWeight[ uiFirstRow ] );
+            }
+
+            TransformRow( uiThumbLine, piBasis, iRowCoefficients[ uiFirstRow ] );
+        }
+    }
+
+    if ( uiFirstRow < TARGET_SIZE )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    TransformColumns( iRowCoefficients, piBasis, iCoefficients );
+
+    //
+    // Quantize our coefficients around their average (ignoring the DC coefficient), exactly
+    // as vnPublishHashValue does.
+    //
+
+    CONST UINT32 uiTwiceDCTMax = MAX_DCT_VALUE << 1;
+    CONST UINT32 uiQdiv        = QUANTIZER;
+    INT64 iTotal               = 0;
+    INT32 iAverage             = 0;
+    UINT32 uiBitIndex          = 0;
+
+    {
+        CVStageTimer pAverageTimer( VN_COUNTER_STAGE_BLOCK_AVERAGE, COEFFICIENT_COUNT * sizeof( INT32 ) );
+
+        for ( UINT32 k = 1; k < COEFFICIENT_COUNT; k++ )
+        {
+            iTotal += iCoefficients[ k ];
+        }
+
+        iAverage = iTotal / ( COEFFICIENT_COUNT - 1 );
+    }
+
+    CVStageTimer pPublishTimer( VN_COUNTER_STAGE_PUBLISH, COEFFICIENT_COUNT * sizeof( INT32 ) + HASH_SIZE );
+
+    vnZeroMemory( pbyHash, HASH_SIZE );
+
+    for ( UINT32 k = 0; k < COEFFICIENT_COUNT; k++ )
+    {
+        INT32 iValue = iCoefficients[ k ];
+
+              iValue = iValue - iAverage;
+              iValue = iValue + uiTwiceDCTMax;
+              iValue = iValue / uiQdiv;
+
+        for ( UINT32 b = 0; b < HASH_BITS_PER_PIXEL; b++, uiBitIndex++ )
+        {
+            pbyHash[ uiBitIndex >> 3 ] |= ( iValue & 0x1 ) << ( uiBitIndex & 0x7 );
+
+            iValue = iValue >> 0x1;
+        }
+    }
+
+    return VN_SUCCESS;
+}
+
+template < UINT32 THUMB_SIZE, UINT32 HASH_SIZE >
+VN_STATUS CVInsightHasher< THUMB_SIZE, HASH_SIZE >::Hash( CONST CVImage & pInput, CVBitStream * pOutStream )
+{
+    if ( VN_PARAM_CHECK )
+    {
+        if ( !pOutStream || pOutStream->IsFull() || 0 == pOutStream->QueryCapacity() )
+        {
+            return vnPostError( VN_ERROR_INVALIDARG );
+        }
+    }
+
+    UINT8 pbyHash[ HASH_SIZE ];
+
+    if ( VN_FAILED( Hash( pInput, pbyHash ) ) )
+    {
+        return vnPostError( VN_ERROR_EXECUTION_FAILURE );
+    }
+
+    return pOutStream->WriteBits( pbyHash, HASH_BIT_COUNT );
+}
+
+#endif // __INSIGHT_HASHER_H__